@@ -8,14 +8,50 @@
 //	Version		:	V1.0
 //	Compilateur	:	XC32 V1.31
 // Modifications :
+//      17.10.2026 accs au DS2482 par le moteur Mc32_I2cMaster (bus
+//                 partag avec le LM92), DS2482_USE_I2C_MASTER
+//      17.10.2026 lecture en entier (ReadDS18B20Milli), ReadDS18B20 garde
+//                 le float comme simple enveloppe
+//      17.10.2026 machine d'tat DS18B20_SM : les actions 1-Wire sont des
+//                 transactions non bloquantes, la conversion est attendue
+//                 sur le core timer au lieu de delay_ms(750)
+//      17.10.2026 search rom par la commande triplet (algorithme Maxim),
+//                 match rom par write byte, sans attentes fixes
+//      17.10.2026 DS18B20_SM multi-capteurs, conversion simultane de
+//                 tous les capteurs, lecture partielle du scratchpad
+//      17.10.2026 rsolution rglable (write scratchpad, copy scratchpad
+//                 optionnel), attente de conversion selon la rsolution
+//      17.10.2026 one_wire_end_xmit : pointeur de lecture suivi, relecture
+//                 du status  intervalle croissant et borne
+//      17.10.2026 chec de one_wire_end_xmit (ligne bloque) remont par
+//                 les fonctions bloquantes
+//      17.10.2026 conversions DS18B20_ConvRawToMilli / DS18B20_ConvRawToDeg
+//                 partages par les lectures
+//      17.10.2026 DS18B20_SM : chec I2C ou 1WB bloqu rendu  l'utilisateur
+//                 (ready, status 0), nouvelle mesure aprs un dlai croissant
+//      17.10.2026 DS18B20_SM : capteur valide si l'octet de configuration a
+//                 ses bits fixes (bit 7  0, bits 0  4  1), crc en plus
+//                 si le scratchpad est lu en entier ; absence de capteur au
+//                 premier reset : tous les capteurs invalides
 //
 /*--------------------------------------------------------*/
 
 
+#include <stddef.h>
 #include "bsp_config.h"
 #include "Mc32_DS18b20.h"
 #include "Mc32_I2cUtilCCS.h"
+#include "Mc32_I2cMaster.h"
 #include "Mc32Delays.h"
+#include "Mc32_I2cTimeout.h"
+
+// Compilation conditionelle : accs au DS2482 par le moteur I2C
+// (Mc32_I2cMaster, bus partag avec le LM92) et machine d'tat DS18B20_SM
+// Dcommenter seulement aprs avoir ajout dans l'application le __ISR
+// du vecteur I2C2 appelant I2C_Master_InterruptHandler (voir
+// Mc32_I2cMaster.h), sinon la premire transaction provoque une
+// interruption non traite. En commentaire : fonctions bloquantes i2c_xxx
+// #define DS2482_USE_I2C_MASTER
 
 // dfinitions pour les DS2482-100
 //
@@ -42,7 +78,8 @@
 #define ds2482_100_set_read_pointer_to_status_register 0xf0 // positionne le pointeur de lecture sur le status register
 #define ds2482_100_set_read_pointer_to_read_data_register 0xe1 // positionne le pointeur de lecture sur le read data register
 #define ds2482_100_set_read_pointer_to_channel_selection_register 0xd2 // positionne le pointeur de lecture sur le channel selection register
-#define ds2482_100_set_read_pointer_to_configuration_register 0xf0 // positionne le pointeur de lecture sur le configuration register
+#define ds2482_100_set_read_pointer_to_configuration_register 0xc3 // positionne le pointeur de lecture sur le configuration register
+#define ds2482_100_read_pointer_unknown 0x00 // pointeur laiss par la machine d'tat,  repositionner
 
 // write byte to 1 wire
 #define ds2482_100_1wire_write_byte_code 0xa5 // code de commande pour crire un byte sur le ds2482-100
@@ -62,6 +99,12 @@
 #define ds2482_100_1wire_single_bit_0 0x00       // valeur pour un single bit  0
 #define ds2482_100_1wire_single_bit_1 0x80       // valeur pour un single bit  1
 
+// bits du status register
+#define ds2482_100_status_1wb 0x01 // 1-Wire busy
+#define ds2482_100_status_sbr 0x20 // single bit result
+#define ds2482_100_status_tsb 0x40 // triplet second bit
+#define ds2482_100_status_dir 0x80 // branch direction taken
+
 // dfinitions one wire pour les commandes
 #define one_wire_read_rom_command_code 0x33
 #define one_wire_match_rom_command_code 0x55
@@ -78,6 +121,12 @@
 #define ds18b20_th_value 0x0
 #define ds18b20_tl_value 0x0
 #define ds18b20_config_byte 0b01111111 // 12 bits rsolution
+#define ds18b20_config_byte_9bits 0b00011111 // R1 R0 = 00, 93.75 ms
+// octet de configuration : bit 7 toujours  0, bits 0  4 toujours  1
+#define ds18b20_config_index 4
+#define ds18b20_config_fixed_mask 0b10011111
+#define ds18b20_config_fixed_bits 0b00011111
+#define ds18b20_copy_scratchpad_ms 10 // criture en EEPROM, strong pullup
 #define ds18b20_ok_status 0 // tout est ok
 #define ds18b20_shorted 1 // ligne one wire court-circuite
 #define ds18b20_missing 2 // pas de capteur
@@ -93,6 +142,9 @@ typedef uint8_t byte;
 
 // pour ds2482-100
 byte ds2482_100_status;
+// registre rendu par une lecture du ds2482-100 (suivi pour viter de
+// repositionner le pointeur avant chaque lecture du status)
+static byte ds2482_100_read_ptr = ds2482_100_set_read_pointer_to_status_register;
 
 
 // Premirement une structure pour le scratchpad du DS18b20
@@ -140,16 +192,7 @@ uint8_t ds2482_100_read_address = ds2482_100_read;
 // resp les adresses  utiliser pour la lecture dans le chip de contrle de T1, T2, TRH 
 
 // autres variables pour la gestion du one wire
-byte *ident_string_starting_address; // pointeur sur le dbut du string d'identification
-byte *ident_string_ptr; // pointeur sur le string d'identification
-byte one_wire_cpt_ident_bit; // compteur de bits pour les 64bits de l'identifiant
-byte one_wire_cpt_ident_bit_action; // compteur des actions pour chaque bit
-byte one_wire_match_rom_byte; // byte servant  envoyer les 64 bits un  un
-const byte bit_mask[] = {1,2,4,8,16,32,64,128};
 byte one_wire_crc; // pour le calcul du crc one wire
-bool one_wire_search_rom_finish; // bit indiquant la fin de la fonction search rom
-bool one_wire_search_rom_crc_ok; // bit indiquant que le crc reu  la fin de match rom est ok
-bool one_wire_match_rom_finish; // bit indiquant la fin de la fonction match rom
 byte *ds18b20_scratchpad_ptr; // pointeur sur le dbut du scratchpad du ds18b20
 byte ds18b20_read_scratchpad_action; // indique si l'on demande un byte ou si l'on lit un byte
 byte ds18b20_read_scratchpad_nb_bytes; // nb de bytes encore  lire du scratchpad
@@ -392,12 +435,85 @@ byte scratch;                    // byte 
 // Fonction pour action One-Wire par le DS2482_100
 //
 
+/***********************************************************************************/
+// Position du pointeur de lecture aprs une commande : set read pointer
+// le place, write config le met sur la configuration, le reset et toutes
+// les commandes 1-Wire le remettent sur le status
+static void ds2482_100_track_read_ptr(byte cmd, byte param) {
+  switch (cmd) {
+    case ds2482_100_set_read_pointer_code:
+      ds2482_100_read_ptr = param;
+    break;
+    case ds2482_100_write_config_code:
+      ds2482_100_read_ptr = ds2482_100_set_read_pointer_to_configuration_register;
+    break;
+    default:
+      ds2482_100_read_ptr = ds2482_100_set_read_pointer_to_status_register;
+    break;
+  }
+}
+
+#ifdef DS2482_USE_I2C_MASTER
+/***********************************************************************************/
+// Une transaction du moteur I2C, en priorit basse pour laisser passer
+// les mesures urgentes entre deux actions 1-Wire. L'attente est bloquante
+// mais le bus avance par interruption.
+static E_I2C_MASTER_RESULT ds2482_100_transaction(uint8_t chip, const byte *tx, uint8_t tx_len,
+                                                  byte *rx, uint8_t rx_len) {
+  S_I2C_TRANSACTION trans;
+
+  trans.Address = chip & 0xFE;
+  trans.pTx = tx;
+  trans.TxLen = tx_len;
+  trans.pRx = rx;
+  trans.RxLen = rx_len;
+  trans.Callback = NULL;
+  trans.Priority = I2C_PRIO_LOW;
+  trans.pDevice = NULL;
+  trans.Speed = I2C_SPEED_DEFAULT;
+  trans.Result = I2C_MASTER_IDLE;
+  I2C_Master_Submit(&I2cMasterKit, &trans);
+  return I2C_Master_Wait(&I2cMasterKit, &trans);
+}
+
+/***********************************************************************************/
+void ds2482_100_write_one_byte(uint8_t write_and_dest_chip, uint8_t byte0) {
+  ds2482_100_transaction(write_and_dest_chip, &byte0, 1, NULL, 0);
+  ds2482_100_track_read_ptr(byte0, 0);
+}
+
+/***********************************************************************************/
+void ds2482_100_write_two_bytes(uint8_t write_and_dest_chip, uint8_t byte1, uint8_t byte2) {
+  byte tx[2] = { byte1, byte2 };
+  ds2482_100_transaction(write_and_dest_chip, tx, 2, NULL, 0);
+  ds2482_100_track_read_ptr(byte1, byte2);
+}
+/***********************************************************************************/
+void ds2482_100_write_three_bytes(uint8_t write_and_dest_chip, uint8_t byte1, uint8_t byte2, uint8_t byte3) {
+  byte tx[3] = { byte1, byte2, byte3 };
+  ds2482_100_transaction(write_and_dest_chip, tx, 3, NULL, 0);
+  ds2482_100_track_read_ptr(byte1, byte2);
+}
+/***********************************************************************************/
+byte ds2482_100_read_one_wire_byte(uint8_t read_and_source_chip){
+  byte ret_byte = 0xff;
+  // read byte, no ack sur le dernier octet
+  ds2482_100_transaction(read_and_source_chip, NULL, 0, &ret_byte, 1);
+  return ret_byte;
+}
+/***********************************************************************************/
+void one_wire_read_status(uint8_t read_and_source_chip) {
+  // lecture du status de ds2482-800 ?
+  ds2482_100_transaction(read_and_source_chip, NULL, 0, &ds2482_100_status, 1);
+}
+#else
 /***********************************************************************************/
 void ds2482_100_write_one_byte(uint8_t write_and_dest_chip, uint8_t byte0) {
   i2c_start();
   i2c_write(write_and_dest_chip);
   i2c_write(byte0);
   i2c_stop();
+  ds2482_100_track_read_ptr(byte0, 0);
 }
 
 /***********************************************************************************/
@@ -407,6 +523,7 @@ void ds2482_100_write_two_bytes(uint8_t write_and_dest_chip, uint8_t byte1, uint
   i2c_write(byte1);
   i2c_write(byte2);
   i2c_stop();
+  ds2482_100_track_read_ptr(byte1, byte2);
 }
 /***********************************************************************************/
 void ds2482_100_write_three_bytes(uint8_t write_and_dest_chip, uint8_t byte1, uint8_t byte2, uint8_t byte3) {
@@ -416,6 +533,7 @@ void ds2482_100_write_three_bytes(uint8_t write_and_dest_chip, uint8_t byte1, ui
   i2c_write(byte2);
   i2c_write(byte3);
   i2c_stop();
+  ds2482_100_track_read_ptr(byte1, byte2);
 }
 /***********************************************************************************/
 byte ds2482_100_read_one_wire_byte(uint8_t read_and_source_chip){
@@ -435,20 +553,39 @@ void one_wire_read_status(uint8_t read_and_source_chip) {
   ds2482_100_status = i2c_read(0); // no ack
   i2c_stop();
 }
+#endif
 /***********************************************************************************/
 bool one_wire_channel_busy(uint8_t read_and_source_chip) {
   // y a-t-il une transmission en cours sur la ligne one wire ?
   bool fin;
 
   one_wire_read_status(read_and_source_chip);
-  fin =  ((ds2482_100_status & 0x01) > 0); // retourne un 1 si une transmission est en cours
+  fin =  ((ds2482_100_status & ds2482_100_status_1wb) > 0); // retourne un 1 si une transmission est en cours
   return fin;
 }
 /***********************************************************************************/
-void one_wire_end_xmit(uint8_t read_and_source_chip) {
-  do {
+bool one_wire_end_xmit(uint8_t read_and_source_chip) {
+  // attente de la fin de l'action 1-Wire : le status est relu ds la fin
+  // de la commande, puis  intervalle doubl pour ne pas occuper le bus I2C
+  // retourne false si 1WB est encore  1 aprs DS2482_BUSY_TIMEOUT_US
+  uint32_t deadline = I2C_DeadlineSet(DS2482_BUSY_TIMEOUT_US);
+  unsigned int poll_us = DS2482_POLL_MIN_US;
+
+  // pointeur sur le status, sans criture s'il y est dj
+  if (ds2482_100_read_ptr != ds2482_100_set_read_pointer_to_status_register) {
+    ds2482_100_write_two_bytes(read_and_source_chip & 0xFE, ds2482_100_set_read_pointer_code,
+                               ds2482_100_set_read_pointer_to_status_register);
+  }
+  while (one_wire_channel_busy(read_and_source_chip)) {
+    if (I2C_DeadlinePassed(deadline)) {
+      return false;
+    }
+    delay_us(poll_us);
+    if (poll_us < DS2482_POLL_MAX_US) {
+      poll_us *= 2;
+    }
   }
-  while (one_wire_channel_busy(read_and_source_chip));
+  return true;
 }
 /*******************************************************************************************/
 void one_wire_crc_computation(byte *ptr_on_byte, uint8_t nb_bytes) {
@@ -460,157 +597,121 @@ void one_wire_crc_computation(byte *ptr_on_byte, uint8_t nb_bytes) {
   }
 }
 /***********************************************************************************/
-void one_wire_search_rom() {
-  // on doit dterminer le code d'identification (64bits) du ds18b20
-  // ce code est compos de (du lsb au msb de droite  gauche):
-  // 8 bits family code (0x28 pour un ds18b20) puis48 bits d'identification unique puis 8 bits de crc
-
-  // pour chaque bit, on doit d'abord lire un bit sur la ligne, puis son complment, puis dterminer
-  // quel est le bit rel (utile en cas de multiples circuits du mme type) puis crire ce bit
-  // Les 8 premiers bits sont connus, c'est le family code
-  // Pour les autres, il faut y aller bit  bit
-  // Et  la fin contrler le crc
-
-  // En entrant  cet endroit, on a  disposition:
-  //byte *ident_string_starting_address; // pointeur sur le dbut du string d'identification
-  //byte *ident_string_ptr; // pointeur sur le string d'identification
-  //byte one_wire_cpt_ident_bit; // compteur de bits pour les 64bits de l'identifiant
-  //byte one_wire_cpt_ident_bit_action; // compteur des actions pour chaque bit: 0=lire bit, 1=lire bit complment, 2=crire le bit
-  //byte one_wire_match_rom_byte; // byte servant  envoyer les 64 bits un  un
-  //const byte bit_mask[] = {1,2,4,8,16,32,64,128};
-  //byte one_wire_crc; // pour le calcul du crc one wire
-  //bool one_wire_search_rom_finish, // bit indiquant la fin de la fonction search rom
-  //bool one_wire_search_rom_crc_ok; // bit indiquant que le crc reu  la fin de match rom est ok
-  // Pour les 8 premiers bits, on sait ce qu'on veut crire, c'est le family code sur lequel on pointe 
-  // Mais on doit tout de mme respecter la squence
-  if (one_wire_cpt_ident_bit <= 7) {
-    ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_write_config_code, ds2482_100_config_byte_spu);
-    switch (one_wire_cpt_ident_bit_action) {
-      case 0: {
-        // on doit lire un bit, donc on crit un 1
-        ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_1);
-        one_wire_cpt_ident_bit_action++;
-      }
-      break;
-      case 1: {
-        // on doit lire le complment de ce bit, donc on crit un 1
-        ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_1);
-        one_wire_cpt_ident_bit_action++;
-      }
-      break;
-      case 2: {
-        // il faut isoler et envoyer le bon bit
-        if (*ident_string_starting_address & (bit_mask[one_wire_cpt_ident_bit])) {
-          ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_1);
-        }
-        else {
-          ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_0);
-        }
-        one_wire_cpt_ident_bit_action = 0;
-        one_wire_cpt_ident_bit++;
-      }
-      break;
-    }
+// Identification des composants du bus par la commande triplet du DS2482
+// (algorithme de recherche Maxim, AN187). Le triplet lit le bit, son
+// complment et crit la direction en une seule commande.
+/***********************************************************************************/
+
+// tat de la recherche
+static byte one_wire_rom[8];              // dernier code trouv
+static byte one_wire_last_discrepancy;    // dernier bit o le 0 a t choisi
+static bool one_wire_last_device;         // plus de composant  trouver
+
+/***********************************************************************************/
+bool one_wire_reset_presence(void) {
+  // one wire reset/presence pulse, true si prsence sans court-circuit
+  ds2482_100_write_one_byte(ds2482_100_write, ds2482_100_one_wire_device_reset);
+  if (!one_wire_end_xmit(ds2482_100_read_address)) {
+    return false; // ligne bloque
   }
-  else { // cpt_ident_bit > 7
-    // Depuis ici, on ne s'adresse plus qu'au bon chip, il n'y a donc plus d'ambigut, on peut
-    // sans autre utiliser le systme standard du triplet pour les 7 bytes suivants (6 bytes serial number + 1 byte crc)
-    // ici aussi on doit utiliser cpt_ident_bit_action car on doit d'abord raliser ce triplet puis lire le rsultat dans le status
-    switch (one_wire_cpt_ident_bit_action) {
-      case 0: {
-        // on doit excuter le triplet, pas de possibilit de spu
-        ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_triplet_code, ds2482_100_1wire_single_bit_0);
-        one_wire_cpt_ident_bit_action = 1;
-      }
-      break;
-      case 1: {
-        // on doit lire ce bit dans le status
-        one_wire_read_status(ds2482_100_read_address);
-        // rotate right of pointed byte
-        ident_string_ptr = ident_string_starting_address + (one_wire_cpt_ident_bit / 8);
-        *ident_string_ptr /= 2;
-        if (ds2482_100_status & 0x20) { // keep only sbr
-        // put the bit in the right place
-          *ident_string_ptr += 128;
-        }
-        one_wire_cpt_ident_bit_action = 0;
-        if (one_wire_cpt_ident_bit < 63) {
-          one_wire_cpt_ident_bit++;
-        }
-        else { //one_wire_cpt_ident_bit >= 63
-          one_wire_crc_computation(ident_string_starting_address,7);
-          ident_string_ptr = ident_string_starting_address + 7; //crc
-          if (one_wire_crc == *ident_string_ptr) { //crc ok?
-            one_wire_search_rom_crc_ok = true;
-          }
-          else {
-            // si le crc n'est pas bon, on l'indique
-            one_wire_search_rom_crc_ok = false;
-          }
-          one_wire_search_rom_finish = true;
-        }
-      }
-      break;
+  return ((ds2482_100_status & 0x06) == 2); // keep only sd and ppd
+}
+/***********************************************************************************/
+bool one_wire_write_byte(uint8_t data) {
+  // false si la ligne est reste occupe
+  ds2482_100_write_two_bytes(ds2482_100_write_address, ds2482_100_1wire_write_byte_code, data);
+  return one_wire_end_xmit(ds2482_100_read_address);
+}
+/***********************************************************************************/
+void one_wire_search_reset(void) {
+  // la prochaine recherche repart du premier composant
+  one_wire_last_discrepancy = 0;
+  one_wire_last_device = false;
+}
+/***********************************************************************************/
+bool one_wire_search_rom(uint8_t *rom) {
+  // code d'identification suivant (64 bits, du lsb au msb) :
+  // 8 bits family code puis 48 bits d'identification unique puis 8 bits de crc
+  // retourne false s'il n'y a plus de composant (la recherche repart alors du dbut)
+  byte id_bit_number;
+  byte last_zero = 0;
+  byte *rom_byte;
+  byte rom_mask;
+  bool direction;
+
+  if (one_wire_last_device || !one_wire_reset_presence()) {
+    one_wire_search_reset();
+    return false;
+  }
+  if (!one_wire_write_byte(one_wire_search_rom_command_code)) {
+    one_wire_search_reset();
+    return false;
+  }
+
+  for (id_bit_number = 1; id_bit_number <= 64; id_bit_number++) {
+    rom_byte = &one_wire_rom[(id_bit_number - 1) / 8];
+    rom_mask = 1 << ((id_bit_number - 1) % 8);
+    // mme chemin que la recherche prcdente jusqu'au dernier conflit,
+    // 1 sur le dernier conflit, puis 0
+    if (id_bit_number < one_wire_last_discrepancy) {
+      direction = ((*rom_byte & rom_mask) != 0);
+    } else {
+      direction = (id_bit_number == one_wire_last_discrepancy);
+    }
+    ds2482_100_write_two_bytes(ds2482_100_write_address, ds2482_100_1wire_triplet_code,
+                               direction ? ds2482_100_1wire_single_bit_1 : ds2482_100_1wire_single_bit_0);
+    if (!one_wire_end_xmit(ds2482_100_read_address)) { // status du triplet dans ds2482_100_status
+      one_wire_search_reset();
+      return false;
+    }
+
+    if ((ds2482_100_status & ds2482_100_status_sbr) && (ds2482_100_status & ds2482_100_status_tsb)) {
+      // bit et complment  1 : plus aucun composant ne rpond
+      one_wire_search_reset();
+      return false;
     }
+    if (!(ds2482_100_status & (ds2482_100_status_sbr | ds2482_100_status_tsb | ds2482_100_status_dir))) {
+      // conflit, le 0 a t choisi : le 1 reste  explorer
+      last_zero = id_bit_number;
+    }
+    if (ds2482_100_status & ds2482_100_status_dir) {
+      *rom_byte |= rom_mask;
+    } else {
+      *rom_byte &= ~rom_mask;
+    }
+  }
+
+  // family code 0 : ligne tenue  0 (tous les bits lus  0, crc de
+  // zros nul donc valide), pas un composant
+  one_wire_crc_computation(one_wire_rom, 7);
+  if ((one_wire_rom[0] == 0) || (one_wire_crc != one_wire_rom[7])) {
+    one_wire_search_reset();
+    return false;
   }
+  one_wire_last_discrepancy = last_zero;
+  one_wire_last_device = (last_zero == 0);
+  for (id_bit_number = 0; id_bit_number < 8; id_bit_number++) {
+    rom[id_bit_number] = one_wire_rom[id_bit_number];
+  }
+  return true;
 }
 
 /***********************************************************************************/
-void one_wire_match_rom() {
-  // cette fonction effectue l'envoi des 64bits de l'ident sur lequel on pointe
-  // on ne contrle rien, le contrle est implicitement fait plus loin en contrlant
-  // le crc des valeurs lues
-  // on doit envoyer le string d'identification (64bits) du ds...
-  // ce code est compos de (du lsb au msb de droite  gauche):
-  // 8 bits family code (0x28 pour un ds18b20, 0x20 pour le ds2450, 0x26 pour le ds2438) puis48 bits d'identification unique puis 8 bits de crc
-
-  // pour chaque bit, on doit d'abord dterminer sa valeur puis l'envoyer
+bool one_wire_match_rom(const uint8_t *rom) {
+  // slection d'un composant aprs one_wire_reset_presence :
+  // commande match rom puis les 8 bytes du code, un write byte chacun
+  // false si la ligne est reste occupe
+  byte cnt;
 
-  // En entrant  cet endroit, on a  disposition:
-  //byte *ident_string_starting_address; // pointeur sur le dbut du string d'identification
-  //byte *ident_string_ptr; // pointeur sur le string d'identification
-  //byte one_wire_cpt_ident_bit; // compteur de bits pour les 64bits de l'identifiant
-  //byte one_wire_cpt_ident_bit_action; // compteur des actions pour chaque bit: 0=lire bit, 1=lire bit complment, 2=crire le bit
-  //byte one_wire_match_rom_byte; // byte servant  envoyer les 64 bits un  un
-  //const byte bit_mask[] = {1,2,4,8,16,32,64,128};
-  //bool one_wire_match_rom_finish, // bit indiquant la fin de la fonction match rom
-  // Pour les 8 premiers bits, on sait ce qu'on veut crire, c'est le family code sur lequel on pointe 
-  // Mais on doit tout de mme respecter la squence
-  
-  switch (one_wire_cpt_ident_bit_action) {
-    case 0: { // envoi du bit
-      // on pointe sur le bon byte
-      ident_string_ptr = ident_string_starting_address + (one_wire_cpt_ident_bit / 8);
-      // on charge ce bon byte
-      one_wire_match_rom_byte = *ident_string_ptr;
-      // il faut isoler et envoyer le bon bit
-      ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_write_config_code, ds2482_100_config_byte_spu);
-      if (one_wire_match_rom_byte & (bit_mask[one_wire_cpt_ident_bit % 8])) {
-        ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_1);
-      }
-      else {
-        ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_single_bit_code, ds2482_100_1wire_single_bit_0);
-      }
-      one_wire_cpt_ident_bit++;
-      // tous les 8 bits, on recharge la capacit
-      if (one_wire_cpt_ident_bit %8 == 0) {
-        temp_ten_ms_tics = 3; // nb of 10ms tics to wait 30ms (in fact 20ms to 30ms)
-        temp_bit_10ms_tics_count = true;
-        one_wire_cpt_ident_bit_action = 1;
-      }
-      if (one_wire_cpt_ident_bit > 63) {
-        one_wire_match_rom_finish = true;
-      }
-    }
-    break;
-    case 1: { // attente de la recharge de la capacit
-      if (temp_ten_ms_tics == 0) {
-        temp_bit_10ms_tics_count = false;
-        one_wire_cpt_ident_bit_action = 0;
-      }
+  if (!one_wire_write_byte(one_wire_match_rom_command_code)) {
+    return false;
+  }
+  for (cnt = 0; cnt < 8; cnt++) {
+    if (!one_wire_write_byte(rom[cnt])) {
+      return false;
     }
-    break;
   }
+  return true;
 }
 /***********************************************************************************/
 void crc16_computation(void) {
@@ -643,6 +744,10 @@ void init_oneWire() {
   sensor_select=0; //T1
   t_sense_action = one_wire_global_first;
   t_sense = one_wire_reset_chip;
+#ifdef DS2482_USE_I2C_MASTER
+  // sans effet si le moteur est dj initialis (LM92)
+  I2C_Master_Init(&I2cMasterKit, I2C_MASTER_KIT_ID, true);
+#endif
   //Prepare et active tous les
   //modes d'interruptions
   // enable_interrupts(INT_RTCC);
@@ -653,20 +758,23 @@ void init_oneWire() {
  
 uint8_t Step;
 
-void ReadDS18B20(uint8_t *Status, float *pTemp)
+// Lecture de la valeur brute (seizimes de degr), false si pas de capteur
+static bool ds18b20_read_raw(uint8_t *Status, int16_t *pRaw)
 {
-   float Temp = 21.5;
+   bool ok = false;
    uint8_t nb_bytes;
     
+   // ligne bloque (1WB toujours  1) : pas de mesure, status 0
+   *Status = 0;
     Step = 0;
    // reset du DS2482
    ds2482_100_write_one_byte(ds2482_100_write, ds2482_100_reset_code);
-   one_wire_end_xmit(ds2482_100_read_address);      
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    
     Step = 1;
    // one wire reset/presence pulse 
    ds2482_100_write_one_byte(ds2482_100_write, ds2482_100_one_wire_device_reset);
-   one_wire_end_xmit(ds2482_100_read_address); 
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    
    one_wire_read_status(ds2482_100_read);
         switch (ds2482_100_status & 0x06) { // keep only sd and ppd
@@ -691,7 +799,7 @@ void ReadDS18B20(uint8_t *Status, float *pTemp)
     Step = 2;
    // Commande 0XCC SKIP ROM
    ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_write_byte_code, one_wire_skip_rom_command_code);
-   one_wire_end_xmit(ds2482_100_read_address);  
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    
     Step = 3;
    // Force strong Pullup
@@ -699,7 +807,7 @@ void ReadDS18B20(uint8_t *Status, float *pTemp)
    
    // Commande 0X44 dbut conversion T
    ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_write_byte_code, ds18b20_convert_T_command_code);
-   one_wire_end_xmit(ds2482_100_read_address);  
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    Step = 4;
    
    
@@ -718,18 +826,18 @@ void ReadDS18B20(uint8_t *Status, float *pTemp)
     
     // one wire reset/presence pulse 
    ds2482_100_write_one_byte(ds2482_100_write, ds2482_100_one_wire_device_reset);
-   one_wire_end_xmit(ds2482_100_read_address);  
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
     Step = 6;
    // Commande 0xCC SKIP ROM
    ds2482_100_write_two_bytes(ds2482_100_write_address,ds2482_100_1wire_write_byte_code, one_wire_skip_rom_command_code);
-   one_wire_end_xmit(ds2482_100_read_address); 
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    Step = 7;
    
    // Commande 0xBE read scratchpad
    // on va lire 8 bytes de donnes et un crc, soit 9 bytes
    // de manire  gagner des bytes de code, on va le faire d'un coup
    ds2482_100_write_two_bytes(ds2482_100_write, ds2482_100_1wire_write_byte_code, ds18b20_read_scratchpad_command_code);
-   one_wire_end_xmit(ds2482_100_read_address); 
+   if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
    Step = 8;
    ds18b20_scratchpad_ptr = &sensor.Ds18b20_scratchpad.temp_lsb;
   
@@ -740,7 +848,7 @@ void ReadDS18B20(uint8_t *Status, float *pTemp)
    
       // Envoi la commande la lecture d'un byte
       ds2482_100_write_one_byte(ds2482_100_write,ds2482_100_1wire_read_byte_code);
-      one_wire_end_xmit(ds2482_100_read_address); 
+      if (!one_wire_end_xmit(ds2482_100_read_address)) goto ExitReadDs18b20;
       
       Step = 20 + nb_bytes;
       // Effectue la lecture d'un byte
@@ -749,21 +857,551 @@ void ReadDS18B20(uint8_t *Status, float *pTemp)
       ds2482_100_write_two_bytes(ds2482_100_write,ds2482_100_set_read_pointer_code, ds2482_100_set_read_pointer_to_read_data_register);
       *ds18b20_scratchpad_ptr = ds2482_100_read_one_wire_byte(ds2482_100_read_address);
        Step = 30 + nb_bytes;
-      // Remettre pointeur sur le Status pour attendre fin action
-      ds2482_100_write_two_bytes(ds2482_100_write,ds2482_100_set_read_pointer_code, ds2482_100_set_read_pointer_to_status_register);
-      one_wire_end_xmit(ds2482_100_read_address); 
+      // La commande read byte suivante remet le pointeur sur le Status
       Step = 40 + nb_bytes;
       ds18b20_scratchpad_ptr++; // pointe sur le byte suivant
       
    }   
     
-   // Expression de la temprature en degr
+   // Valeur brute, bit poids faible = 0.0625 degr
    new_temp.octet.msb = sensor.Ds18b20_scratchpad.temp_msb;
    new_temp.octet.lsb = sensor.Ds18b20_scratchpad.temp_lsb;
-   Temp = new_temp.signed_word * 0.0625;
+   *pRaw = new_temp.signed_word;
+   ok = true;
 ExitReadDs18b20:   
+   return ok;
+}
+
+// Conversion en millime de degr, calcul entier (pas de FPU)
+// 1/16 degr = 62.5 millimes, tronqu comme la conversion float -> int
+int32_t DS18B20_ConvRawToMilli(int16_t Raw)
+{
+   return ((int32_t)Raw * 125) / 2;
+}
+
+// Conversion en degr, utilise le float (bibliothque soft-float)
+void DS18B20_ConvRawToDeg(int16_t Raw, float *pTemp)
+{
+   // bit poids faible = 0.0625 degr
+   *pTemp = Raw * 0.0625;
+}
+
+// Temprature en millime de degr, calcul entier (pas de FPU)
+// 21500 si pas de capteur
+void ReadDS18B20Milli(uint8_t *Status, int32_t *pTempMilli)
+{
+   int16_t Raw;
+   int32_t TempMilli = 21500;
+
+   if (ds18b20_read_raw(Status, &Raw)) {
+      TempMilli = DS18B20_ConvRawToMilli(Raw);
+   }
+   *pTempMilli = TempMilli;
+}
+
+// Enveloppe float (bibliothque soft-float), 21.5 si pas de capteur
+void ReadDS18B20(uint8_t *Status, float *pTemp)
+{
+   int16_t Raw;
+   float Temp = 21.5;
+
+   if (ds18b20_read_raw(Status, &Raw)) {
+      DS18B20_ConvRawToDeg(Raw, &Temp);
+   }
    *pTemp = Temp;
 }
+
+#ifdef DS2482_USE_I2C_MASTER
+/***********************************************************************************/
+// Machine d'tat DS18B20_SM
+//
+// Chaque tape est une transaction du moteur I2C (priorit basse). Aprs
+// une commande 1-Wire, le pointeur de lecture du DS2482 est sur le status :
+// le bit 1WB est relu jusqu' la fin de l'action. L'attente de conversion
+// se fait sur le core timer, Execute rend la main  chaque appel.
+// Avec plusieurs capteurs, la conversion est lance pour tous (skip rom),
+// puis chaque capteur est lu par match rom : une seule attente de
+// conversion quel que soit le nombre de capteurs.
+/***********************************************************************************/
+
+// Etapes de la mesure (dernire action lance)
+typedef enum { ds18b20_sm_dev_reset,
+               ds18b20_sm_reset_presence_1,
+               ds18b20_sm_skip_rom_1,
+               ds18b20_sm_spu,
+               ds18b20_sm_convert_T,
+               ds18b20_sm_conv_wait,
+               ds18b20_sm_conv_bit,
+               ds18b20_sm_nospu,
+               ds18b20_sm_reset_presence_2,
+               ds18b20_sm_skip_rom_2,
+               ds18b20_sm_match_rom,
+               ds18b20_sm_match_rom_byte,
+               ds18b20_sm_read_scratchpad,
+               ds18b20_sm_read_byte,
+               ds18b20_sm_get_byte,
+             } t_ds18b20_sm_step;
+
+// Lance une commande DS2482 de 1 ou 2 octets, RxLen = 1 pour une lecture
+// Poll = true : attendre 1WB = 0 avant l'tape suivante
+static void ds18b20_sm_send(S_Descr_DS18B20_SM *pDescr, t_ds18b20_sm_step Step,
+                            uint8_t TxLen, uint8_t RxLen, bool Poll) {
+  pDescr->Step = Step;
+  pDescr->I2cTrans.pTx = pDescr->Tx;
+  pDescr->I2cTrans.TxLen = TxLen;
+  pDescr->I2cTrans.RxLen = RxLen;
+  pDescr->PollAfter = Poll;
+  pDescr->Polling = false;
+  I2C_Master_Submit(&I2cMasterKit, &pDescr->I2cTrans);
+}
+
+static void ds18b20_sm_cmd1(S_Descr_DS18B20_SM *pDescr, t_ds18b20_sm_step Step, byte Cmd) {
+  pDescr->Tx[0] = Cmd;
+  ds18b20_sm_send(pDescr, Step, 1, 0, true);
+}
+
+static void ds18b20_sm_cmd2(S_Descr_DS18B20_SM *pDescr, t_ds18b20_sm_step Step,
+                            byte Cmd, byte Param, bool Poll) {
+  pDescr->Tx[0] = Cmd;
+  pDescr->Tx[1] = Param;
+  ds18b20_sm_send(pDescr, Step, 2, 0, Poll);
+}
+
+// Lecture du status (pointeur dj sur le status register)
+// la lecture suivante attend un intervalle doubl
+static void ds18b20_sm_read_status(S_Descr_DS18B20_SM *pDescr) {
+  pDescr->Polling = true;
+  pDescr->NextPoll = I2C_DeadlineSet(pDescr->PollUs);
+  if (pDescr->PollUs < DS2482_POLL_MAX_US) {
+    pDescr->PollUs *= 2;
+  }
+  pDescr->I2cTrans.TxLen = 0;
+  pDescr->I2cTrans.RxLen = 1;
+  I2C_Master_Submit(&I2cMasterKit, &pDescr->I2cTrans);
+}
+
+// Avant une fonction bloquante : fin de la transaction en cours de la
+// machine d'tat et de l'action 1-Wire lance, la mesure repartira de Idle
+static void ds18b20_sm_quiesce(S_Descr_DS18B20_SM *pDescr) {
+  I2C_Master_Wait(&I2cMasterKit, &pDescr->I2cTrans);
+  // la machine d'tat ne suit pas le pointeur de lecture du DS2482
+  ds2482_100_read_ptr = ds2482_100_read_pointer_unknown;
+  one_wire_end_xmit(ds2482_100_read_address);
+  pDescr->Ds18b20state = DS18B20_SM_Idle;
+}
+
+// Slection du capteur suivant : reset/presence puis skip ou match rom
+static void ds18b20_sm_select(S_Descr_DS18B20_SM *pDescr) {
+  ds18b20_sm_cmd1(pDescr, ds18b20_sm_reset_presence_2, ds2482_100_one_wire_device_reset);
+}
+
+// Passage au capteur suivant, ready aprs le dernier
+static void ds18b20_sm_next_sensor(S_Descr_DS18B20_SM *pDescr) {
+  pDescr->Sensor++;
+  if (pDescr->Sensor < pDescr->NbSensors) {
+    // le reset suivant termine la lecture partielle
+    ds18b20_sm_select(pDescr);
+  } else {
+    pDescr->RetryMs = 0;
+    pDescr->Ds18b20state = DS18B20_SM_ready;
+  }
+}
+
+// Aucun capteur lu par la mesure en cours
+static void ds18b20_sm_invalidate(S_Descr_DS18B20_SM *pDescr) {
+  uint8_t Sensor;
+
+  for (Sensor = 0; Sensor < DS18B20_MAX_SENSORS; Sensor++) {
+    pDescr->Sensors[Sensor].Valid = false;
+  }
+}
+
+// Echec de la mesure (nack, collision, dlai ou ligne 1-Wire bloque) :
+// aucune valeur n'est sre, rsultat rendu  l'utilisateur et nouvelle
+// mesure retarde, l'attente double  chaque chec conscutif
+static void ds18b20_sm_fail(S_Descr_DS18B20_SM *pDescr) {
+  ds18b20_sm_invalidate(pDescr);
+  pDescr->Status = 0;
+  if (pDescr->RetryMs == 0) {
+    pDescr->RetryMs = DS18B20_SM_RETRY_MIN_MS;
+  } else if (pDescr->RetryMs < DS18B20_SM_RETRY_MAX_MS) {
+    pDescr->RetryMs *= 2;
+  }
+  pDescr->RetryDeadline = I2C_DeadlineSet((uint32_t)pDescr->RetryMs * 1000);
+  pDescr->Ds18b20state = DS18B20_SM_ready;
+}
+
+#if DS18B20_SM_READ_LEN < (ds18b20_config_index + 1)
+#error "DS18B20_SM_READ_LEN : lire au moins jusqu' l'octet de configuration"
+#endif
+
+// Fin de lecture d'un capteur : contrle de la configuration (et du crc
+// si le scratchpad est complet) puis conversion entire
+static void ds18b20_sm_store(S_Descr_DS18B20_SM *pDescr) {
+  S_DS18B20_SENSOR *pSensor = &pDescr->Sensors[pDescr->Sensor];
+  t_16bits Raw;
+  bool Valid;
+
+  Raw.octet.lsb = pDescr->Scratchpad[0];
+  Raw.octet.msb = pDescr->Scratchpad[1];
+  // bits fixes faux : pas de rponse (ligne au repos  1, 0xFF) ou
+  // octets altrs, une temprature plausible ne suffit pas
+  Valid = ((pDescr->Scratchpad[ds18b20_config_index] & ds18b20_config_fixed_mask)
+           == ds18b20_config_fixed_bits);
+  if (Valid && (DS18B20_SM_READ_LEN >= 9)) {
+    one_wire_crc_computation(pDescr->Scratchpad, 8);
+    Valid = (one_wire_crc == pDescr->Scratchpad[8]);
+  }
+  pSensor->Valid = Valid;
+  if (Valid) {
+    // bits sous la rsolution indfinis
+    Raw.word &= 0xFFFF << (12 - pDescr->Resolution);
+    pSensor->RawTemp = Raw.signed_word;
+    pSensor->TempMilli = DS18B20_ConvRawToMilli(pSensor->RawTemp);
+  }
+
+  ds18b20_sm_next_sensor(pDescr);
+}
+
+// Traite la fin de l'tape en cours et lance la suivante
+static void ds18b20_sm_step(S_Descr_DS18B20_SM *pDescr) {
+  switch (pDescr->Step) {
+    case ds18b20_sm_dev_reset :
+      // one wire reset/presence pulse
+      ds18b20_sm_cmd1(pDescr, ds18b20_sm_reset_presence_1, ds2482_100_one_wire_device_reset);
+    break;
+
+    case ds18b20_sm_reset_presence_1 :
+      pDescr->Status = pDescr->Rx & 0x06; // keep only sd and ppd
+      if (pDescr->Status != 2) {
+        // pas de capteur ou ligne en court-circuit : aucun capteur lu,
+        // les valeurs prcdentes ne sont plus valides
+        ds18b20_sm_invalidate(pDescr);
+        pDescr->Ds18b20state = DS18B20_SM_ready;
+        break;
+      }
+      ds18b20_sm_cmd2(pDescr, ds18b20_sm_skip_rom_1, ds2482_100_1wire_write_byte_code,
+                      one_wire_skip_rom_command_code, true);
+    break;
+
+    case ds18b20_sm_skip_rom_1 :
+      if (pDescr->ExtPower) {
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_convert_T, ds2482_100_1wire_write_byte_code,
+                        ds18b20_convert_T_command_code, true);
+      } else {
+        // Force strong Pullup pendant la conversion
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_spu, ds2482_100_write_config_code,
+                        ds2482_100_config_byte_spu, false);
+      }
+    break;
+
+    case ds18b20_sm_spu :
+      ds18b20_sm_cmd2(pDescr, ds18b20_sm_convert_T, ds2482_100_1wire_write_byte_code,
+                      ds18b20_convert_T_command_code, true);
+    break;
+
+    case ds18b20_sm_convert_T :
+      pDescr->Deadline = I2C_DeadlineSet((uint32_t)pDescr->ConvTimeMs * 1000);
+      pDescr->NextPoll = I2C_DeadlineSet(DS18B20_SM_POLL_MS * 1000);
+      pDescr->Step = ds18b20_sm_conv_wait;
+    break;
+
+    case ds18b20_sm_conv_wait :
+      if (pDescr->ExtPower) {
+        // lecture d'un bit : 0 tant que la conversion est en cours
+        if (I2C_DeadlinePassed(pDescr->NextPoll)) {
+          ds18b20_sm_cmd2(pDescr, ds18b20_sm_conv_bit, ds2482_100_1wire_single_bit_code,
+                          ds2482_100_1wire_single_bit_1, true);
+        }
+      } else if (I2C_DeadlinePassed(pDescr->Deadline)) {
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_nospu, ds2482_100_write_config_code,
+                        ds2482_100_config_byte_nospu, false);
+      }
+    break;
+
+    case ds18b20_sm_conv_bit :
+      if ((pDescr->Rx & ds2482_100_status_sbr) || I2C_DeadlinePassed(pDescr->Deadline)) {
+        pDescr->Sensor = 0;
+        ds18b20_sm_select(pDescr);
+      } else {
+        pDescr->NextPoll = I2C_DeadlineSet(DS18B20_SM_POLL_MS * 1000);
+        pDescr->Step = ds18b20_sm_conv_wait;
+      }
+    break;
+
+    case ds18b20_sm_nospu :
+      pDescr->Sensor = 0;
+      ds18b20_sm_select(pDescr);
+    break;
+
+    case ds18b20_sm_reset_presence_2 :
+      if ((pDescr->Rx & 0x06) != 2) { // keep only sd and ppd
+        // plus de prsence ou court-circuit : capteur non lu
+        pDescr->Sensors[pDescr->Sensor].Valid = false;
+        ds18b20_sm_next_sensor(pDescr);
+        break;
+      }
+      if (pDescr->NbSensors == 0) {
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_skip_rom_2, ds2482_100_1wire_write_byte_code,
+                        one_wire_skip_rom_command_code, true);
+      } else {
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_match_rom, ds2482_100_1wire_write_byte_code,
+                        one_wire_match_rom_command_code, true);
+        pDescr->Index = 0;
+      }
+    break;
+
+    case ds18b20_sm_match_rom :
+    case ds18b20_sm_match_rom_byte :
+      if (pDescr->Index < 8) {
+        // code ROM du capteur, un write byte par octet
+        ds18b20_sm_cmd2(pDescr, ds18b20_sm_match_rom_byte, ds2482_100_1wire_write_byte_code,
+                        pDescr->Sensors[pDescr->Sensor].Rom[pDescr->Index], true);
+        pDescr->Index++;
+        break;
+      }
+      // puis comme aprs skip rom
+    case ds18b20_sm_skip_rom_2 :
+      ds18b20_sm_cmd2(pDescr, ds18b20_sm_read_scratchpad, ds2482_100_1wire_write_byte_code,
+                      ds18b20_read_scratchpad_command_code, true);
+    break;
+
+    case ds18b20_sm_read_scratchpad :
+      pDescr->Index = 0;
+      ds18b20_sm_cmd1(pDescr, ds18b20_sm_read_byte, ds2482_100_1wire_read_byte_code);
+    break;
+
+    case ds18b20_sm_read_byte :
+      // pointeur sur read data puis lecture, dans la mme transaction
+      pDescr->Tx[0] = ds2482_100_set_read_pointer_code;
+      pDescr->Tx[1] = ds2482_100_set_read_pointer_to_read_data_register;
+      ds18b20_sm_send(pDescr, ds18b20_sm_get_byte, 2, 1, false);
+    break;
+
+    case ds18b20_sm_get_byte :
+      pDescr->Scratchpad[pDescr->Index] = pDescr->Rx;
+      pDescr->Index++;
+      if (pDescr->Index < DS18B20_SM_READ_LEN) {
+        // la commande remet le pointeur sur le status
+        ds18b20_sm_cmd1(pDescr, ds18b20_sm_read_byte, ds2482_100_1wire_read_byte_code);
+      } else {
+        ds18b20_sm_store(pDescr);
+      }
+    break;
+  }
+}
+
+/***********************************************************************************/
+// DS18B20_SM_Init
+// Initialisation de la machine d'tat et du moteur I2C
+/***********************************************************************************/
+
+void DS18B20_SM_Init(S_Descr_DS18B20_SM *pDescr, bool ExtPower) {
+  uint8_t Sensor;
+
+  pDescr->Ds18b20state = DS18B20_SM_Idle;
+  pDescr->ExtPower = ExtPower;
+  pDescr->Resolution = 12;        // valeur d'usine
+  pDescr->ConvTimeMs = DS18B20_CONV_TIME_MS;
+  pDescr->Status = 0;
+  pDescr->NbSensors = 0;
+  pDescr->RetryMs = 0;
+  for (Sensor = 0; Sensor < DS18B20_MAX_SENSORS; Sensor++) {
+    pDescr->Sensors[Sensor].Valid = false;
+    pDescr->Sensors[Sensor].RawTemp = 344;      // 21.5 degrs par dfaut
+    pDescr->Sensors[Sensor].TempMilli = 21500;
+  }
+
+  pDescr->I2cTrans.Address = ds2482_100_write;
+  pDescr->I2cTrans.pTx = pDescr->Tx;
+  pDescr->I2cTrans.pRx = &pDescr->Rx;
+  pDescr->I2cTrans.Callback = NULL;
+  pDescr->I2cTrans.Priority = I2C_PRIO_LOW;
+  pDescr->I2cTrans.pDevice = NULL;
+  pDescr->I2cTrans.Speed = I2C_SPEED_DEFAULT;
+  pDescr->I2cTrans.Result = I2C_MASTER_IDLE;
+
+  // sans effet si le moteur est dj initialis (LM92)
+  I2C_Master_Init(&I2cMasterKit, I2C_MASTER_KIT_ID, true);
+}
+
+/***********************************************************************************/
+// DS18B20_SM_Search
+// Recherche des DS18B20 de la ligne (bloquant,  appeler aprs l'init et
+// hors mesure). Retourne le nombre de capteurs mmoriss, 0 = skip rom.
+/***********************************************************************************/
+
+uint8_t DS18B20_SM_Search(S_Descr_DS18B20_SM *pDescr) {
+  uint8_t Rom[8];
+  uint8_t Nb = 0;
+  uint8_t cnt;
+
+  ds18b20_sm_quiesce(pDescr);
+  one_wire_search_reset();
+  while ((Nb < DS18B20_MAX_SENSORS) && one_wire_search_rom(Rom)) {
+    if (Rom[0] == ds18b20_family_code) {
+      for (cnt = 0; cnt < 8; cnt++) {
+        pDescr->Sensors[Nb].Rom[cnt] = Rom[cnt];
+      }
+      Nb++;
+    }
+  }
+  pDescr->NbSensors = Nb;
+  pDescr->Ds18b20state = DS18B20_SM_Idle;
+  return Nb;
+}
+
+/***********************************************************************************/
+// DS18B20_SM_SetResolution
+// Rsolution de tous les capteurs de la ligne (9  12 bits, bloquant, hors
+// mesure). CopyToEeprom : la configuration est conserve hors tension.
+// Retourne false si pas de capteur, ligne bloque ou rsolution hors limites.
+/***********************************************************************************/
+
+bool DS18B20_SM_SetResolution(S_Descr_DS18B20_SM *pDescr, uint8_t Bits, bool CopyToEeprom) {
+  uint8_t Shift;
+  bool Copied;
+
+  if ((Bits < 9) || (Bits > 12)) {
+    return false;
+  }
+  Shift = 12 - Bits;
+  ds18b20_sm_quiesce(pDescr);
+
+  // write scratchpad : th, tl, configuration (R1 R0 dans les bits 6 et 5)
+  if (!one_wire_reset_presence() ||
+      !one_wire_write_byte(one_wire_skip_rom_command_code) ||
+      !one_wire_write_byte(ds18b20_write_scratchpad_command_code) ||
+      !one_wire_write_byte(ds18b20_th_value) ||
+      !one_wire_write_byte(ds18b20_tl_value) ||
+      !one_wire_write_byte(ds18b20_config_byte_9bits | ((3 - Shift) << 5))) {
+    return false;
+  }
+
+  if (CopyToEeprom) {
+    if (!one_wire_reset_presence() ||
+        !one_wire_write_byte(one_wire_skip_rom_command_code)) {
+      return false;
+    }
+    // strong pullup pendant l'criture en EEPROM
+    ds2482_100_write_two_bytes(ds2482_100_write_address, ds2482_100_write_config_code, ds2482_100_config_byte_spu);
+    Copied = one_wire_write_byte(ds18b20_copy_scratchpad_command_code);
+    if (Copied) {
+      delay_ms(ds18b20_copy_scratchpad_ms);
+    }
+    ds2482_100_write_two_bytes(ds2482_100_write_address, ds2482_100_write_config_code, ds2482_100_config_byte_nospu);
+    if (!Copied) {
+      return false;
+    }
+  }
+
+  pDescr->Resolution = Bits;
+  pDescr->ConvTimeMs = (DS18B20_CONV_TIME_MS + (1 << Shift) - 1) >> Shift;
+  pDescr->Ds18b20state = DS18B20_SM_Idle;
+  return true;
+}
+
+/***********************************************************************************/
+// DS18B20_SM_Execute  ( Pour appel cyclique )
+/***********************************************************************************/
+
+void DS18B20_SM_Execute(S_Descr_DS18B20_SM *pDescr) {
+  switch (pDescr->Ds18b20state) {
+    case DS18B20_SM_Idle :
+      // Restart pendant une mesure : attendre la fin de la transaction
+      // en cours, sa soumission serait refuse
+      if (pDescr->I2cTrans.Result == I2C_MASTER_PENDING) {
+        I2C_Master_Watchdog(&I2cMasterKit);
+        break;
+      }
+      // aprs un chec, pas de trafic avant l'chance
+      if ((pDescr->RetryMs != 0) && !I2C_DeadlinePassed(pDescr->RetryDeadline)) {
+        break;
+      }
+      // reset du DS2482, dbut de la mesure
+      ds18b20_sm_cmd1(pDescr, ds18b20_sm_dev_reset, ds2482_100_reset_code);
+      pDescr->Ds18b20state = DS18B20_SM_Busy;
+    break;
+
+    case DS18B20_SM_Busy :
+      I2C_Master_Watchdog(&I2cMasterKit);
+      if (pDescr->I2cTrans.Result == I2C_MASTER_PENDING) {
+        break;
+      }
+      if (pDescr->I2cTrans.Result != I2C_MASTER_OK) {
+        // Nack, collision ou dlai dpass
+        ds18b20_sm_fail(pDescr);
+        break;
+      }
+      if (pDescr->PollAfter) {
+        if (!pDescr->Polling) {
+          // premire lecture ds la fin de la commande
+          pDescr->BusyDeadline = I2C_DeadlineSet(DS2482_BUSY_TIMEOUT_US);
+          pDescr->PollUs = DS2482_POLL_MIN_US;
+          ds18b20_sm_read_status(pDescr);
+          break;
+        }
+        if (pDescr->Rx & ds2482_100_status_1wb) {
+          if (I2C_DeadlinePassed(pDescr->BusyDeadline)) {
+            ds18b20_sm_fail(pDescr);   // 1-Wire bloqu
+          } else if (I2C_DeadlinePassed(pDescr->NextPoll)) {
+            ds18b20_sm_read_status(pDescr);
+          }
+          break;
+        }
+        pDescr->PollAfter = false;
+        pDescr->Polling = false;
+      }
+      ds18b20_sm_step(pDescr);
+    break;
+
+    case DS18B20_SM_ready :
+      // Attente du Restart de l'utilisateur
+    break;
+  }
+}
+
+void DS18B20_SM_Restart(S_Descr_DS18B20_SM *pDescr) {
+  pDescr->Ds18b20state = DS18B20_SM_Idle;
+}
+
+bool DS18B20_SM_IsReady(S_Descr_DS18B20_SM *pDescr) {
+  return (pDescr->Ds18b20state == DS18B20_SM_ready);
+}
+
+uint8_t DS18B20_SM_GetStatus(S_Descr_DS18B20_SM *pDescr) {
+  return pDescr->Status;
+}
+
+// Enveloppe float, calcule  la demande (bibliothque soft-float)
+// Le premier capteur (ou le seul en mode skip rom)
+float DS18B20_SM_GetTemp(S_Descr_DS18B20_SM *pDescr) {
+  return pDescr->Sensors[0].RawTemp * 0.0625;
+}
+
+int32_t DS18B20_SM_GetTempMilli(S_Descr_DS18B20_SM *pDescr) {
+  return pDescr->Sensors[0].TempMilli;
+}
+
+int16_t DS18B20_SM_GetRawTemp(S_Descr_DS18B20_SM *pDescr) {
+  return pDescr->Sensors[0].RawTemp;
+}
+
+uint8_t DS18B20_SM_GetNbSensors(S_Descr_DS18B20_SM *pDescr) {
+  return pDescr->NbSensors;
+}
+
+bool DS18B20_SM_IsSensorValid(S_Descr_DS18B20_SM *pDescr, uint8_t Sensor) {
+  return (Sensor < DS18B20_MAX_SENSORS) && pDescr->Sensors[Sensor].Valid;
+}
+
+int32_t DS18B20_SM_GetSensorTempMilli(S_Descr_DS18B20_SM *pDescr, uint8_t Sensor) {
+  if (Sensor >= DS18B20_MAX_SENSORS) {
+    Sensor = 0;
+  }
+  return pDescr->Sensors[Sensor].TempMilli;
+}
+#endif
  
  
 
@@ -11,15 +11,153 @@
 //	Version		:	V1.0
 //	Compilateur	:	XC32 V1.31
 // Modifications :
+//      17.10.2026 ajout ReadDS18B20Milli (entier, sans float)
+//      17.10.2026 ajout machine d'tat DS18B20_SM (non bloquante, moteur
+//                 Mc32_I2cMaster), ReadDS18B20 reste bloquant
+//      17.10.2026 identification des composants (one_wire_search_rom)
+//                 et slection par one_wire_match_rom
+//      17.10.2026 DS18B20_SM multi-capteurs : table des codes ROM, une
+//                 conversion commune (skip rom) puis lecture par match rom
+//      17.10.2026 rsolution 9  12 bits (DS18B20_SM_SetResolution), attente
+//                 de conversion adapte
+//      17.10.2026 fin d'action 1-Wire lue dans le status (bit 1WB), relecture
+//                  intervalle croissant
+//      17.10.2026 conversions publiques DS18B20_ConvRawToMilli (entier)
+//                 et DS18B20_ConvRawToDeg (float)
+//      17.10.2026 DS18B20_SM : erreur I2C ou ligne 1-Wire bloque, mesure
+//                 termine (ready, status 0, capteurs invalides) et
+//                 nouvelle mesure retarde (DS18B20_SM_RETRY_xx_MS)
+//      17.10.2026 DS18B20_SM_READ_LEN = 5, lecture valide par l'octet de
+//                 configuration du scratchpad
 //
+// Principe utilisation de DS18B20_SM :
+// ------------------------------------
+//
+// a) dclarer un descripteur S_Descr_DS18B20_SM
+//
+// b) appeler DS18B20_SM_Init avec &Descripteur
+//    ExtPower = true si le DS18B20 est aliment par VDD : la fin de
+//    conversion est alors lue sur le bus au lieu d'attendre 750 ms
+//    Plusieurs capteurs sur la ligne : appeler ensuite DS18B20_SM_Search
+//    (bloquant, une fois). Sans recherche, un seul capteur (skip rom).
+//    DS18B20_SM_SetResolution (bloquant) rgle la rsolution de tous les
+//    capteurs et la dure d'attente de conversion.
+//
+// c) Appeler cycliquement DS18B20_SM_Execute avec &Descripteur
+//    Chaque appel ne fait qu'avancer d'une tape (pas d'attente)
+//
+// d) Obtention des rsultat (Test dans cycle lents)
+//    if (DS18B20_SM_IsReady(&Descr) == true) {
+//        if (DS18B20_SM_GetStatus(&Descr) == 2) { // capteur prsent
+//            // status 0 : erreur I2C ou ligne bloque, aprs Restart
+//            // la mesure suivante attend DS18B20_SM_RETRY_xx_MS
+//            int32_t MyTempMilli = DS18B20_SM_GetTempMilli(&Descr);
+//            // ou pour chaque capteur trouv (i < NbSensors)
+//            MyTempMilli = DS18B20_SM_GetSensorTempMilli(&Descr, i);
+//        }
+//        // Relance la mesure
+//        DS18B20_SM_Restart(&Descr);
+//    }
 /*--------------------------------------------------------*/
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "Mc32_I2cMaster.h"
+
+// Dure de conversion 12 bits, divise par 2 par bit en moins
+// (9 bits : 94 ms, 10 bits : 188 ms, 11 bits : 375 ms)
+#define DS18B20_CONV_TIME_MS    750
+// Intervalle de lecture de la fin de conversion (ExtPower)
+#define DS18B20_SM_POLL_MS      10
+// Dure maximum d'une action 1-Wire (bit 1WB du DS2482), au-del la
+// ligne est considre bloque (fonctions bloquantes et DS18B20_SM)
+#define DS2482_BUSY_TIMEOUT_US  10000
+// Intervalle de relecture du status, doubl  chaque lecture 1WB = 1
+// (une action dure 70us  1.2ms)
+#define DS2482_POLL_MIN_US      20
+#define DS2482_POLL_MAX_US      320
+// Attente avant une nouvelle mesure aprs une erreur I2C (nack, collision,
+// dlai) ou une ligne 1-Wire bloque, double  chaque chec conscutif
+#define DS18B20_SM_RETRY_MIN_MS 10
+#define DS18B20_SM_RETRY_MAX_MS 1000
+// Nombre maximum de capteurs sur la ligne
+#define DS18B20_MAX_SENSORS     8
+// Octets lus du scratchpad : 5 = jusqu' la configuration (lecture
+// partielle, bits fixes contrls), 9 = scratchpad complet avec en plus
+// le contrle du crc
+#define DS18B20_SM_READ_LEN     5
+
+// enumeration  Etat principal
+typedef enum { DS18B20_SM_Idle, DS18B20_SM_Busy, DS18B20_SM_ready} E_DS18B20_state;
+
+// Un capteur de la ligne
+typedef struct {
+    uint8_t Rom[8];                 // code ROM (family code en premier)
+    bool Valid;                     // dernire lecture correcte
+    int16_t RawTemp;                // seizimes de degr
+    int32_t TempMilli;              // temprature en millime de degr
+} S_DS18B20_SENSOR;
+
+// Descripteur DS18B20 pour traitement par machine d'tat
+typedef struct {
+    E_DS18B20_state Ds18b20state;   // Etat principal
+    bool ExtPower;                  // alimentation par VDD (pas de SPU)
+    uint8_t Resolution;             // 9  12 bits
+    uint16_t ConvTimeMs;            // attente de conversion
+    uint8_t Step;                   // tape de la mesure (interne)
+    bool PollAfter;                 // attendre 1WB = 0 aprs la transaction
+    bool Polling;                   // lecture du status en cours
+    uint8_t Tx[2];                  // commande DS2482
+    uint8_t Rx;                     // status ou octet lu
+    uint8_t Index;                  // octet courant (code ROM ou scratchpad)
+    uint8_t Sensor;                 // capteur en cours de lecture
+    uint8_t NbSensors;              // 0 : un seul capteur, skip rom
+    uint8_t Scratchpad[9];
+    uint32_t Deadline;              // fin de conversion
+    uint32_t BusyDeadline;          // dlai de l'action 1-Wire (1WB)
+    uint32_t NextPoll;              // prochaine lecture du status ou du bit
+    uint16_t PollUs;                // intervalle de relecture du status
+    uint32_t RetryDeadline;         // pas de mesure avant (aprs un chec)
+    uint16_t RetryMs;               // attente aprs chec, 0 si dernire ok
+    S_I2C_TRANSACTION I2cTrans;     // Transaction pour Mc32_I2cMaster
+    uint8_t Status;                 // bits SD et PPD du DS2482, 2 = capteur ok
+    S_DS18B20_SENSOR Sensors[DS18B20_MAX_SENSORS];
+} S_Descr_DS18B20_SM;
 
 void init_oneWire(void);
 // modif du passage de paramtres
 void ReadDS18B20(uint8_t *Status, float *pTemp);
+// temprature en millime de degr, sans calcul float
+void ReadDS18B20Milli(uint8_t *Status, int32_t *pTempMilli);
+// conversion de la valeur brute (1/16 degr), entire ou float
+int32_t DS18B20_ConvRawToMilli(int16_t Raw);
+void DS18B20_ConvRawToDeg(int16_t Raw, float *pTemp);
+
+// Identification des composants du bus (fonctions bloquantes)
+//    one_wire_search_reset();
+//    while (one_wire_search_rom(Rom)) { ... mmoriser Rom ... }
+// puis slection : one_wire_reset_presence(); one_wire_match_rom(Rom);
+// false aussi si la ligne reste occupe (1WB) plus de DS2482_BUSY_TIMEOUT_US
+bool one_wire_reset_presence(void);
+bool one_wire_write_byte(uint8_t data);
+void one_wire_search_reset(void);
+bool one_wire_search_rom(uint8_t *rom);
+bool one_wire_match_rom(const uint8_t *rom);
+
+// Machine d'tat, disponible avec DS2482_USE_I2C_MASTER
+void DS18B20_SM_Init(S_Descr_DS18B20_SM *pDescr, bool ExtPower);
+uint8_t DS18B20_SM_Search(S_Descr_DS18B20_SM *pDescr);
+bool DS18B20_SM_SetResolution(S_Descr_DS18B20_SM *pDescr, uint8_t Bits, bool CopyToEeprom);
+void DS18B20_SM_Execute(S_Descr_DS18B20_SM *pDescr);
+void DS18B20_SM_Restart(S_Descr_DS18B20_SM *pDescr);
+bool DS18B20_SM_IsReady(S_Descr_DS18B20_SM *pDescr);
+uint8_t DS18B20_SM_GetStatus(S_Descr_DS18B20_SM *pDescr);
+float DS18B20_SM_GetTemp(S_Descr_DS18B20_SM *pDescr);
+int32_t DS18B20_SM_GetTempMilli(S_Descr_DS18B20_SM *pDescr);
+int16_t DS18B20_SM_GetRawTemp(S_Descr_DS18B20_SM *pDescr);
+uint8_t DS18B20_SM_GetNbSensors(S_Descr_DS18B20_SM *pDescr);
+bool DS18B20_SM_IsSensorValid(S_Descr_DS18B20_SM *pDescr, uint8_t Sensor);
+int32_t DS18B20_SM_GetSensorTempMilli(S_Descr_DS18B20_SM *pDescr, uint8_t Sensor);
 
 #endif
 
@@ -0,0 +1,514 @@
+//----------------------------------------------------------
+//      Mc32_I2cMaster.c
+//----------------------------------------------------------
+//	Description :	Moteur I2C master pilot par interruption
+//
+//      Date cration   :       17.10.2026
+//	Version		:	V1.5
+//	Compilateur	:	XC32 V1.40
+//      PLIB            :       Harmony 1_08
+//
+//      MODIFICATIONS   :
+//              17.10.2026 file d'attente par priorit, la transaction
+//                         suivante est lance par l'ISR ds le stop
+//              17.10.2026 cache du registre pointeur, le prfixe
+//                         pointeur + restart est omis si inutile
+//              17.10.2026 chien de garde et rcupration du bus
+//              17.10.2026 vitesse par transaction, BRG reprogramm
+//                         au lancement si la vitesse change
+//              17.10.2026 tat dans un descripteur par module (S_I2C_MASTER)
+//              17.10.2026 rcupration du bus aprs une collision
+//              17.10.2026 cache du pointeur prim par une rcupration
+//
+//      Chaque fin d'action du module (start, restart, octet mis avec
+//      son ack, octet reu, ack/nack envoy, stop) lve l'interruption
+//      master. L'ISR enchane l'action suivante de la transaction,
+//      la boucle principale n'intervient qu'au dbut et  la fin.
+//
+//      ATTENTION :
+//          Ne pas mlanger avec les fonctions I2C_SM_xxx ou i2c_xxx
+//          sur le mme module, tous les clients du bus doivent
+//          passer par le moteur
+//
+//-----------------------------------------------------------
+
+#include <stddef.h>
+#include "Mc32_I2cMaster.h"
+#include "Mc32_I2cTimeout.h"
+#include "peripheral/i2c/plib_i2c.h"
+#include "peripheral/int/plib_int.h"
+#include "system/clk/sys_clk.h"
+
+#define I2C_CLOCK_FAST 400000
+#define I2C_CLOCK_SLOW 100000
+#define I2C_CLOCK_FMPLUS 1000000
+
+// PBCLK minimum pour 1 MHz : BRG = PBCLK/2/Fsck - 1 - PBCLK*104ns/2 >= 2
+#define I2C_FMPLUS_MIN_PBCLK 8000000
+
+// Descripteur du bus du kit
+S_I2C_MASTER I2cMasterKit;
+
+//------------------------------------------------------------------------------
+// I2C_Master_SetResources
+//
+// Sources et vecteur d'interruption du module (I2C_ID_x = adresse de base)
+//------------------------------------------------------------------------------
+
+static void I2C_Master_SetResources(S_I2C_MASTER *pM, I2C_MODULE_ID I2cId)
+{
+    pM->I2cId = I2cId;
+
+    switch (I2cId) {
+        case I2C_ID_1 :
+            pM->IntSourceMaster = INT_SOURCE_I2C_1_MASTER;
+            pM->IntSourceBus = INT_SOURCE_I2C_1_BUS;
+            pM->IntVector = INT_VECTOR_I2C1;
+        break;
+        case I2C_ID_3 :
+            pM->IntSourceMaster = INT_SOURCE_I2C_3_MASTER;
+            pM->IntSourceBus = INT_SOURCE_I2C_3_BUS;
+            pM->IntVector = INT_VECTOR_I2C3;
+        break;
+        case I2C_ID_4 :
+            pM->IntSourceMaster = INT_SOURCE_I2C_4_MASTER;
+            pM->IntSourceBus = INT_SOURCE_I2C_4_BUS;
+            pM->IntVector = INT_VECTOR_I2C4;
+        break;
+        case I2C_ID_5 :
+            pM->IntSourceMaster = INT_SOURCE_I2C_5_MASTER;
+            pM->IntSourceBus = INT_SOURCE_I2C_5_BUS;
+            pM->IntVector = INT_VECTOR_I2C5;
+        break;
+        default :
+            pM->IntSourceMaster = INT_SOURCE_I2C_2_MASTER;
+            pM->IntSourceBus = INT_SOURCE_I2C_2_BUS;
+            pM->IntVector = INT_VECTOR_I2C2;
+        break;
+    }
+}
+
+//------------------------------------------------------------------------------
+// I2C_Master_Init
+//
+// Initialisation du module I2cId et de ses interruptions
+//      si BOOL Fast = FALSE   LOW speed  100 KHz
+//      si BOOL Fast = TRUE   HIGH speed  400 KHz
+//------------------------------------------------------------------------------
+
+void I2C_Master_Init(S_I2C_MASTER *pM, I2C_MODULE_ID I2cId, bool Fast)
+{
+    int Prio;
+
+    // Dj initialis par un autre client du bus
+    if (pM->Initialized) {
+        return;
+    }
+    pM->Initialized = true;
+    I2C_Master_SetResources(pM, I2cId);
+    pM->Phase = I2C_PH_Idle;
+    pM->pTrans = NULL;
+    for (Prio = 0; Prio < I2C_PRIO_NB; Prio++) {
+        pM->pHead[Prio] = NULL;
+        pM->pTail[Prio] = NULL;
+        pM->Skipped[Prio] = 0;
+    }
+
+    pM->DefaultSpeed = Fast ? I2C_SPEED_400K : I2C_SPEED_100K;
+    pM->Speed = pM->DefaultSpeed;
+
+    PLIB_I2C_Disable(pM->I2cId);
+    PLIB_I2C_BaudRateSet(pM->I2cId, SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1),
+                         Fast ? I2C_CLOCK_FAST : I2C_CLOCK_SLOW);
+    PLIB_I2C_StopInIdleDisable(pM->I2cId);
+    // Low frequency is enabled (**NOTE** PLIB function logic inverted)
+    PLIB_I2C_HighFrequencyEnable(pM->I2cId);
+
+    PLIB_INT_SourceDisable(INT_ID_0, pM->IntSourceMaster);
+    PLIB_INT_SourceDisable(INT_ID_0, pM->IntSourceBus);
+    PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceMaster);
+    PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceBus);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, pM->IntVector, I2C_MASTER_INT_PRIORITY);
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, pM->IntVector, INT_SUBPRIORITY_LEVEL0);
+
+    PLIB_I2C_Enable(pM->I2cId);
+
+    PLIB_INT_SourceEnable(INT_ID_0, pM->IntSourceMaster);
+    PLIB_INT_SourceEnable(INT_ID_0, pM->IntSourceBus);
+}
+
+// Choix de la prochaine transaction : la plus prioritaire, sauf si
+// une transaction moins prioritaire a dj attendu I2C_MASTER_MAX_SKIP fois
+static S_I2C_TRANSACTION *I2C_Master_Dequeue(S_I2C_MASTER *pM)
+{
+    S_I2C_TRANSACTION *pTrans;
+    int Prio;
+    int Chosen = I2C_PRIO_NB;
+
+    for (Prio = 0; Prio < I2C_PRIO_NB; Prio++) {
+        if (pM->pHead[Prio] != NULL) {
+            if (Chosen == I2C_PRIO_NB) {
+                Chosen = Prio;
+            } else if (pM->Skipped[Prio] >= I2C_MASTER_MAX_SKIP) {
+                Chosen = Prio;
+                break;
+            }
+        }
+    }
+    if (Chosen == I2C_PRIO_NB) {
+        return NULL;
+    }
+
+    // Les moins prioritaires qui attendent ont t dpasss une fois de plus
+    for (Prio = 0; Prio < I2C_PRIO_NB; Prio++) {
+        if (Prio == Chosen) {
+            pM->Skipped[Prio] = 0;
+        } else if ((Prio > Chosen) && (pM->pHead[Prio] != NULL)) {
+            pM->Skipped[Prio]++;
+        }
+    }
+
+    pTrans = pM->pHead[Chosen];
+    pM->pHead[Chosen] = pTrans->pNext;
+    if (pM->pHead[Chosen] == NULL) {
+        pM->pTail[Chosen] = NULL;
+    }
+    pTrans->pNext = NULL;
+    return pTrans;
+}
+
+// Vitesse effective d'une transaction
+static E_I2C_SPEED I2C_Master_SpeedOf(S_I2C_MASTER *pM, S_I2C_TRANSACTION *pTrans)
+{
+    E_I2C_SPEED Speed = pTrans->Speed;
+
+    if ((Speed == I2C_SPEED_DEFAULT) && (pTrans->pDevice != NULL)) {
+        Speed = pTrans->pDevice->Speed;
+    }
+    if (Speed == I2C_SPEED_DEFAULT) {
+        Speed = pM->DefaultSpeed;
+    }
+    return Speed;
+}
+
+// Reprogramme le BRG si la vitesse change, bus au repos (aprs un stop)
+static void I2C_Master_SpeedSet(S_I2C_MASTER *pM, E_I2C_SPEED Speed)
+{
+    uint32_t PbClk;
+    I2C_BAUD_RATE Baud;
+
+    if (Speed == pM->Speed) {
+        return;
+    }
+    PbClk = SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1);
+    switch (Speed) {
+        case I2C_SPEED_1M :
+            if (PbClk >= I2C_FMPLUS_MIN_PBCLK) {
+                Baud = I2C_CLOCK_FMPLUS;
+                break;
+            }
+            // BRG trop petit : 400 kHz
+            Speed = I2C_SPEED_400K;
+            Baud = I2C_CLOCK_FAST;
+        break;
+        case I2C_SPEED_400K :
+            Baud = I2C_CLOCK_FAST;
+        break;
+        default :
+            Speed = I2C_SPEED_100K;
+            Baud = I2C_CLOCK_SLOW;
+        break;
+    }
+    if (Speed == pM->Speed) {
+        return;
+    }
+    pM->Speed = Speed;
+    PLIB_I2C_Disable(pM->I2cId);
+    PLIB_I2C_BaudRateSet(pM->I2cId, PbClk, Baud);
+    PLIB_I2C_Enable(pM->I2cId);
+}
+
+// Lance la transaction suivante, le moteur doit tre au repos
+// (appel depuis l'ISR ou interruptions bloques)
+static void I2C_Master_StartNext(S_I2C_MASTER *pM)
+{
+    S_I2C_TRANSACTION *pTrans = I2C_Master_Dequeue(pM);
+
+    if (pTrans != NULL) {
+        pM->pTrans = pTrans;
+        pM->TxLen = pTrans->TxLen;
+        // Pointeur dj sur le registre : lecture seule
+        // (dcid au lancement, aprs les transactions prcdentes)
+        if ((pTrans->pDevice != NULL) &&
+            (pTrans->TxLen == 1) && (pTrans->RxLen > 0) &&
+            I2C_Master_DevicePtrIs(pTrans->pDevice, pTrans->pTx[0])) {
+            pM->TxLen = 0;
+        }
+        pM->Index = 0;
+        I2C_Master_SpeedSet(pM, I2C_Master_SpeedOf(pM, pTrans));
+        pM->Deadline = I2C_DeadlineSet(I2C_MASTER_TIMEOUT_US);
+        pM->Phase = I2C_PH_Start;
+        PLIB_I2C_MasterStart(pM->I2cId);
+    }
+}
+
+//------------------------------------------------------------------------------
+// I2C_Master_Submit
+//
+// Place la transaction dans la file de sa priorit et la lance si le
+// bus est libre. Retourne false si la transaction est dj en file
+// ou si le module n'est pas initialis.
+//------------------------------------------------------------------------------
+
+bool I2C_Master_Submit(S_I2C_MASTER *pM, S_I2C_TRANSACTION *pTrans)
+{
+    unsigned int IntState;
+    E_I2C_MASTER_PRIORITY Prio = pTrans->Priority;
+
+    if (!pM->Initialized || (pTrans->Result == I2C_MASTER_PENDING)) {
+        return false;
+    }
+    if (Prio >= I2C_PRIO_NB) {
+        Prio = I2C_PRIO_LOW;
+    }
+    pTrans->Result = I2C_MASTER_PENDING;
+    pTrans->pNext = NULL;
+
+    IntState = __builtin_get_isr_state();
+    __builtin_disable_interrupts();
+
+    if (pM->pTail[Prio] == NULL) {
+        pM->pHead[Prio] = pTrans;
+    } else {
+        pM->pTail[Prio]->pNext = pTrans;
+    }
+    pM->pTail[Prio] = pTrans;
+
+    if (pM->Phase == I2C_PH_Idle) {
+        I2C_Master_StartNext(pM);
+    }
+
+    __builtin_set_isr_state(IntState);
+    return true;
+}
+
+bool I2C_Master_IsBusy(S_I2C_MASTER *pM)
+{
+    return (pM->Phase != I2C_PH_Idle);
+}
+
+//------------------------------------------------------------------------------
+// I2C_Master_DeviceInit
+//
+// Composant dont le pointeur est inconnu jusqu' la premire criture
+//------------------------------------------------------------------------------
+
+void I2C_Master_DeviceInit(S_I2C_DEVICE *pDevice, uint8_t Address)
+{
+    pDevice->Address = Address;
+    pDevice->Ptr = 0;
+    pDevice->PtrValid = false;
+    pDevice->Speed = I2C_SPEED_DEFAULT;
+    pDevice->Recoveries = 0;
+}
+
+// A appeler si le pointeur a pu changer hors du moteur (reset du composant, ...)
+void I2C_Master_DeviceInvalidate(S_I2C_DEVICE *pDevice)
+{
+    pDevice->PtrValid = false;
+}
+
+// Pointeur crit et acquitt par le composant
+void I2C_Master_DevicePtrSet(S_I2C_DEVICE *pDevice, uint8_t Ptr)
+{
+    pDevice->Ptr = Ptr;
+    pDevice->Recoveries = I2C_BusRecoveryCount();
+    pDevice->PtrValid = true;
+}
+
+// Vrai si le pointeur du composant est sur Ptr (pas de rcupration depuis)
+bool I2C_Master_DevicePtrIs(S_I2C_DEVICE *pDevice, uint8_t Ptr)
+{
+    return pDevice->PtrValid && (pDevice->Ptr == Ptr) &&
+           (pDevice->Recoveries == I2C_BusRecoveryCount());
+}
+
+//------------------------------------------------------------------------------
+// I2C_Master_Wait
+//
+// Attente bloquante de la fin d'une transaction soumise
+// Ne pas appeler depuis une ISR de priorit >= I2C_MASTER_INT_PRIORITY
+//------------------------------------------------------------------------------
+
+E_I2C_MASTER_RESULT I2C_Master_Wait(S_I2C_MASTER *pM, S_I2C_TRANSACTION *pTrans)
+{
+    while (pTrans->Result == I2C_MASTER_PENDING) {
+        // l'ISR droule la file, le chien de garde borne l'attente
+        I2C_Master_Watchdog(pM);
+    }
+    return pTrans->Result;
+}
+
+// Termine par un stop, le rsultat est rendu  la fin du stop
+static void I2C_Master_Stop(S_I2C_MASTER *pM, E_I2C_MASTER_RESULT Result)
+{
+    pM->Result = Result;
+    pM->Phase = I2C_PH_Stop;
+    PLIB_I2C_MasterStop(pM->I2cId);
+}
+
+// Rend la transaction  son propritaire et enchane la suivante
+static void I2C_Master_End(S_I2C_MASTER *pM, E_I2C_MASTER_RESULT Result)
+{
+    S_I2C_TRANSACTION *pTrans = pM->pTrans;
+
+    // Le premier octet crit est le nouveau pointeur du composant
+    if (pTrans->pDevice != NULL) {
+        if (Result != I2C_MASTER_OK) {
+            pTrans->pDevice->PtrValid = false;
+        } else if (pM->TxLen > 0) {
+            I2C_Master_DevicePtrSet(pTrans->pDevice, pTrans->pTx[0]);
+        }
+    }
+
+    pM->pTrans = NULL;
+    pM->Phase = I2C_PH_Idle;
+    pTrans->Result = Result;
+    if (pTrans->Callback != NULL) {
+        pTrans->Callback(Result);
+    }
+    if (pM->Phase == I2C_PH_Idle) {
+        I2C_Master_StartNext(pM);
+    }
+}
+
+//------------------------------------------------------------------------------
+// I2C_Master_InterruptHandler
+//
+// Enchane les tapes de la transaction,  appeler depuis le vecteur
+// du module (interruptions master et collision sur le mme vecteur)
+//------------------------------------------------------------------------------
+
+void I2C_Master_InterruptHandler(S_I2C_MASTER *pM)
+{
+    S_I2C_TRANSACTION *pTrans = pM->pTrans;
+
+    // Le flag est effac avant de relancer le module
+    PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceMaster);
+
+    // Collision : le matriel a libr le bus, pas de stop possible
+    // Seul matre sur le bus : SDA est maintenue par un esclave,
+    // rcupration du bus sinon toutes les transactions suivantes chouent
+    if (PLIB_I2C_ArbitrationLossHasOccurred(pM->I2cId)) {
+        PLIB_I2C_ArbitrationLossClear(pM->I2cId);
+        if (pM->Phase != I2C_PH_Idle) {
+            I2C_BusRecovery(pM->I2cId);
+            PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceMaster);
+        }
+        PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceBus);
+        if (pM->Phase != I2C_PH_Idle) {
+            I2C_Master_End(pM, I2C_MASTER_BUS_ERROR);
+        }
+        return;
+    }
+
+    switch (pM->Phase) {
+        case I2C_PH_Start :
+            // Adresse en lecture seulement si rien  crire
+            if ((pM->TxLen == 0) && (pTrans->RxLen > 0)) {
+                pM->Phase = I2C_PH_AddrR;
+                PLIB_I2C_TransmitterByteSend(pM->I2cId, pTrans->Address | 0x01);
+            } else {
+                pM->Phase = I2C_PH_AddrW;
+                PLIB_I2C_TransmitterByteSend(pM->I2cId, pTrans->Address & 0xFE);
+            }
+        break;
+
+        case I2C_PH_AddrW :
+        case I2C_PH_Write :
+            if (!PLIB_I2C_TransmitterByteWasAcknowledged(pM->I2cId)) {
+                I2C_Master_Stop(pM, I2C_MASTER_NACK);
+            } else if (pM->Index < pM->TxLen) {
+                pM->Phase = I2C_PH_Write;
+                PLIB_I2C_TransmitterByteSend(pM->I2cId, pTrans->pTx[pM->Index]);
+                pM->Index++;
+            } else if (pTrans->RxLen > 0) {
+                pM->Phase = I2C_PH_ReStart;
+                PLIB_I2C_MasterStartRepeat(pM->I2cId);
+            } else {
+                I2C_Master_Stop(pM, I2C_MASTER_OK);
+            }
+        break;
+
+        case I2C_PH_ReStart :
+            pM->Phase = I2C_PH_AddrR;
+            PLIB_I2C_TransmitterByteSend(pM->I2cId, pTrans->Address | 0x01);
+        break;
+
+        case I2C_PH_AddrR :
+            if (!PLIB_I2C_TransmitterByteWasAcknowledged(pM->I2cId)) {
+                I2C_Master_Stop(pM, I2C_MASTER_NACK);
+            } else {
+                pM->Index = 0;
+                pM->Phase = I2C_PH_Read;
+                PLIB_I2C_MasterReceiverClock1Byte(pM->I2cId);
+            }
+        break;
+
+        case I2C_PH_Read :
+            // Ack sauf sur le dernier octet
+            pTrans->pRx[pM->Index] = PLIB_I2C_ReceivedByteGet(pM->I2cId);
+            pM->Index++;
+            pM->Phase = I2C_PH_Ack;
+            PLIB_I2C_ReceivedByteAcknowledge(pM->I2cId, pM->Index < pTrans->RxLen);
+        break;
+
+        case I2C_PH_Ack :
+            if (pM->Index < pTrans->RxLen) {
+                pM->Phase = I2C_PH_Read;
+                PLIB_I2C_MasterReceiverClock1Byte(pM->I2cId);
+            } else {
+                I2C_Master_Stop(pM, I2C_MASTER_OK);
+            }
+        break;
+
+        case I2C_PH_Stop :
+            I2C_Master_End(pM, pM->Result);
+        break;
+
+        case I2C_PH_Idle :
+            // interruption parasite
+        break;
+    }
+} // end I2C_Master_InterruptHandler
+
+//------------------------------------------------------------------------------
+// I2C_Master_Watchdog  ( Pour appel cyclique )
+//
+// Termine la transaction en cours si elle dpasse son chance : plus
+// d'interruption (SCL bloque) ou bus occup (SDA bloque)
+//------------------------------------------------------------------------------
+
+void I2C_Master_Watchdog(S_I2C_MASTER *pM)
+{
+    unsigned int IntState;
+
+    if (pM->Phase == I2C_PH_Idle) {
+        return;
+    }
+
+    IntState = __builtin_get_isr_state();
+    __builtin_disable_interrupts();
+
+    // Nouveau test, l'ISR a pu terminer entre temps
+    if ((pM->Phase != I2C_PH_Idle) && I2C_DeadlinePassed(pM->Deadline)) {
+        PLIB_INT_SourceDisable(INT_ID_0, pM->IntSourceMaster);
+        I2C_BusRecovery(pM->I2cId);
+        PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceMaster);
+        PLIB_INT_SourceFlagClear(INT_ID_0, pM->IntSourceBus);
+        PLIB_INT_SourceEnable(INT_ID_0, pM->IntSourceMaster);
+        I2C_Master_End(pM, I2C_MASTER_TIMEOUT);
+    }
+
+    __builtin_set_isr_state(IntState);
+} // end I2C_Master_Watchdog
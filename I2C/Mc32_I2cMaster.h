@@ -0,0 +1,203 @@
+#ifndef MC32_I2CMASTER_H
+#define MC32_I2CMASTER_H
+//--------------------------------------------------------
+//	Mc32_I2cMaster.h
+//--------------------------------------------------------
+//	Description :	Moteur I2C master pilot par interruption
+//                      Une transaction complte (start, adresse,
+//                      critures, restart, lectures, stop) est
+//                      droule par l'ISR du module I2C
+//
+//      Date            :       17.10.2026
+//	Version		:	V1.5
+//	Compilateur	:	XC32 V1.40
+//      plib            :       Harmony 1_08
+//
+// Modifications :
+//      17.10.2026 file d'attente par priorit, partage du bus entre
+//                 plusieurs clients (LM92, DS2482, ...)
+//      17.10.2026 cache du registre pointeur par composant (S_I2C_DEVICE)
+//      17.10.2026 chien de garde I2C_Master_Watchdog, rcupration du bus
+//      17.10.2026 vitesse par transaction ou par composant (100k, 400k, 1M)
+//      17.10.2026 un descripteur par module (I2C1  I2C5), les bus
+//                 indpendants transfrent en parallle
+//      17.10.2026 cache du pointeur partag avec les fonctions i2c_xxx
+//                 (I2C_Master_DevicePtrSet / PtrIs), prim aprs une
+//                 rcupration du bus
+//
+// Principe utilisation :
+// ----------------------
+//
+// a) dclarer un descripteur S_I2C_MASTER par module utilis et appeler
+//    I2C_Master_Init une seule fois par module. Le bus du kit (I2C2,
+//    LM92 et DS2482) utilise le descripteur I2cMasterKit
+//
+// b) remplir une transaction (S_I2C_TRANSACTION, dure de vie
+//    au moins jusqu' la fin, Result = I2C_MASTER_IDLE avant la
+//    premire soumission) et la soumettre par I2C_Master_Submit
+//    Les transactions sont mises en file et servies par priorit,
+//    dans l'ordre d'arrive pour une mme priorit. Une transaction
+//    de priorit basse passe aprs au plus I2C_MASTER_MAX_SKIP
+//    transactions plus prioritaires.
+//
+// c) tester Transaction.Result (!= I2C_MASTER_PENDING) dans le cycle
+//    ou utiliser le callback (appel depuis l'ISR)
+//    I2C_Master_Wait attend la fin (hors ISR, le bus avance seul)
+//
+// Cache du registre pointeur (LM92, LM75, ... sans auto-incrment) :
+//    dclarer un S_I2C_DEVICE par composant (I2C_Master_DeviceInit) et
+//    le placer dans pDevice de toutes ses transactions. Une lecture
+//    prcde de l'criture d'un seul octet (pointeur + restart + lecture)
+//    devient une simple lecture si le pointeur du composant est dj sur
+//    ce registre. Toute criture met  jour le cache, une erreur l'efface.
+//    Une rcupration du bus (I2C_BusRecovery, quel que soit le client)
+//    prime tous les caches. Les fonctions i2c_xxx d'un composant utilisent
+//    le mme S_I2C_DEVICE : I2C_Master_DevicePtrSet aprs une criture du
+//    pointeur acquitte, I2C_Master_DevicePtrIs avant une lecture seule.
+//
+// Vitesse : Transaction.Speed, sinon pDevice->Speed, sinon la vitesse
+//    choisie par I2C_Master_Init (I2C_SPEED_DEFAULT = 0, les transactions
+//    existantes ne changent pas). Le BRG n'est reprogramm qu'entre deux
+//    transactions et seulement si la vitesse change. Le 1 MHz (Fast-mode
+//    Plus) demande des composants et des pull-up prvus pour, il retombe
+//     400 kHz si PBCLK est trop lent pour le BRG.
+//    Le "slope control" reste dsactiv  toutes les vitesses (LM92).
+//
+// Chien de garde : appeler cycliquement I2C_Master_Watchdog. Une
+// transaction qui dpasse I2C_MASTER_TIMEOUT_US (esclave qui bloque SCL
+// ou SDA) est termine en I2C_MASTER_TIMEOUT aprs rcupration du bus,
+// la file continue avec la suivante.
+//
+// d) le vecteur de chaque module doit appeler I2C_Master_InterruptHandler :
+//    void __ISR(_I2C_2_VECTOR, ipl2AUTO) IntHandlerI2cMaster(void)
+//    {
+//        I2C_Master_InterruptHandler(&I2cMasterKit);
+//    }
+//    Sur le 795F512L, I2C3, I2C4 et I2C5 partagent leur vecteur avec
+//    SPI/UART (_I2C_3_VECTOR = _UART_1_VECTOR, ...) : le handler commun
+//    appelle I2C_Master_InterruptHandler s'il utilise le module.
+//
+// Le moteur utilise directement le plib, il remplace la suite
+// I2C_SM_start / write / reStart / read / stop de Mc32_I2cUtil_SM
+//--------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "peripheral/i2c/plib_i2c.h"
+#include "peripheral/int/plib_int.h"
+
+// Module I2C du kit (SCL2/RA2, SDA2/RA3)
+#define I2C_MASTER_KIT_ID       I2C_ID_2
+
+// La priorit doit correspondre  l'ipl du __ISR
+#define I2C_MASTER_INT_PRIORITY INT_PRIORITY_LEVEL2
+
+// Rsultat d'une transaction
+typedef enum { I2C_MASTER_IDLE,         // jamais soumise
+               I2C_MASTER_PENDING,      // en file ou en cours
+               I2C_MASTER_OK,           // termine
+               I2C_MASTER_NACK,         // adresse ou octet non acquitt
+               I2C_MASTER_BUS_ERROR,    // collision sur le bus, bus rcupr
+               I2C_MASTER_TIMEOUT,      // dlai dpass, bus rcupr
+                                } E_I2C_MASTER_RESULT;
+
+// Priorit d'une transaction
+typedef enum { I2C_PRIO_HIGH,           // mesures urgentes
+               I2C_PRIO_NORMAL,
+               I2C_PRIO_LOW,            // longues squences (1-Wire, ...)
+               I2C_PRIO_NB,
+                                } E_I2C_MASTER_PRIORITY;
+
+// Vitesse du bus pour une transaction
+typedef enum { I2C_SPEED_DEFAULT,       // vitesse de I2C_Master_Init
+               I2C_SPEED_100K,
+               I2C_SPEED_400K,
+               I2C_SPEED_1M,            // Fast-mode Plus
+                                } E_I2C_SPEED;
+
+// Nombre de transactions plus prioritaires servies avant une
+// transaction en attente
+#define I2C_MASTER_MAX_SKIP     4
+
+// Dure maximum d'une transaction (depuis son start)
+#define I2C_MASTER_TIMEOUT_US   10000
+
+// Composant avec registre pointeur
+typedef struct {
+    uint8_t Address;                // adresse 8 bits en criture
+    uint8_t Ptr;                    // dernier pointeur crit
+    bool PtrValid;                  // Ptr correspond au composant
+    E_I2C_SPEED Speed;              // vitesse max. du composant
+    uint32_t Recoveries;            // I2C_BusRecoveryCount()  l'criture
+} S_I2C_DEVICE;
+
+// Appel depuis l'ISR  la fin de la transaction
+typedef void (*I2C_MASTER_CALLBACK)(E_I2C_MASTER_RESULT Result);
+
+// Descripteur d'une transaction : critures puis lectures aprs restart
+// TxLen = 0 : lecture seule, RxLen = 0 : criture seule
+// TxLen = RxLen = 0 : simple test de prsence (adresse en criture)
+typedef struct S_I2C_TRANSACTION {
+    uint8_t Address;                // adresse 8 bits en criture (ex. 0x90)
+    const uint8_t *pTx;             // octets  crire
+    uint8_t TxLen;
+    uint8_t *pRx;                   // octets lus
+    uint8_t RxLen;
+    I2C_MASTER_CALLBACK Callback;   // NULL si pas utilis
+    E_I2C_MASTER_PRIORITY Priority;
+    S_I2C_DEVICE *pDevice;          // NULL si pas de cache du pointeur
+    E_I2C_SPEED Speed;              // prioritaire sur pDevice->Speed
+    volatile E_I2C_MASTER_RESULT Result;
+    struct S_I2C_TRANSACTION *pNext;    // usage interne (file d'attente)
+} S_I2C_TRANSACTION;
+
+// Etapes de la transaction, chacune termine par une interruption
+typedef enum { I2C_PH_Idle,
+               I2C_PH_Start,
+               I2C_PH_AddrW,
+               I2C_PH_Write,
+               I2C_PH_ReStart,
+               I2C_PH_AddrR,
+               I2C_PH_Read,
+               I2C_PH_Ack,
+               I2C_PH_Stop,
+                                } E_I2C_PHASE;
+
+// Descripteur d'un module, champs  usage interne
+typedef struct {
+    I2C_MODULE_ID I2cId;            // module et ressources associes
+    INT_SOURCE IntSourceMaster;
+    INT_SOURCE IntSourceBus;
+    INT_VECTOR IntVector;
+    volatile E_I2C_PHASE Phase;
+    S_I2C_TRANSACTION *pTrans;      // transaction en cours
+    uint8_t Index;                  // octet courant (criture ou lecture)
+    uint8_t TxLen;                  // octets  crire (0 si pointeur en cache)
+    uint32_t Deadline;              // chance de la transaction en cours
+    E_I2C_SPEED DefaultSpeed;       // vitesse de I2C_Master_Init
+    E_I2C_SPEED Speed;              // vitesse programme dans le BRG
+    E_I2C_MASTER_RESULT Result;     // rsultat transmis aprs le stop
+    bool Initialized;
+    // File d'attente par priorit
+    S_I2C_TRANSACTION *pHead[I2C_PRIO_NB];
+    S_I2C_TRANSACTION *pTail[I2C_PRIO_NB];
+    uint8_t Skipped[I2C_PRIO_NB];   // transactions servies avant la tte
+} S_I2C_MASTER;
+
+// Descripteur du bus du kit (I2C_MASTER_KIT_ID)
+extern S_I2C_MASTER I2cMasterKit;
+
+// prototypes des fonctions
+void I2C_Master_Init(S_I2C_MASTER *pM, I2C_MODULE_ID I2cId, bool Fast);
+bool I2C_Master_Submit(S_I2C_MASTER *pM, S_I2C_TRANSACTION *pTrans);
+bool I2C_Master_IsBusy(S_I2C_MASTER *pM);
+E_I2C_MASTER_RESULT I2C_Master_Wait(S_I2C_MASTER *pM, S_I2C_TRANSACTION *pTrans);
+void I2C_Master_InterruptHandler(S_I2C_MASTER *pM);
+void I2C_Master_Watchdog(S_I2C_MASTER *pM);
+
+void I2C_Master_DeviceInit(S_I2C_DEVICE *pDevice, uint8_t Address);
+void I2C_Master_DeviceInvalidate(S_I2C_DEVICE *pDevice);
+void I2C_Master_DevicePtrSet(S_I2C_DEVICE *pDevice, uint8_t Ptr);
+bool I2C_Master_DevicePtrIs(S_I2C_DEVICE *pDevice, uint8_t Ptr);
+
+#endif
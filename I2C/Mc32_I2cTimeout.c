@@ -0,0 +1,138 @@
+//----------------------------------------------------------
+//      Mc32_I2cTimeout.c
+//----------------------------------------------------------
+//	Description :	Dlais limites des primitives I2C et
+//                      rcupration d'un bus bloqu
+//
+//      Date cration   :       17.10.2026
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.40
+//      PLIB            :       Harmony 1_08
+//
+//      MODIFICATIONS   :
+//              17.10.2026 compteur des rcuprations (tous modules)
+//
+//-----------------------------------------------------------
+
+#include <xc.h>                 // pour _CP0_GET_COUNT()
+#include "Mc32_I2cTimeout.h"
+#include "Mc32Delays.h"
+#include "peripheral/ports/plib_ports.h"
+#include "system/clk/sys_clk.h"
+
+// Demi-priode SCL pendant la rcupration (100 kHz)
+#define I2C_RECOVERY_HALF_US    5
+#define I2C_RECOVERY_CLOCKS     9
+
+// Broches SCL / SDA des modules I2C du PIC32MX795F512L
+typedef struct {
+    PORTS_CHANNEL SclChannel;
+    PORTS_BIT_POS SclPos;
+    PORTS_CHANNEL SdaChannel;
+    PORTS_BIT_POS SdaPos;
+} S_I2C_PINS;
+
+static const S_I2C_PINS i2cPins1 = { PORTS_CHANNEL_A, PORTS_BIT_POS_14, PORTS_CHANNEL_A, PORTS_BIT_POS_15 };
+static const S_I2C_PINS i2cPins2 = { PORTS_CHANNEL_A, PORTS_BIT_POS_2,  PORTS_CHANNEL_A, PORTS_BIT_POS_3  };
+static const S_I2C_PINS i2cPins3 = { PORTS_CHANNEL_F, PORTS_BIT_POS_8,  PORTS_CHANNEL_F, PORTS_BIT_POS_2  };
+static const S_I2C_PINS i2cPins4 = { PORTS_CHANNEL_G, PORTS_BIT_POS_8,  PORTS_CHANNEL_G, PORTS_BIT_POS_7  };
+static const S_I2C_PINS i2cPins5 = { PORTS_CHANNEL_F, PORTS_BIT_POS_5,  PORTS_CHANNEL_F, PORTS_BIT_POS_4  };
+
+// Rcuprations depuis le dmarrage, une transaction a t interrompue
+static volatile uint32_t i2cRecoveries;
+
+// Les I2C_ID_x ne sont pas des index (adresses de base des modules)
+static const S_I2C_PINS *I2C_PinsGet(I2C_MODULE_ID Id)
+{
+    switch (Id) {
+        case I2C_ID_1 : return &i2cPins1;   // SCL1/RA14 SDA1/RA15
+        case I2C_ID_3 : return &i2cPins3;   // SCL3/RF8  SDA3/RF2
+        case I2C_ID_4 : return &i2cPins4;   // SCL4/RG8  SDA4/RG7
+        case I2C_ID_5 : return &i2cPins5;   // SCL5/RF5  SDA5/RF4
+        default :       return &i2cPins2;   // SCL2/RA2  SDA2/RA3 (kit)
+    }
+}
+
+//------------------------------------------------------------------------------
+// I2C_DeadlineSet / I2C_DeadlinePassed
+//
+// Echance en ticks du core timer, la comparaison supporte le dbordement
+//------------------------------------------------------------------------------
+
+uint32_t I2C_DeadlineSet(uint32_t TimeoutUs)
+{
+    uint32_t TicksPerUs = SYS_CLK_SystemFrequencyGet() / 2000000;
+
+    return _CP0_GET_COUNT() + (TimeoutUs * TicksPerUs);
+}
+
+bool I2C_DeadlinePassed(uint32_t Deadline)
+{
+    return ((int32_t)(_CP0_GET_COUNT() - Deadline) >= 0);
+}
+
+// Ligne  0 : sortie avec latch  0, ligne  1 : entre (pull-up du bus)
+static void I2C_LineLow(PORTS_CHANNEL Channel, PORTS_BIT_POS Pos)
+{
+    PLIB_PORTS_PinClear(PORTS_ID_0, Channel, Pos);
+    PLIB_PORTS_PinDirectionOutputSet(PORTS_ID_0, Channel, Pos);
+}
+
+static void I2C_LineRelease(PORTS_CHANNEL Channel, PORTS_BIT_POS Pos)
+{
+    PLIB_PORTS_PinDirectionInputSet(PORTS_ID_0, Channel, Pos);
+}
+
+//------------------------------------------------------------------------------
+// I2C_BusRecovery
+//
+// Module dsactiv, SCL pilote  la main jusqu' ce que l'esclave
+// relche SDA (9 coups au plus), puis stop et remise en service.
+// Dure au plus 100 us environ.
+//------------------------------------------------------------------------------
+
+void I2C_BusRecovery(I2C_MODULE_ID Id)
+{
+    const S_I2C_PINS *pPins = I2C_PinsGet(Id);
+    int Clock;
+
+    PLIB_I2C_Disable(Id);
+    I2C_LineRelease(pPins->SdaChannel, pPins->SdaPos);
+    I2C_LineRelease(pPins->SclChannel, pPins->SclPos);
+    delay_us(I2C_RECOVERY_HALF_US);
+
+    for (Clock = 0; Clock < I2C_RECOVERY_CLOCKS; Clock++) {
+        if (PLIB_PORTS_PinGet(PORTS_ID_0, pPins->SdaChannel, pPins->SdaPos)) {
+            break;   // SDA relche
+        }
+        I2C_LineLow(pPins->SclChannel, pPins->SclPos);
+        delay_us(I2C_RECOVERY_HALF_US);
+        I2C_LineRelease(pPins->SclChannel, pPins->SclPos);
+        delay_us(I2C_RECOVERY_HALF_US);
+    }
+
+    // Stop : SDA monte pendant que SCL est  1
+    I2C_LineLow(pPins->SclChannel, pPins->SclPos);
+    I2C_LineLow(pPins->SdaChannel, pPins->SdaPos);
+    delay_us(I2C_RECOVERY_HALF_US);
+    I2C_LineRelease(pPins->SclChannel, pPins->SclPos);
+    delay_us(I2C_RECOVERY_HALF_US);
+    I2C_LineRelease(pPins->SdaChannel, pPins->SdaPos);
+    delay_us(I2C_RECOVERY_HALF_US);
+
+    PLIB_I2C_ArbitrationLossClear(Id);
+    PLIB_I2C_Enable(Id);
+    i2cRecoveries++;
+}
+
+//------------------------------------------------------------------------------
+// I2C_BusRecoveryCount
+//
+// Nombre de rcuprations, le pointeur d'un composant crit avant la
+// dernire n'est plus sr (transaction coupe, composant rinitialis)
+//------------------------------------------------------------------------------
+
+uint32_t I2C_BusRecoveryCount(void)
+{
+    return i2cRecoveries;
+}
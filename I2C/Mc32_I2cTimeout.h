@@ -0,0 +1,42 @@
+#ifndef MC32_I2CTIMEOUT_H
+#define MC32_I2CTIMEOUT_H
+//--------------------------------------------------------
+//	Mc32_I2cTimeout.h
+//--------------------------------------------------------
+//	Description :	Dlais limites des primitives I2C et
+//                      rcupration d'un bus bloqu
+//
+//      Date            :       17.10.2026
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.40
+//      plib            :       Harmony 1_08
+//
+// Les dlais utilisent le core timer (SYSCLK / 2), sans interruption.
+// La rcupration libre un esclave qui maintient SDA  0 : jusqu'
+// 9 impulsions sur SCL puis un stop, module I2C dsactiv.
+//
+// Modifications :
+//      17.10.2026 compteur des rcuprations, un cache de pointeur
+//                 (S_I2C_DEVICE) crit avant une rcupration est prim
+//--------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "peripheral/i2c/plib_i2c.h"
+
+// Dlai par dfaut d'une primitive (start, octet, stop)
+// un octet dure 90 us  100 kHz, marge pour le clock stretching
+#define I2C_TIMEOUT_US      2000
+
+// Rsultat des primitives avec dlai
+typedef enum { I2C_STATUS_OK,
+               I2C_STATUS_TIMEOUT,      // dlai dpass, bus rcupr
+               I2C_STATUS_COLLISION,    // collision, bus rcupr
+                                } E_I2C_STATUS;
+
+uint32_t I2C_DeadlineSet(uint32_t TimeoutUs);
+bool I2C_DeadlinePassed(uint32_t Deadline);
+void I2C_BusRecovery(I2C_MODULE_ID Id);
+uint32_t I2C_BusRecoveryCount(void);
+
+#endif
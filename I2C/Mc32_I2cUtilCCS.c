@@ -6,19 +6,24 @@
 //
 //	Auteur 		: 	C. HUBER
 //
-//	Version		:	V1.2
+//	Version		:	V1.3
 //	Compilateur	:	XC32 V1.40 & Harmony V1.06
 // Modifications :
 //      CHR 19.03.2015  Migration sur plib_i2c de Harmony 1.00   CHR
 //      CHR 12.04.2016  adaptaion dtails pour plib_i2c de Harmony 1.06   CHR
 //		SCA 04.04.2017  Complments commentaires i2c_init HighFrequencyEnable/Disable
+//          17.10.2026  attentes bornes (i2c_xxx_timeout), rcupration du bus,
+//                      correction du test de collision (';' en trop)
+//          17.10.2026  module choisi par i2c_select (I2C1  I2C5),
+//                      plus de lecture directe de I2C2CON / I2C2BRG
 //
 /*--------------------------------------------------------*/
 
 #include "app.h"
 #include "Mc32_I2cUtilCCS.h"
-#include "peripheral\i2c\plib_i2c.h"
-#include "peripheral\osc\plib_osc.h"
+#include "Mc32_I2cTimeout.h"
+#include "peripheral/i2c/plib_i2c.h"
+#include "peripheral/osc/plib_osc.h"
 
 
 
@@ -27,6 +32,25 @@
 #define I2C_CLOCK_FAST 400000
 #define I2C_CLOCK_SLOW 100000
 
+// Module utilis par les fonctions i2c_xxx
+static I2C_MODULE_ID i2cBus = KIT_I2C_BUS;
+
+// Attente d'une condition jusqu' l'chance, sinon rcupration
+// du bus et sortie de la fonction avec I2C_STATUS_TIMEOUT
+#define I2C_WAIT_UNTIL(Cond, Deadline)                      \
+    while (!(Cond)) {                                       \
+        if (I2C_DeadlinePassed(Deadline)) {                 \
+            return i2c_fail(I2C_STATUS_TIMEOUT);            \
+        }                                                   \
+    }
+
+// Libre le bus et rend l'erreur
+static E_I2C_STATUS i2c_fail(E_I2C_STATUS Status)
+{
+    I2C_BusRecovery(i2cBus);
+    return Status;
+}
+
 //------------------------------------------------------------------------------
 // i2c_init
 //
@@ -38,11 +62,22 @@
 // CHR 12.04.2016 reprise principe init du driver I2C de Harmony 1.06
 // = pas OK reprise ancien principe            
 
-uint32_t I2cConReg, I2cBrg;     // pour controle de la configuration
+//------------------------------------------------------------------------------
+// i2c_select
+//
+// Choix du module pour i2c_init et les fonctions suivantes (I2C_ID_1 
+// I2C_ID_5), KIT_I2C_BUS par dfaut. Equivalent du stream CCS : appeler
+// avant chaque squence si plusieurs bus sont utiliss.
+//------------------------------------------------------------------------------
+
+void i2c_select(I2C_MODULE_ID I2cId)
+{
+    i2cBus = I2cId;
+}
 
 void i2c_init( bool Fast )
 {
-    PLIB_I2C_Disable(KIT_I2C_BUS);      // Ajout CHR
+    PLIB_I2C_Disable(i2cBus);      // Ajout CHR
     
 	// LOW frequency is enabled (**NOTE** PLIB function logic reverted)
 	// A 100k et 400kHz, on devrait activer le "slope control" 
@@ -50,24 +85,21 @@ void i2c_init( bool Fast )
 	// d'incompatibilit avec les flancs trop lents => dsactiv
 	// Voir application note 
 	// "AN-2113 Applying I2C Compatible Temperature Sensors in Systems with Slow Clock Edges"
-    PLIB_I2C_HighFrequencyEnable(KIT_I2C_BUS);
+    PLIB_I2C_HighFrequencyEnable(i2cBus);
     if (Fast)  {
-       PLIB_I2C_BaudRateSet(KIT_I2C_BUS,
+       PLIB_I2C_BaudRateSet(i2cBus,
                SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1), I2C_CLOCK_FAST);
     } else {
-        PLIB_I2C_BaudRateSet(KIT_I2C_BUS,
+        PLIB_I2C_BaudRateSet(i2cBus,
                SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1), I2C_CLOCK_SLOW);
     }
 	
 	// selon driver. Voir commentaire PLIB_I2C_HighFrequencyEnable ci-dessus
-    // PLIB_I2C_HighFrequencyDisable(KIT_I2C_BUS);   
+    // PLIB_I2C_HighFrequencyDisable(i2cBus);   
     
-    PLIB_I2C_SlaveClockStretchingEnable(KIT_I2C_BUS);  // ajout CHR
+    PLIB_I2C_SlaveClockStretchingEnable(i2cBus);  // ajout CHR
     
-    PLIB_I2C_Enable(KIT_I2C_BUS);
-
-    I2cConReg = I2C2CON;
-    I2cBrg = I2C2BRG;
+    PLIB_I2C_Enable(i2cBus);
 }
 
 
@@ -77,74 +109,83 @@ void i2c_init( bool Fast )
 // Dbut la transaction I2C master
 //
 // Adaptation plib_i2c  : 19.03.2015 CHR
+// 17.10.2026 : attentes bornes  TimeoutUs
 
-void i2c_start(void)
+E_I2C_STATUS i2c_start_timeout(uint32_t TimeoutUs)
 {
-    // int DebugCode = 0;
+    uint32_t Deadline = I2C_DeadlineSet(TimeoutUs);
 
     // Wait for the bus to be idle, then start the transfer
-    while(PLIB_I2C_BusIsIdle(KIT_I2C_BUS) == false);
+    I2C_WAIT_UNTIL(PLIB_I2C_BusIsIdle(i2cBus), Deadline);
 
      /* Check for recieve overflow */
-    if ( PLIB_I2C_ReceiverOverflowHasOccurred(KIT_I2C_BUS))
+    if ( PLIB_I2C_ReceiverOverflowHasOccurred(i2cBus))
     {
-        PLIB_I2C_ReceiverOverflowClear(KIT_I2C_BUS);
+        PLIB_I2C_ReceiverOverflowClear(i2cBus);
     }
 
     /* Check for transmit overflow */
-    if (PLIB_I2C_TransmitterOverflowHasOccurred(KIT_I2C_BUS))
+    if (PLIB_I2C_TransmitterOverflowHasOccurred(i2cBus))
     {
-        PLIB_I2C_TransmitterOverflowClear(KIT_I2C_BUS);
+        PLIB_I2C_TransmitterOverflowClear(i2cBus);
     }
 
-    PLIB_I2C_MasterStart(KIT_I2C_BUS);
+    PLIB_I2C_MasterStart(i2cBus);
 
-    if (PLIB_I2C_ArbitrationLossHasOccurred(KIT_I2C_BUS));
+    if (PLIB_I2C_ArbitrationLossHasOccurred(i2cBus))
     {
-        // DBPRINTF("Error: Bus collision during transfer Start\n");
-        // DebugCode = 1;
-        // Handel bus collision
-        PLIB_I2C_ArbitrationLossClear(KIT_I2C_BUS);
+        // Bus collision during transfer Start (SDA maintenue  0 ?)
+        PLIB_I2C_ArbitrationLossClear(i2cBus);
+        return i2c_fail(I2C_STATUS_COLLISION);
     }
    
     // Wait for the signal to complete
-    while (PLIB_I2C_StartWasDetected(KIT_I2C_BUS) == false);
-   
- } // end i2c_start
+    I2C_WAIT_UNTIL(PLIB_I2C_StartWasDetected(i2cBus), Deadline);
+    return I2C_STATUS_OK;
+ } // end i2c_start_timeout
 
-void i2c_reStart(void)
+void i2c_start(void)
+{
+    i2c_start_timeout(I2C_TIMEOUT_US);
+}
+
+E_I2C_STATUS i2c_reStart_timeout(uint32_t TimeoutUs)
 {
-   // int DebugCode = 0;
+   uint32_t Deadline = I2C_DeadlineSet(TimeoutUs);
   
    // Pas d'attente bus en Idle
 
    /* Check for recieve overflow */
-   if ( PLIB_I2C_ReceiverOverflowHasOccurred(KIT_I2C_BUS))
+   if ( PLIB_I2C_ReceiverOverflowHasOccurred(i2cBus))
    {
-       PLIB_I2C_ReceiverOverflowClear(KIT_I2C_BUS);
+       PLIB_I2C_ReceiverOverflowClear(i2cBus);
    }
 
    /* Check for transmit overflow */
-   if (PLIB_I2C_TransmitterOverflowHasOccurred(KIT_I2C_BUS))
+   if (PLIB_I2C_TransmitterOverflowHasOccurred(i2cBus))
    {
-        PLIB_I2C_TransmitterOverflowClear(KIT_I2C_BUS);
+        PLIB_I2C_TransmitterOverflowClear(i2cBus);
    }
 
-   // PLIB_I2C_StartClear(KIT_I2C_BUS);
-   PLIB_I2C_MasterStartRepeat(KIT_I2C_BUS);
+   // PLIB_I2C_StartClear(i2cBus);
+   PLIB_I2C_MasterStartRepeat(i2cBus);
    
-   if (PLIB_I2C_ArbitrationLossHasOccurred(KIT_I2C_BUS));
+   if (PLIB_I2C_ArbitrationLossHasOccurred(i2cBus))
     {
-        // DBPRINTF("Error: Bus collision during transfer Start\n");
-        // DebugCode = 1;
-        // Handel bus collision
-        PLIB_I2C_ArbitrationLossClear(KIT_I2C_BUS);
+        // Bus collision during transfer Start
+        PLIB_I2C_ArbitrationLossClear(i2cBus);
+        return i2c_fail(I2C_STATUS_COLLISION);
     }
     
    // Wait for the signal to complete
-   while (PLIB_I2C_StartWasDetected(KIT_I2C_BUS) == false);
-  
-} // end i2c_reStart
+   I2C_WAIT_UNTIL(PLIB_I2C_StartWasDetected(i2cBus), Deadline);
+   return I2C_STATUS_OK;
+} // end i2c_reStart_timeout
+
+void i2c_reStart(void)
+{
+    i2c_reStart_timeout(I2C_TIMEOUT_US);
+}
 
 
 //------------------------------------------------------------------------------
@@ -160,26 +201,37 @@ void i2c_reStart(void)
 // Modification de  BOOL TransmitOneByte( UINT8 data )
 // - Ajout retour du bit Ack
 // Adaptation plib_i2c  : 19.03.2015 CHR
+// 17.10.2026 : i2c_write_timeout fournit le ack par rfrence
 
-bool i2c_write( uint8_t data )
+E_I2C_STATUS i2c_write_timeout( uint8_t data, bool *pAck, uint32_t TimeoutUs )
 {
-    bool  AckBit;
-  
+    uint32_t Deadline = I2C_DeadlineSet(TimeoutUs);
+
+    *pAck = false;
+
     // Wait for the bus to be idle (ncessaire aprs un reStart)
-    while(PLIB_I2C_BusIsIdle(KIT_I2C_BUS) == false);
+    I2C_WAIT_UNTIL(PLIB_I2C_BusIsIdle(i2cBus), Deadline);
 
     // Wait for the transmitter to be ready
-    while( PLIB_I2C_TransmitterIsReady(KIT_I2C_BUS) == false);
+    I2C_WAIT_UNTIL(PLIB_I2C_TransmitterIsReady(i2cBus), Deadline);
 
     
     // Transmit the byte
-    PLIB_I2C_TransmitterByteSend(KIT_I2C_BUS, data);
+    PLIB_I2C_TransmitterByteSend(i2cBus, data);
     
-    while(PLIB_I2C_TransmitterIsBusy(KIT_I2C_BUS));              //Wait as long as TBF = 1
-    while(!PLIB_I2C_TransmitterByteHasCompleted(KIT_I2C_BUS));   //Wait as long as TRSTAT == 1
+    I2C_WAIT_UNTIL(!PLIB_I2C_TransmitterIsBusy(i2cBus), Deadline);           //Wait as long as TBF = 1
+    I2C_WAIT_UNTIL(PLIB_I2C_TransmitterByteHasCompleted(i2cBus), Deadline);  //Wait as long as TRSTAT == 1
   
-    AckBit = PLIB_I2C_TransmitterByteWasAcknowledged(KIT_I2C_BUS);
+    *pAck = PLIB_I2C_TransmitterByteWasAcknowledged(i2cBus);
    
+    return I2C_STATUS_OK;
+} // end i2c_write_timeout
+
+bool i2c_write( uint8_t data )
+{
+    bool  AckBit;
+
+    i2c_write_timeout(data, &AckBit, I2C_TIMEOUT_US);
     return AckBit;
 } // end i2c_write
 
@@ -197,17 +249,24 @@ bool i2c_write( uint8_t data )
 // Adaptation plib_i2c  : 19.03.2015 CHR
 
 
-void i2c_stop( void )
+E_I2C_STATUS i2c_stop_timeout( uint32_t TimeoutUs )
 {
+    uint32_t Deadline = I2C_DeadlineSet(TimeoutUs);
+
     // Attente bus au repos
-    while(PLIB_I2C_BusIsIdle(KIT_I2C_BUS) == false);
+    I2C_WAIT_UNTIL(PLIB_I2C_BusIsIdle(i2cBus), Deadline);
 
-    PLIB_I2C_MasterStop(KIT_I2C_BUS);
+    PLIB_I2C_MasterStop(i2cBus);
 
     // Wait for the signal to complete
-    while (PLIB_I2C_StopWasDetected(KIT_I2C_BUS) == false);
-   
-} // end i2c_stop
+    I2C_WAIT_UNTIL(PLIB_I2C_StopWasDetected(i2cBus), Deadline);
+    return I2C_STATUS_OK;
+} // end i2c_stop_timeout
+
+void i2c_stop( void )
+{
+    i2c_stop_timeout(I2C_TIMEOUT_US);
+}
 
 //------------------------------------------------------------------------------
 // i2c_read()
@@ -219,45 +278,54 @@ void i2c_stop( void )
 // 0 (false) signifie qu'il ne faut pas effectuer l'acquittement.
 //
 // Adaptation plib_i2c  : 19.03.2015 CHR
+// 17.10.2026 : i2c_read_timeout fournit l'octet par rfrence (0xFF si erreur)
 
-uint8_t i2c_read(bool ackTodo)
+E_I2C_STATUS i2c_read_timeout(bool ackTodo, uint8_t *pData, uint32_t TimeoutUs)
 {
-    uint8_t i2cByte;
+    uint32_t Deadline = I2C_DeadlineSet(TimeoutUs);
+
+    *pData = 0xFF;
 
     // BSP_LEDOn(BSP_LED_5);  // provisoire : pour observation
    
     // ajout idem driver statique I2C de Harmony 1_03
-    if ( PLIB_I2C_ReceiverOverflowHasOccurred(KIT_I2C_BUS))
+    if ( PLIB_I2C_ReceiverOverflowHasOccurred(i2cBus))
     {
-        i2cByte = PLIB_I2C_ReceivedByteGet(KIT_I2C_BUS);
-        PLIB_I2C_ReceiverOverflowClear(KIT_I2C_BUS);
+        PLIB_I2C_ReceivedByteGet(i2cBus);
+        PLIB_I2C_ReceiverOverflowClear(i2cBus);
     }
     
     // en relation avec stetching
-    PLIB_I2C_SlaveClockRelease(KIT_I2C_BUS);
+    PLIB_I2C_SlaveClockRelease(i2cBus);
 
     // Set Rx enable in MSTR which causes SLAVE to send data
-    PLIB_I2C_MasterReceiverClock1Byte(KIT_I2C_BUS);
+    PLIB_I2C_MasterReceiverClock1Byte(i2cBus);
 
     // Wait till RBF = 1; Which means data is available in I2C2RCV reg
-    while(!PLIB_I2C_ReceivedByteIsAvailable(KIT_I2C_BUS));
+    I2C_WAIT_UNTIL(PLIB_I2C_ReceivedByteIsAvailable(i2cBus), Deadline);
     
-    i2cByte = PLIB_I2C_ReceivedByteGet(KIT_I2C_BUS); //Read from I2CxRCV
+    *pData = PLIB_I2C_ReceivedByteGet(i2cBus); //Read from I2CxRCV
 
-    while ( PLIB_I2C_MasterReceiverReadyToAcknowledge ( KIT_I2C_BUS ) == false );
+    I2C_WAIT_UNTIL(PLIB_I2C_MasterReceiverReadyToAcknowledge(i2cBus), Deadline);
 
      if (ackTodo) {
-          PLIB_I2C_ReceivedByteAcknowledge ( KIT_I2C_BUS, true );
+          PLIB_I2C_ReceivedByteAcknowledge ( i2cBus, true );
      } else {
-          PLIB_I2C_ReceivedByteAcknowledge ( KIT_I2C_BUS, false );
+          PLIB_I2C_ReceivedByteAcknowledge ( i2cBus, false );
      }
 
     // wait till ACK/NACK sequence is complete i.e ACKEN = 0
-    while( PLIB_I2C_MasterReceiverReadyToAcknowledge (KIT_I2C_BUS) == false);
+    I2C_WAIT_UNTIL(PLIB_I2C_MasterReceiverReadyToAcknowledge(i2cBus), Deadline);
    
     // BSP_LEDOff(BSP_LED_5); // provisoire : pour observation
 
-    return i2cByte;
-} // end i2c_read
+    return I2C_STATUS_OK;
+} // end i2c_read_timeout
 
+uint8_t i2c_read(bool ackTodo)
+{
+    uint8_t i2cByte;
 
+    i2c_read_timeout(ackTodo, &i2cByte, I2C_TIMEOUT_US);
+    return i2cByte;
+} // end i2c_read
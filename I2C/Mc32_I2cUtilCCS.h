@@ -9,14 +9,18 @@
 //
 //	Auteur 		: 	C. HUBER
 //      Date            :       22.05.2014
-//	Version		:	V1.5
+//	Version		:	V1.6
 //	Compilateur	:	XC32 V1.33 & Harmony V1.00
 // Modifications :
 //      CHR 19.03.2015  Migration sur plib_i2c de Harmony 1.00   CHR
+//          17.10.2026  variantes i2c_xxx_timeout, les fonctions d'origine
+//                      sont bornes  I2C_TIMEOUT_US par primitive
+//          17.10.2026  i2c_select, choix du module (I2C2 par dfaut)
 /*--------------------------------------------------------*/
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "Mc32_I2cTimeout.h"
 
 
 //------------------------------------------------------------------------------
@@ -27,6 +31,7 @@
 //   si bool Fast = true    HIGH speed
 //------------------------------------------------------------------------------
 
+void i2c_select(I2C_MODULE_ID I2cId);
 void i2c_init( bool Fast );
 void i2c_start(void);
 void i2c_reStart(void);
@@ -47,4 +52,18 @@ bool i2c_write( uint8_t data );
 uint8_t i2c_read(bool ackTodo);
 
 void i2c_stop( void );
+
+//------------------------------------------------------------------------------
+// Variantes avec dlai limite
+//
+// Retournent I2C_STATUS_TIMEOUT (ou COLLISION) si l'chance est dpasse,
+// le bus est alors rcupr (9 coups de SCL + stop) et la transaction
+// en cours est perdue : recommencer depuis le start.
+//------------------------------------------------------------------------------
+
+E_I2C_STATUS i2c_start_timeout(uint32_t TimeoutUs);
+E_I2C_STATUS i2c_reStart_timeout(uint32_t TimeoutUs);
+E_I2C_STATUS i2c_write_timeout( uint8_t data, bool *pAck, uint32_t TimeoutUs );
+E_I2C_STATUS i2c_read_timeout(bool ackTodo, uint8_t *pData, uint32_t TimeoutUs);
+E_I2C_STATUS i2c_stop_timeout( uint32_t TimeoutUs );
 #endif
@@ -15,6 +15,10 @@
 //          CHR 24.04.2015 refonte en utilisant le driver I2C fourni par le MHC
 //          CHR 10.05.2016 ajout include du driver i2c
 //          SCA 11.04.2017 adaptation Harmony 1.08
+//              17.10.2026 ajout I2C_SM_Transfer / I2C_SM_TransferExecute
+//              17.10.2026 ajout interprteur I2C_SM_ProgExecute
+//              17.10.2026 micro-tapes bornes  I2C_SM_TIMEOUT_US, tat
+//                         I2C_XSM_Error et rcupration du bus
 //
 //      ATTENTION :
 //          Le no du module I2C est connu du driver I2C seulement
@@ -24,7 +28,10 @@
 
 
 
+#include <stddef.h>
+#include <xc.h>                 // pour _CP0_GET_COUNT()
 #include "Mc32_I2cUtil_SM.h"
+#include "Mc32_I2cTimeout.h"
 #include "system_config/default/framework/driver/i2c/drv_i2c_static.h"
 // #include "system_config.h"    // pour bsp
 // #include "system_definitions.h"  // pour action sauvage
@@ -33,6 +40,20 @@
 #define I2C_CLOCK_FAST 400000
 #define I2C_CLOCK_SLOW 100000
 
+// Etapes de I2C_SM_TransferExecute
+typedef enum { I2C_XFER_Start,
+               I2C_XFER_AddrW,
+               I2C_XFER_Write,
+               I2C_XFER_ReStart,
+               I2C_XFER_AddrR,
+               I2C_XFER_Read,
+               I2C_XFER_Stop,
+               I2C_XFER_End,
+                                } E_I2C_XFER_STEP;
+
+// Pc de l'interprteur pendant le stop d'abandon
+#define I2C_PROG_ABORT  0xFF
+
 //------------------------------------------------------------------------------
 // I2C_SM_init
 //
@@ -62,6 +83,24 @@ void I2C_SM_begin( S_Descr_I2C_SM *pDSM )
     pDSM->DebugCode = 0;
 }
 
+bool I2C_SM_isError( S_Descr_I2C_SM *pDSM )
+{
+    return (pDSM->I2cMainSM == I2C_XSM_Error);
+}
+
+// Dlai de la micro-tape dpass : rcupration du bus, tat Error
+static bool I2C_SM_expired( S_Descr_I2C_SM *pDSM )
+{
+    if (I2C_DeadlinePassed(pDSM->Deadline)) {
+        I2C_BusRecovery(KIT_I2C_BUS);
+        pDSM->I2cSeqSM = 0;
+        pDSM->I2cMainSM = I2C_XSM_Error;
+        pDSM->DebugCode = 5;
+        return true;
+    }
+    return false;
+}
+
 bool I2C_SM_isReady( S_Descr_I2C_SM *pDSM )
 {
     bool answer = false;
@@ -85,9 +124,13 @@ void I2C_SM_start(S_Descr_I2C_SM *pDSM)
             // demarre le traitement
             pDSM->I2cMainSM = I2C_XSM_Busy;
             pDSM->I2cSeqSM = 0;
+            pDSM->Deadline = I2C_DeadlineSet(I2C_SM_TIMEOUT_US);
         break;
-        
+
         case I2C_XSM_Busy :
+            if (I2C_SM_expired(pDSM)) {
+                break;
+            }
             switch ( pDSM->I2cSeqSM) {
                 case 0 :
                     // Wait for the bus to be idle, then start the transfer
@@ -113,6 +156,9 @@ void I2C_SM_start(S_Descr_I2C_SM *pDSM)
         case I2C_XSM_Ready :
               // Attente relancement
         break;
+        case I2C_XSM_Error :
+              // Dlai dpass, bus rcupr : attente relancement
+        break;
     } // end switch
 } // end I2C_SM_start
 
@@ -125,9 +171,13 @@ void I2C_SM_reStart( S_Descr_I2C_SM *pDSM)
             // demarre le traitement
             pDSM->I2cMainSM = I2C_XSM_Busy;
             pDSM->I2cSeqSM = 0;
+            pDSM->Deadline = I2C_DeadlineSet(I2C_SM_TIMEOUT_US);
         break;
 
         case I2C_XSM_Busy :
+            if (I2C_SM_expired(pDSM)) {
+                break;
+            }
             switch ( pDSM->I2cSeqSM) {
                 case 0 :
                     // Restart the transfer
@@ -150,6 +200,9 @@ void I2C_SM_reStart( S_Descr_I2C_SM *pDSM)
         case I2C_XSM_Ready :
               // Attente relancement
         break;
+        case I2C_XSM_Error :
+              // Dlai dpass, bus rcupr : attente relancement
+        break;
     } // end switch
 } // end I2C_SM_reStart
 
@@ -173,9 +226,13 @@ void I2C_SM_write(S_Descr_I2C_SM *pDSM, uint8_t data, bool *pAck )
             // demarre le traitement
             pDSM->I2cMainSM = I2C_XSM_Busy;
             pDSM->I2cSeqSM = 0;
+            pDSM->Deadline = I2C_DeadlineSet(I2C_SM_TIMEOUT_US);
         break;
 
         case I2C_XSM_Busy :
+            if (I2C_SM_expired(pDSM)) {
+                break;
+            }
             switch ( pDSM->I2cSeqSM) {
                  case 0 :
                     // // Wait for the bus to be idle (ncessaire aprs un reStart)
@@ -215,6 +272,9 @@ void I2C_SM_write(S_Descr_I2C_SM *pDSM, uint8_t data, bool *pAck )
         case I2C_XSM_Ready :
               // Attente relancement
         break;
+        case I2C_XSM_Error :
+              // Dlai dpass, bus rcupr : attente relancement
+        break;
     } // end switch
   
 } // end I2C_SM__write
@@ -241,9 +301,13 @@ void I2C_SM_read(S_Descr_I2C_SM *pDSM, bool ackTodo, uint8_t *pData )
             // demarre le traitement
             pDSM->I2cMainSM = I2C_XSM_Busy;
             pDSM->I2cSeqSM = 0;
+            pDSM->Deadline = I2C_DeadlineSet(I2C_SM_TIMEOUT_US);
         break;
 
         case I2C_XSM_Busy :
+            if (I2C_SM_expired(pDSM)) {
+                break;
+            }
             switch ( pDSM->I2cSeqSM) {
                 case 0 :
                     // Check for recieve overflow If OK Initiate clock to receive
@@ -291,6 +355,9 @@ void I2C_SM_read(S_Descr_I2C_SM *pDSM, bool ackTodo, uint8_t *pData )
         case I2C_XSM_Ready :
               // Attente relancement
         break;
+        case I2C_XSM_Error :
+              // Dlai dpass, bus rcupr : attente relancement
+        break;
     } // end switch
     
 } // end I2C_SM_read
@@ -312,9 +379,13 @@ void I2C_SM_stop(S_Descr_I2C_SM *pDSM)
             // demarre le traitement
             pDSM->I2cMainSM = I2C_XSM_Busy;
             pDSM->I2cSeqSM = 0;
+            pDSM->Deadline = I2C_DeadlineSet(I2C_SM_TIMEOUT_US);
         break;
 
         case I2C_XSM_Busy :
+            if (I2C_SM_expired(pDSM)) {
+                break;
+            }
             switch ( pDSM->I2cSeqSM) {
                 case 0 :
                     // Disable receiver and stop I2C
@@ -345,6 +416,304 @@ void I2C_SM_stop(S_Descr_I2C_SM *pDSM)
         case I2C_XSM_Ready :
               // Attente relancement
         break;
+        case I2C_XSM_Error :
+              // Dlai dpass, bus rcupr : attente relancement
+        break;
     } // end switch
    
-} // end I2C_SM_stop
\ No newline at end of file
+} // end I2C_SM_stop
+
+
+//------------------------------------------------------------------------------
+// I2C_SM_Transfer
+//
+// Prpare un transfert complet : start, adresse, critures, restart,
+// adresse en lecture, lectures (nack sur le dernier octet), stop.
+// Le transfert est ensuite droul par I2C_SM_TransferExecute.
+//------------------------------------------------------------------------------
+
+void I2C_SM_Transfer( S_I2C_SM_TRANSFER *pXfer, uint8_t Address,
+                      const uint8_t *pTx, uint8_t TxLen,
+                      uint8_t *pRx, uint8_t RxLen, I2C_SM_CALLBACK Callback )
+{
+    pXfer->Address = Address;
+    pXfer->pTx = pTx;
+    pXfer->TxLen = TxLen;
+    pXfer->pRx = pRx;
+    pXfer->RxLen = RxLen;
+    pXfer->Callback = Callback;
+    pXfer->Step = I2C_XFER_Start;
+    pXfer->Index = 0;
+    pXfer->Ack = true;
+    pXfer->Result = I2C_SM_XFER_Busy;
+    I2C_SM_begin(&pXfer->I2cSmInfo);
+}
+
+bool I2C_SM_TransferIsDone( S_I2C_SM_TRANSFER *pXfer )
+{
+    return (pXfer->Result != I2C_SM_XFER_Busy);
+}
+
+// Fin de la micro-tape courante, choix de la suivante
+static void I2C_SM_TransferNext( S_I2C_SM_TRANSFER *pXfer )
+{
+    switch ( pXfer->Step ) {
+        case I2C_XFER_Start :
+            // Adresse en lecture seulement si rien  crire
+            if ((pXfer->TxLen == 0) && (pXfer->RxLen > 0)) {
+                pXfer->Step = I2C_XFER_AddrR;
+            } else {
+                pXfer->Step = I2C_XFER_AddrW;
+            }
+        break;
+
+        case I2C_XFER_AddrW :
+        case I2C_XFER_Write :
+            if (pXfer->Ack == false) {
+                pXfer->Result = I2C_SM_XFER_Nack;
+                pXfer->Step = I2C_XFER_Stop;
+            } else if (pXfer->Index < pXfer->TxLen) {
+                pXfer->Step = I2C_XFER_Write;
+            } else if (pXfer->RxLen > 0) {
+                pXfer->Step = I2C_XFER_ReStart;
+            } else {
+                pXfer->Step = I2C_XFER_Stop;
+            }
+        break;
+
+        case I2C_XFER_ReStart :
+            pXfer->Step = I2C_XFER_AddrR;
+        break;
+
+        case I2C_XFER_AddrR :
+            if (pXfer->Ack == false) {
+                pXfer->Result = I2C_SM_XFER_Nack;
+                pXfer->Step = I2C_XFER_Stop;
+            } else {
+                pXfer->Index = 0;
+                pXfer->Step = I2C_XFER_Read;
+            }
+        break;
+
+        case I2C_XFER_Read :
+            if (pXfer->Index >= pXfer->RxLen) {
+                pXfer->Step = I2C_XFER_Stop;
+            }
+        break;
+
+        case I2C_XFER_Stop :
+            pXfer->Step = I2C_XFER_End;
+        break;
+    }
+    I2C_SM_begin(&pXfer->I2cSmInfo); // redemarre la SM
+}
+
+//------------------------------------------------------------------------------
+// I2C_SM_TransferExecute  ( Pour appel cyclique )
+//
+// Enchane les micro-tapes tant qu'elles avancent, au plus
+// I2C_SM_MAX_STEPS par appel. Rend la main ds que le module
+// est occup par une action en cours sur le bus.
+//------------------------------------------------------------------------------
+
+void I2C_SM_TransferExecute( S_I2C_SM_TRANSFER *pXfer )
+{
+    E_I2C_XSM MainSM;
+    int SeqSM;
+    int Steps;
+
+    for (Steps = 0; Steps < I2C_SM_MAX_STEPS; Steps++) {
+
+        if (pXfer->Step == I2C_XFER_End) {
+            break;   // termin
+        }
+        MainSM = pXfer->I2cSmInfo.I2cMainSM;
+        SeqSM = pXfer->I2cSmInfo.I2cSeqSM;
+
+        switch ( pXfer->Step ) {
+            case I2C_XFER_Start :
+                I2C_SM_start(&pXfer->I2cSmInfo);
+            break;
+            case I2C_XFER_AddrW :
+                I2C_SM_write(&pXfer->I2cSmInfo, pXfer->Address & 0xFE, &pXfer->Ack);
+            break;
+            case I2C_XFER_Write :
+                I2C_SM_write(&pXfer->I2cSmInfo, pXfer->pTx[pXfer->Index], &pXfer->Ack);
+            break;
+            case I2C_XFER_ReStart :
+                I2C_SM_reStart(&pXfer->I2cSmInfo);
+            break;
+            case I2C_XFER_AddrR :
+                I2C_SM_write(&pXfer->I2cSmInfo, pXfer->Address | 0x01, &pXfer->Ack);
+            break;
+            case I2C_XFER_Read :
+                // ack sauf sur le dernier octet
+                I2C_SM_read(&pXfer->I2cSmInfo, (pXfer->Index + 1) < pXfer->RxLen,
+                            &pXfer->pRx[pXfer->Index]);
+            break;
+            case I2C_XFER_Stop :
+                I2C_SM_stop(&pXfer->I2cSmInfo);
+            break;
+        }
+
+        // Dlai dpass : le bus a t rcupr (stop compris)
+        if (I2C_SM_isError(&pXfer->I2cSmInfo)) {
+            pXfer->Result = I2C_SM_XFER_Timeout;
+            pXfer->Step = I2C_XFER_End;
+            if (pXfer->Callback != NULL) {
+                pXfer->Callback(pXfer->Result);
+            }
+            break;
+        }
+
+        // Start ou lecture refus par le driver : termine par un stop
+        if ((pXfer->I2cSmInfo.DebugCode != 0) && (pXfer->Step != I2C_XFER_Stop)) {
+            pXfer->Result = I2C_SM_XFER_Error;
+            pXfer->Step = I2C_XFER_Stop;
+            I2C_SM_begin(&pXfer->I2cSmInfo);
+            continue;
+        }
+
+        if (I2C_SM_isReady(&pXfer->I2cSmInfo)) {
+            if (pXfer->Step == I2C_XFER_Write || pXfer->Step == I2C_XFER_Read) {
+                pXfer->Index++;
+            }
+            I2C_SM_TransferNext(pXfer);
+            if (pXfer->Step == I2C_XFER_End) {
+                if (pXfer->Result == I2C_SM_XFER_Busy) {
+                    pXfer->Result = I2C_SM_XFER_Ok;
+                }
+                if (pXfer->Callback != NULL) {
+                    pXfer->Callback(pXfer->Result);
+                }
+                break;
+            }
+        } else if ((MainSM == pXfer->I2cSmInfo.I2cMainSM) &&
+                   (SeqSM == pXfer->I2cSmInfo.I2cSeqSM)) {
+            break;   // attente du matriel, on rend la main
+        }
+    }
+} // end I2C_SM_TransferExecute
+
+
+//------------------------------------------------------------------------------
+// I2C_SM_ProgStart
+//
+// Prpare l'excution d'une squence (table termine par I2C_OP_END)
+//------------------------------------------------------------------------------
+
+void I2C_SM_ProgStart( S_I2C_SM_PROG *pProg, const S_I2C_OP *pSeq, uint8_t *pSlots )
+{
+    pProg->pSeq = pSeq;
+    pProg->pSlots = pSlots;
+    pProg->Pc = 0;
+    pProg->Ack = true;
+    pProg->Status = I2C_SM_XFER_Ok;
+    pProg->Result = I2C_SM_XFER_Busy;
+    I2C_SM_begin(&pProg->I2cSmInfo);
+}
+
+bool I2C_SM_ProgIsDone( S_I2C_SM_PROG *pProg )
+{
+    return (pProg->Result != I2C_SM_XFER_Busy);
+}
+
+//------------------------------------------------------------------------------
+// I2C_SM_ProgExecute  ( Pour appel cyclique )
+//
+// Excute les oprations de la squence tant qu'elles avancent, au plus
+// I2C_SM_MAX_STEPS micro-tapes par appel. Le DELAY rend la main
+// jusqu' l'chance (core timer).
+//------------------------------------------------------------------------------
+
+void I2C_SM_ProgExecute( S_I2C_SM_PROG *pProg )
+{
+    E_I2C_XSM MainSM;
+    int SeqSM;
+    int Steps;
+    uint8_t Op;
+    uint8_t Arg;
+    uint32_t TicksPerMs = SYS_CLK_SystemFrequencyGet() / 2000;
+
+    for (Steps = 0; Steps < I2C_SM_MAX_STEPS; Steps++) {
+
+        if (pProg->Result != I2C_SM_XFER_Busy) {
+            break;   // termin
+        }
+        if (pProg->Pc == I2C_PROG_ABORT) {
+            Op = I2C_OPC_Stop;
+            Arg = 0;
+        } else {
+            Op = pProg->pSeq[pProg->Pc].Op;
+            Arg = pProg->pSeq[pProg->Pc].Arg;
+        }
+        MainSM = pProg->I2cSmInfo.I2cMainSM;
+        SeqSM = pProg->I2cSmInfo.I2cSeqSM;
+
+        switch ( Op ) {
+            case I2C_OPC_Start :
+                I2C_SM_start(&pProg->I2cSmInfo);
+            break;
+            case I2C_OPC_ReStart :
+                I2C_SM_reStart(&pProg->I2cSmInfo);
+            break;
+            case I2C_OPC_Stop :
+                I2C_SM_stop(&pProg->I2cSmInfo);
+            break;
+            case I2C_OPC_Write :
+                I2C_SM_write(&pProg->I2cSmInfo, Arg, &pProg->Ack);
+            break;
+            case I2C_OPC_ReadAck :
+                I2C_SM_read(&pProg->I2cSmInfo, true, &pProg->pSlots[Arg]);
+            break;
+            case I2C_OPC_ReadNack :
+                I2C_SM_read(&pProg->I2cSmInfo, false, &pProg->pSlots[Arg]);
+            break;
+            case I2C_OPC_Delay :
+                // Mme principe Idle / Busy / Ready que les micro-tapes
+                if (pProg->I2cSmInfo.I2cMainSM == I2C_XSM_Idle) {
+                    pProg->DelayStart = _CP0_GET_COUNT();
+                    pProg->I2cSmInfo.I2cMainSM = I2C_XSM_Busy;
+                } else if ((_CP0_GET_COUNT() - pProg->DelayStart) >= (Arg * TicksPerMs)) {
+                    pProg->I2cSmInfo.I2cMainSM = I2C_XSM_Ready;
+                }
+            break;
+            default :
+                // I2C_OPC_End ou code inconnu
+                pProg->Result = pProg->Status;
+            break;
+        }
+        if (pProg->Result != I2C_SM_XFER_Busy) {
+            break;
+        }
+
+        // Dlai dpass : le bus a t rcupr (stop compris)
+        if (I2C_SM_isError(&pProg->I2cSmInfo)) {
+            pProg->Result = I2C_SM_XFER_Timeout;
+            break;
+        }
+
+        // Start ou lecture refus par le driver : termine par un stop
+        if ((pProg->I2cSmInfo.DebugCode != 0) && (Op != I2C_OPC_Stop)) {
+            pProg->Status = I2C_SM_XFER_Error;
+            pProg->Pc = I2C_PROG_ABORT;
+            I2C_SM_begin(&pProg->I2cSmInfo);
+            continue;
+        }
+
+        if (I2C_SM_isReady(&pProg->I2cSmInfo)) {
+            I2C_SM_begin(&pProg->I2cSmInfo); // redemare la SM
+            if (pProg->Pc == I2C_PROG_ABORT) {
+                pProg->Result = pProg->Status;
+            } else if ((Op == I2C_OPC_Write) && (pProg->Ack == false)) {
+                pProg->Status = I2C_SM_XFER_Nack;
+                pProg->Pc = I2C_PROG_ABORT;
+            } else {
+                pProg->Pc++;
+            }
+        } else if ((MainSM == pProg->I2cSmInfo.I2cMainSM) &&
+                   (SeqSM == pProg->I2cSmInfo.I2cSeqSM)) {
+            break;   // attente du matriel, on rend la main
+        }
+    }
+} // end I2C_SM_ProgExecute
@@ -17,23 +17,38 @@
 //                       suppression du I2C module ID dans les paramres
 //      CHR   10.05.2016 mise  jour version compilateur et Harmony
 //      (SCA 11.04.2017 adaptation Harmony 1.08 (pas de modif de ce fichier))
+//            17.10.2026 ajout transfert complet I2C_SM_Transfer
+//            17.10.2026 ajout interprteur de squences I2C_SM_Prog
+//            17.10.2026 micro-tapes bornes (tat I2C_XSM_Error)
+//
+// Transfert complet (critures, restart, lectures) :
+//      S_I2C_SM_TRANSFER Xfer;   // descripteur
+//      I2C_SM_Transfer(&Xfer, 0x90, TxBuf, 1, RxBuf, 2, NULL);
+//      puis appel cyclique de I2C_SM_TransferExecute(&Xfer)
+//      jusqu' I2C_SM_TransferIsDone(&Xfer), rsultat dans Xfer.Result
 /*--------------------------------------------------------*/
 
 #include <stdbool.h>
 #include <stdint.h>
 
 // KIT 32MX795F512L Constants
-#define KIT_I2C_BUS   I2C_ID_2    // n'est plus utilise
+#define KIT_I2C_BUS   I2C_ID_2    // pour la rcupration du bus seulement
+
+// Dure maximum d'une micro-tape (start, octet, stop). Au-del le bus
+// est rcupr (9 coups de SCL + stop) et la micro-tape passe en Error
+#define I2C_SM_TIMEOUT_US   2000
 
-typedef enum { I2C_XSM_Idle, I2C_XSM_Busy, I2C_XSM_Ready} E_I2C_XSM;
+typedef enum { I2C_XSM_Idle, I2C_XSM_Busy, I2C_XSM_Ready, I2C_XSM_Error} E_I2C_XSM;
 
 typedef struct {
    E_I2C_XSM I2cMainSM;
    int I2cSeqSM;
    int DebugCode;
+   uint32_t Deadline;           // chance de la micro-tape (core timer)
 } S_Descr_I2C_SM;
 
 bool I2C_SM_isReady( S_Descr_I2C_SM *pDSM );
+bool I2C_SM_isError( S_Descr_I2C_SM *pDSM );
 void I2C_SM_begin( S_Descr_I2C_SM *pDSM );
 
 void I2C_SM_init(  bool Fast, S_Descr_I2C_SM *pDSM );
@@ -43,4 +58,91 @@ void I2C_SM_write( S_Descr_I2C_SM *pDSM, uint8_t data, bool *pAck );
 void I2C_SM_read( S_Descr_I2C_SM *pDSM, bool ackTodo, uint8_t *pData );
 void I2C_SM_stop(S_Descr_I2C_SM *pDSM);
 
+// Transfert complet par micro-tapes
+// ----------------------------------
+
+// Nombre maximum de micro-tapes enchanes par appel
+#define I2C_SM_MAX_STEPS   8
+
+typedef enum { I2C_SM_XFER_Idle,
+               I2C_SM_XFER_Busy,
+               I2C_SM_XFER_Ok,
+               I2C_SM_XFER_Nack,         // adresse ou octet non acquitt
+               I2C_SM_XFER_Error,        // start ou lecture refus par le driver
+               I2C_SM_XFER_Timeout,      // dlai dpass, bus rcupr
+                                } E_I2C_SM_XFER;
+
+// Appel  la fin du transfert, depuis I2C_SM_TransferExecute
+typedef void (*I2C_SM_CALLBACK)(E_I2C_SM_XFER Result);
+
+typedef struct {
+   S_Descr_I2C_SM I2cSmInfo;     // micro-tape en cours
+   uint8_t Address;              // adresse 8 bits en criture (ex. 0x90)
+   const uint8_t *pTx;           // TxLen = 0 : lecture seule
+   uint8_t TxLen;
+   uint8_t *pRx;                 // RxLen = 0 : criture seule
+   uint8_t RxLen;
+   I2C_SM_CALLBACK Callback;     // NULL si pas utilis
+   uint8_t Step;                 // tape du transfert
+   uint8_t Index;                // octet courant
+   bool Ack;
+   E_I2C_SM_XFER Result;
+} S_I2C_SM_TRANSFER;
+
+void I2C_SM_Transfer( S_I2C_SM_TRANSFER *pXfer, uint8_t Address,
+                      const uint8_t *pTx, uint8_t TxLen,
+                      uint8_t *pRx, uint8_t RxLen, I2C_SM_CALLBACK Callback );
+void I2C_SM_TransferExecute( S_I2C_SM_TRANSFER *pXfer );
+bool I2C_SM_TransferIsDone( S_I2C_SM_TRANSFER *pXfer );
+
+// Interprteur de squences
+// -------------------------
+// Une squence est une table constante (en flash) d'oprations :
+//      static const S_I2C_OP Seq[] = {
+//          I2C_OP_START, I2C_OP_WRITE(0x90), I2C_OP_WRITE(0x00),
+//          I2C_OP_RESTART, I2C_OP_WRITE(0x91),
+//          I2C_OP_READ_ACK(0), I2C_OP_READ_NACK(1),
+//          I2C_OP_STOP, I2C_OP_END };
+// Les lectures sont ranges dans pSlots[n]. Un octet non acquitt
+// ou une erreur du driver termine la squence par un stop.
+
+typedef enum { I2C_OPC_End,
+               I2C_OPC_Start,
+               I2C_OPC_ReStart,
+               I2C_OPC_Stop,
+               I2C_OPC_Write,            // Arg = octet  crire
+               I2C_OPC_ReadAck,          // Arg = no du slot
+               I2C_OPC_ReadNack,         // Arg = no du slot
+               I2C_OPC_Delay,            // Arg = dure en ms
+                                } E_I2C_OPCODE;
+
+typedef struct {
+   uint8_t Op;
+   uint8_t Arg;
+} S_I2C_OP;
+
+#define I2C_OP_START            { I2C_OPC_Start, 0 }
+#define I2C_OP_RESTART          { I2C_OPC_ReStart, 0 }
+#define I2C_OP_STOP             { I2C_OPC_Stop, 0 }
+#define I2C_OP_WRITE(b)         { I2C_OPC_Write, (b) }
+#define I2C_OP_READ_ACK(slot)   { I2C_OPC_ReadAck, (slot) }
+#define I2C_OP_READ_NACK(slot)  { I2C_OPC_ReadNack, (slot) }
+#define I2C_OP_DELAY(ms)        { I2C_OPC_Delay, (ms) }
+#define I2C_OP_END              { I2C_OPC_End, 0 }
+
+typedef struct {
+   S_Descr_I2C_SM I2cSmInfo;     // micro-tape en cours
+   const S_I2C_OP *pSeq;         // squence
+   uint8_t *pSlots;              // octets lus
+   uint8_t Pc;                   // opration courante
+   bool Ack;
+   uint32_t DelayStart;          // core timer au dbut d'un DELAY
+   E_I2C_SM_XFER Status;         // rsultat rendu  la fin
+   E_I2C_SM_XFER Result;
+} S_I2C_SM_PROG;
+
+void I2C_SM_ProgStart( S_I2C_SM_PROG *pProg, const S_I2C_OP *pSeq, uint8_t *pSlots );
+void I2C_SM_ProgExecute( S_I2C_SM_PROG *pProg );
+bool I2C_SM_ProgIsDone( S_I2C_SM_PROG *pProg );
+
 #endif
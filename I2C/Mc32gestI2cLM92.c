@@ -9,6 +9,11 @@
 //	Version		:	V1.0
 //	Compilateur	:	XC32 V1.31
 // Modifications :
+//      17.10.2026 cache du pointeur : le prfixe pointeur + restart n'est
+//                 envoy que si le pointeur n'est pas sur la temprature
+//      17.10.2026 conversion entire LM92_ConvRawToMilli
+//      17.10.2026 cache I2cLm92Kit partag avec le moteur, crit seulement
+//                 si l'adresse et le pointeur sont acquitts
 //
 /*--------------------------------------------------------*/
 
@@ -23,6 +28,9 @@
 #define lm92_wr    0x90         // lm92 address for write
 #define lm92_temp_ptr  0x00     // adr. pointeur temprature
 
+// Cache du pointeur du LM92 du kit
+S_I2C_DEVICE I2cLm92Kit;
+
 // Definitions du bus (pour mesures)
 // #define I2C-SCK  SCL2/RA2      PORTAbits.RA2   pin 58
 // #define I2C-SDA  SDa2/RA3      PORTAbits.RA3   pin 59
@@ -33,24 +41,39 @@
 void I2C_InitLM92(void)  {
 
    bool Fast = true;
+   I2C_Master_DeviceInit(&I2cLm92Kit, lm92_wr);
    i2c_init(Fast );
    I2C_WriteConfigLM92();
 
  }
 
+// Mise  jour du cache aprs l'criture du pointeur temprature
+// Ack : adresse et pointeur acquitts (une erreur de dlai rend false)
+static void I2C_PtrWrittenLM92(bool Ack)
+{
+    if (Ack) {
+        I2C_Master_DevicePtrSet(&I2cLm92Kit, lm92_temp_ptr);
+    } else {
+        I2C_Master_DeviceInvalidate(&I2cLm92Kit);
+    }
+}
+
 // Confirmation du pointeur sur le registre de temprature
 // Lecture du registre de temperature du LM92
 
 void I2C_WriteConfigLM92(void)
 {
+    bool Ack;
+
     i2c_start();
-    i2c_write(lm92_wr);	// adresse + criture
-    i2c_write(lm92_temp_ptr);	// slection ptr. temp.
+    Ack = i2c_write(lm92_wr);	// adresse + criture
+    Ack = i2c_write(lm92_temp_ptr) && Ack;	// slection ptr. temp.
     i2c_reStart();
     i2c_write(lm92_rd);	// adresse + lecture
     i2c_read(1); 	// ack
     i2c_read(0);	// no ack
     i2c_stop();
+    I2C_PtrWrittenLM92(Ack);
 } // I2C_WriteConfigLM92
 
 // Lecture du registre de temperature du LM92
@@ -85,11 +108,12 @@ int16_t I2C_WriteCfgReadRawTempLM92(void)
     uint8_t msb = 1;
     uint8_t lsb = 1;
     int16_t RawTemp;
+    bool Ack;
 
     // BSP_LEDOn(BSP_LED_6);  // provisoire : pour observation
     i2c_start();
-    i2c_write(lm92_wr);	// adresse + criture
-    i2c_write(lm92_temp_ptr);	// slection ptr. temp.
+    Ack = i2c_write(lm92_wr);	// adresse + criture
+    Ack = i2c_write(lm92_temp_ptr) && Ack;	// slection ptr. temp.
 
     i2c_reStart();
     i2c_write(lm92_rd);	// adresse + lecture
@@ -97,6 +121,7 @@ int16_t I2C_WriteCfgReadRawTempLM92(void)
     lsb = i2c_read(0);	// no ack
     i2c_stop();
     // BSP_LEDOff(BSP_LED_6);  // provisoire : pour observation
+    I2C_PtrWrittenLM92(Ack);
 
     RawTemp = msb;
     RawTemp = RawTemp << 8;
@@ -105,8 +130,30 @@ int16_t I2C_WriteCfgReadRawTempLM92(void)
     return RawTemp;
 } // end I2C_WriteCfgReadRawTempLM92
 
+// Lecture du registre de temperature du LM92
+// Le pointeur n'est crit que s'il n'est pas dj sur la temprature
+// (cache I2cLm92Kit, aussi tenu  jour par le moteur et Mc32gestI2cLM92_SM)
+int16_t I2C_ReadRawTempLM92Cached(void)
+{
+    if (I2C_Master_DevicePtrIs(&I2cLm92Kit, lm92_temp_ptr)) {
+        return I2C_ReadRawTempLM92();
+    }
+    return I2C_WriteCfgReadRawTempLM92();
+} // end I2C_ReadRawTempLM92Cached
+
+// Conversion en millime de degr, calcul entier (pas de FPU)
+// Mme troncature que RawTemp * 62.5 converti en entier
+
+int32_t LM92_ConvRawToMilli( int16_t RawTemp)
+{
+    RawTemp = RawTemp / 8;
+    // bit poids faible = 0.0625 degr = 62.5 millimes
+    return ((int32_t)RawTemp * 125) / 2;
+} // end LM92_ConvRawToMilli
+
 // Passage par rfrence car problme avec return lors affectation
 // a une variable globale dans rponse  interruption
+// Utilise le float (bibliothque soft-float), prfrer LM92_ConvRawToMilli
 
 void LM92_ConvRawToDeg( int16_t RowTemp, float *pTemp)
 {
@@ -10,17 +10,33 @@
 //	Version		:	V1.2    12.04.2016
 //	Compilateur	:	XC32 V1.40 et Harmony 1.06
 //
+// Modifications :
+//      17.10.2026 cache du pointeur, I2C_ReadRawTempLM92Cached
+//      17.10.2026 conversion entire LM92_ConvRawToMilli
+//      17.10.2026 cache du pointeur I2cLm92Kit (S_I2C_DEVICE) partag avec
+//                 Mc32gestI2cLM92_SM, suppression de I2C_InvalidatePtrLM92
+//
 /*--------------------------------------------------------*/
 
 #include <stdint.h>
+#include "Mc32_I2cMaster.h"
+
+// Cache du pointeur du LM92 du kit, commun aux fonctions i2c_xxx et au
+// moteur Mc32_I2cMaster : mis  jour aprs une criture du pointeur
+// acquitte, effac par une erreur ou une rcupration du bus
+extern S_I2C_DEVICE I2cLm92Kit;
 
 // prototypes des fonctions
 void I2C_InitLM92(void);
 void I2C_WriteConfigLM92(void);
 int16_t I2C_ReadRawTempLM92(void);
 int16_t I2C_WriteCfgReadRawTempLM92(void);
+// Lecture seule si le pointeur est dj sur la temprature
+int16_t I2C_ReadRawTempLM92Cached(void);
 // Passage par rfrence car problme avec return lors affectation
 // a une variable globale dans rponse  interruption
 void LM92_ConvRawToDeg( int16_t RowTemp, float *pTemp);
+// Conversion en millime de degr sans float
+int32_t LM92_ConvRawToMilli( int16_t RawTemp);
 
 #endif
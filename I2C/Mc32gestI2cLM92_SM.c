@@ -12,28 +12,73 @@
 //      CHR 24.04.2015 : adadatation aux types de stdint.h
 //      CHR 10.05.2016 : modification version compilateur et Harmony
 //      (SCA 11.04.2017 adaptation Harmony 1.08 (pas de modif de ce fichier))
+//      17.10.2026 : option LM92_USE_I2C_MASTER, la lecture complte est une
+//                   seule transaction droule par l'ISR I2C
+//      17.10.2026 : avec LM92_USE_I2C_MASTER, le bus est partag avec le
+//                   DS2482 par la file du moteur (priorit haute). Option
+//                   en commentaire par dfaut, le __ISR I2C2 est  ajouter
+//      17.10.2026 : version micro-tapes dcrite par une table constante
+//                   excute par I2C_SM_ProgExecute
+//      17.10.2026 : conversion entire, le float n'est calcul que par
+//                   I2C_LM92_SM_GetTemp
+//      17.10.2026 : mode alarme, seuils et configuration crits une fois,
+//                   lecture seulement sur INT/T_CRIT_A ou rafrachissement
+//      17.10.2026 : cache du pointeur I2cLm92Kit partag avec
+//                   Mc32gestI2cLM92.c, mis  jour par les deux versions
 //----------------------------------------------------------
 
 
 
 
+#include <stddef.h>
 #include "Mc32gestI2cLM92_SM.h"
+#include "Mc32gestI2cLM92.h"      // cache du pointeur I2cLm92Kit
 #include "Mc32_I2cUtil_SM.h"
+#include "Mc32_I2cTimeout.h"
 #include "system_config.h"    // pour bsp
 
 // Compilation conditionelle (Mettre en commentaire pour ne pas utiliser les leds)
 #define USE_LED_MEASURE true
-// Utilisation BSP_LED 5 & 6
+// Utilisation BSP_LED 6
+
+// Compilation conditionelle : moteur I2C par interruption au lieu des
+// micro-tapes I2C_SM (partage du bus avec le DS2482 par la file)
+// Dcommenter seulement aprs avoir ajout dans l'application le __ISR
+// du vecteur I2C2 appelant I2C_Master_InterruptHandler (voir
+// Mc32_I2cMaster.h), sinon la premire transaction provoque une
+// interruption non traite
+// #define LM92_USE_I2C_MASTER
 
 // Dfinition pour LM92
 #define lm92_rd    0x91         // lm92 address for read
 #define lm92_wr    0x90         // lm92 address for write
 #define lm92_temp_ptr  0x00     // adr. pointeur temprature
+#define lm92_conf_ptr  0x01     // adr. pointeur configuration
+#define lm92_hyst_ptr  0x02     // adr. pointeur hystrse
+#define lm92_crit_ptr  0x03     // adr. pointeur T_CRIT
+#define lm92_low_ptr   0x04     // adr. pointeur T_LOW
+#define lm92_high_ptr  0x05     // adr. pointeur T_HIGH
+#define lm92_nb_alarm_reg  5    // registres crits par le mode alarme
 
 // Definitions du bus (pour mesures)
 // #define I2C-SCK  SCL2/RA2      PORTAbits.RA2   pin 58
 // #define I2C-SDA  SDa2/RA3      PORTAbits.RA3   pin 59
 
+#ifndef LM92_USE_I2C_MASTER
+// Lecture du registre temprature : pointeur, restart, Msb (ack), Lsb (nack)
+static const S_I2C_OP lm92_read_temp_seq[] = {
+    I2C_OP_START,
+    I2C_OP_WRITE(lm92_wr),          // adresse + criture
+    I2C_OP_WRITE(lm92_temp_ptr),    // slection ptr. temp.
+    I2C_OP_RESTART,
+    I2C_OP_WRITE(lm92_rd),          // adresse + lecture
+    I2C_OP_READ_ACK(0),             // msb
+    I2C_OP_READ_NACK(1),            // lsb
+    I2C_OP_STOP,
+    I2C_OP_END
+};
+#endif
+
 // Descripteur gestion LM92 par State Machine
 //S_Descr_LM92_SM DescrLm92;     // descripteur LM92
      
@@ -57,12 +102,32 @@ void I2C_LM92_SM_Init(S_Descr_LM92_SM *pDescr, bool Fast)
 
    //pDescr->i2cModuleId = ModuleId;
    pDescr->Lm92state = LM92_SM_Idle;
-   pDescr->Lm92Sequence =  LM92_I2CSEQ_Idle;
    pDescr->RawTemp = 0;
    pDescr->TempMilli = 0;
-   pDescr->Temperature = 0.0;
+   pDescr->AlarmFlags = 0;
+   pDescr->pAlarmCfg = NULL;
    
-   I2C_SM_init(  Fast, &pDescr->I2cSmInfo );
+#ifdef LM92_USE_I2C_MASTER
+   // pointeur temprature + restart + lecture 2 octets
+   // le prfixe pointeur + restart est omis par le moteur ds que
+   // le pointeur du LM92 est sur la temprature
+   I2C_Master_DeviceInit(&I2cLm92Kit, lm92_wr);
+   pDescr->Ptr = lm92_temp_ptr;
+   pDescr->I2cTrans.Address = lm92_wr;
+   pDescr->I2cTrans.pTx = &pDescr->Ptr;
+   pDescr->I2cTrans.TxLen = 1;
+   pDescr->I2cTrans.pRx = pDescr->Frame;
+   pDescr->I2cTrans.RxLen = sizeof(pDescr->Frame);
+   pDescr->I2cTrans.Callback = NULL;
+   pDescr->I2cTrans.Priority = I2C_PRIO_HIGH;   // passe avant le 1-Wire
+   pDescr->I2cTrans.pDevice = &I2cLm92Kit;
+   pDescr->I2cTrans.Speed = I2C_SPEED_DEFAULT;   // I2cLm92Kit.Speed
+   pDescr->I2cTrans.Result = I2C_MASTER_IDLE;
+
+   I2C_Master_Init(&I2cMasterKit, I2C_MASTER_KIT_ID, Fast);
+#else
+   I2C_SM_init(  Fast, &pDescr->I2cProg.I2cSmInfo );
+#endif
 }
 
 // --------------------
@@ -73,8 +138,6 @@ void I2C_LM92_SM_Init(S_Descr_LM92_SM *pDescr, bool Fast)
 
 void I2C_LM92_SM_Restart(S_Descr_LM92_SM *pDescr) {
    pDescr->Lm92state = LM92_SM_Idle;
-   pDescr->Lm92Sequence =  LM92_I2CSEQ_Idle;
- 
 }
 
 // --------------------
@@ -88,136 +151,225 @@ bool I2C_LM92_SM_IsReady(S_Descr_LM92_SM *pDescr) {
     return answer;
 }
 
-// Execution de la lecture du registre de temprature du LM92
-// Prvu pour appel cyclique
-void I2C_LM92_SM_Execute(S_Descr_LM92_SM *pDescr)
+// Calcul de la temprature  partir de Msb et Lsb
+// Calcul entier uniquement (pas de FPU, pas de soft-float)
+static void I2C_LM92_SM_Convert(S_Descr_LM92_SM *pDescr)
 {
-    //Dclaration des variables
     int16_t RawTemp;
-    bool AckBit;
 
+    RawTemp = pDescr->Msb;
+    RawTemp = RawTemp << 8;
+    RawTemp = RawTemp | pDescr->Lsb;
+    pDescr->RawTemp = RawTemp;
+    pDescr->AlarmFlags = pDescr->Lsb & 0x07;
+    RawTemp = RawTemp / 8;
+    // bit poid faible = 0.0625 degr = 62.5 millimes
+    pDescr->TempMilli = ((int32_t)RawTemp * 125) / 2;
+}
+
+#ifdef LM92_USE_I2C_MASTER
+
+// --------------------
+// I2C_LM92_SM_AlarmInit
+//
+// Passe en mode alarme : les registres sont crits par Execute (tat
+// Config), puis une premire lecture est faite. A appeler hors lecture.
+// Retourne true, le mode alarme est disponible avec le moteur.
+//
+
+bool I2C_LM92_SM_AlarmInit(S_Descr_LM92_SM *pDescr, const S_LM92_ALARM_CFG *pCfg)
+{
+    pDescr->pAlarmCfg = pCfg;
+    pDescr->AlarmStep = 0;
+    pDescr->I2cCfgTrans.Address = lm92_wr;
+    pDescr->I2cCfgTrans.pTx = pDescr->CfgTx;
+    pDescr->I2cCfgTrans.pRx = NULL;
+    pDescr->I2cCfgTrans.RxLen = 0;
+    pDescr->I2cCfgTrans.Callback = NULL;
+    pDescr->I2cCfgTrans.Priority = I2C_PRIO_HIGH;
+    // le moteur place le pointeur crit dans le cache partag
+    pDescr->I2cCfgTrans.pDevice = &I2cLm92Kit;
+    pDescr->I2cCfgTrans.Speed = I2C_SPEED_DEFAULT;
+    pDescr->I2cCfgTrans.Result = I2C_MASTER_IDLE;
+    pDescr->Lm92state = LM92_SM_Config;
+    return true;
+}
+
+// Seuil en millime de degr -> registre 16 bits (13 bits cadrs  gauche)
+static int16_t I2C_LM92_SM_MilliToReg(int32_t TempMilli)
+{
+    // 1 bit = 62.5 millimes, les 3 bits de poids faible sont  0
+    return (int16_t)(((TempMilli * 2) / 125) * 8);
+}
+
+// Prpare l'criture du registre AlarmStep dans I2cCfgTrans
+static void I2C_LM92_SM_AlarmPrepare(S_Descr_LM92_SM *pDescr)
+{
+    const S_LM92_ALARM_CFG *pCfg = pDescr->pAlarmCfg;
+    int16_t Val;
+
+    switch (pDescr->AlarmStep) {
+        case 0 :
+            pDescr->CfgTx[0] = lm92_conf_ptr;
+            pDescr->CfgTx[1] = pCfg->Config;
+            pDescr->I2cCfgTrans.TxLen = 2;
+            return;
+        case 1 :
+            pDescr->CfgTx[0] = lm92_hyst_ptr;
+            Val = I2C_LM92_SM_MilliToReg(pCfg->THystMilli);
+        break;
+        case 2 :
+            pDescr->CfgTx[0] = lm92_crit_ptr;
+            Val = I2C_LM92_SM_MilliToReg(pCfg->TCritMilli);
+        break;
+        case 3 :
+            pDescr->CfgTx[0] = lm92_low_ptr;
+            Val = I2C_LM92_SM_MilliToReg(pCfg->TLowMilli);
+        break;
+        default :
+            pDescr->CfgTx[0] = lm92_high_ptr;
+            Val = I2C_LM92_SM_MilliToReg(pCfg->THighMilli);
+        break;
+    }
+    pDescr->CfgTx[1] = (uint8_t)(Val >> 8);
+    pDescr->CfgTx[2] = (uint8_t)Val;
+    pDescr->I2cCfgTrans.TxLen = 3;
+}
+
+// En mode alarme, une lecture n'est lance que si la sortie INT/T_CRIT_A
+// est active ou si le rafrachissement de fond est chu
+static bool I2C_LM92_SM_ReadDue(S_Descr_LM92_SM *pDescr)
+{
+    const S_LM92_ALARM_CFG *pCfg = pDescr->pAlarmCfg;
+    bool Due;
+
+    if (pCfg == NULL) {
+        return true;
+    }
+    Due = I2C_DeadlinePassed(pDescr->NextRefresh);
+    if (pCfg->IntPinActive != NULL && pCfg->IntPinActive()) {
+        Due = true;
+    }
+    if (Due) {
+        pDescr->NextRefresh = I2C_DeadlineSet(pCfg->RefreshMs * 1000);
+    }
+    return Due;
+}
+
+// Execution de la lecture du registre de temprature du LM92
+// Prvu pour appel cyclique, la transaction est droule par l'ISR
+void I2C_LM92_SM_Execute(S_Descr_LM92_SM *pDescr)
+{
     switch ( pDescr->Lm92state )  {
+        case  LM92_SM_Config :
+            // Ecriture des registres, un par transaction
+            I2C_Master_Watchdog(&I2cMasterKit);
+            if (pDescr->I2cCfgTrans.Result == I2C_MASTER_PENDING) {
+                break;
+            }
+            if (pDescr->I2cCfgTrans.Result == I2C_MASTER_OK) {
+                pDescr->AlarmStep++;
+            }
+            if (pDescr->AlarmStep >= lm92_nb_alarm_reg) {
+                // Premire lecture immdiate
+                pDescr->NextRefresh = I2C_DeadlineSet(0);
+                pDescr->Lm92state = LM92_SM_Idle;
+                break;
+            }
+            // Premier registre ou nouvel essai aprs erreur
+            I2C_LM92_SM_AlarmPrepare(pDescr);
+            I2C_Master_Submit(&I2cMasterKit, &pDescr->I2cCfgTrans);
+        break;
+
         case  LM92_SM_Idle :
-            // Passe  Busy
-            pDescr->Lm92state = LM92_SM_Busy;
-            pDescr->Lm92Sequence = LM92_I2CSEQ_Start;
-            #ifdef USE_LED_MEASURE
-                BSP_LEDOn(BSP_LED_6);   // Marque dbut squence active
-            #endif
+            if (!I2C_LM92_SM_ReadDue(pDescr)) {
+                break;   // pas de trafic I2C
+            }
+            // Place la transaction dans la file du moteur
+            if (I2C_Master_Submit(&I2cMasterKit, &pDescr->I2cTrans)) {
+                pDescr->Lm92state = LM92_SM_Busy;
+                #ifdef USE_LED_MEASURE
+                    BSP_LEDOn(BSP_LED_6);   // Marque dbut squence active
+                #endif
+            }
         break;
 
         case  LM92_SM_Busy :
-            // Effectue la lecture par tapes
-            switch (pDescr->Lm92Sequence)  {
-                case LM92_I2CSEQ_Start :
-                    // i2c_start();
-                    I2C_SM_start( &pDescr->I2cSmInfo);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_WriteAddrW;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
-                break;
-               
-                case LM92_I2CSEQ_WriteAddrW :
-                    //  i2c_write(lm92_wr);	 adresse + criture
-                    I2C_SM_write( &pDescr->I2cSmInfo, lm92_wr, &AckBit);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_WritePtrTemp;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
+            // Borne l'attente si le bus est bloqu (rsultat I2C_MASTER_TIMEOUT)
+            I2C_Master_Watchdog(&I2cMasterKit);
+            switch (pDescr->I2cTrans.Result) {
+                case I2C_MASTER_PENDING :
+                    // Transaction en cours
                 break;
 
-                case LM92_I2CSEQ_WritePtrTemp :
-                    // i2c_write(lm92_temp_ptr);	slection ptr. temp.
-                    I2C_SM_write( &pDescr->I2cSmInfo, lm92_temp_ptr, &AckBit);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_ReStart;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
+                case I2C_MASTER_OK :
+                    pDescr->Msb = pDescr->Frame[0];
+                    pDescr->Lsb = pDescr->Frame[1];
+                    I2C_LM92_SM_Convert(pDescr);
+                    pDescr->Lm92state = LM92_SM_ready;
+                    #ifdef USE_LED_MEASURE
+                        BSP_LEDOff(BSP_LED_6); // marque fin squence
+                    #endif
                 break;
 
-                case LM92_I2CSEQ_ReStart :
-                    // i2c_reStart();
-                    I2C_SM_reStart( &pDescr->I2cSmInfo);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_WriteAddrR;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
-                break;
-                case LM92_I2CSEQ_WriteAddrR :
-                    //  i2c_write(lm92_rd);	 adresse + lecture
-                    I2C_SM_write( &pDescr->I2cSmInfo, lm92_rd, &AckBit);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_ReadMsb;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
-                break;
-                
-                case LM92_I2CSEQ_ReadMsb :
-                    //  msb = i2c_read(1); 	// ack
-                    I2C_SM_read( &pDescr->I2cSmInfo, true, &pDescr->Msb);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_ReadLsb;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redmarre la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
+                default :
+                    // Nack, collision ou dlai dpass : nouvelle lecture
+                    // immdiate, mme en mode alarme
+                    pDescr->NextRefresh = I2C_DeadlineSet(0);
+                    pDescr->Lm92state = LM92_SM_Idle;
                 break;
+            }
+        break;
 
-                case LM92_I2CSEQ_ReadLsb :
-                   //  lsb = i2c_read(0); 	// no ack
-                    I2C_SM_read(&pDescr->I2cSmInfo, false, &pDescr->Lsb);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_Stop;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // rdemarre la SM
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDToggle(BSP_LED_5);
-                        #endif
-                    }
-                break;
+        case  LM92_SM_ready :
+            // Attente du Restart de l'utilisateur
+        break;
+    }
+} // end I2C_LM92_SM_Execute
 
-                case LM92_I2CSEQ_Stop :
-                    // i2c_stop();
-                    I2C_SM_stop(&pDescr->I2cSmInfo);
-                    if (I2C_SM_isReady (&pDescr->I2cSmInfo)){
-                        // Effectue les calculs des tempratures
-                        RawTemp = pDescr->Msb;
-                        RawTemp = RawTemp << 8;
-                        RawTemp = RawTemp | pDescr->Lsb;
-                        pDescr->RawTemp = RawTemp;
-                        RawTemp = RawTemp / 8;
-                        // bit poid faible = 0.0625 degr
-                        pDescr->TempMilli = RawTemp * 62.5;
-                        pDescr->Temperature = RawTemp * 0.0625;
-
-                        pDescr->Lm92Sequence = LM92_I2CSEQ_Idle;
-                        I2C_SM_begin(&pDescr->I2cSmInfo); // redemare la SM
-                        pDescr->Lm92state = LM92_SM_ready;
-                        #ifdef USE_LED_MEASURE
-                            BSP_LEDOff(BSP_LED_6); // marque fin squence
-                        #endif
-                    }
-                break;
-                 
-                case LM92_I2CSEQ_Idle :
-                    // ajout pour eviter Warning
-                break;
+#else
+
+// Mode alarme indisponible sans le moteur : lecture continue conserve
+bool I2C_LM92_SM_AlarmInit(S_Descr_LM92_SM *pDescr, const S_LM92_ALARM_CFG *pCfg)
+{
+    (void)pDescr;
+    (void)pCfg;
+    return false;
+}
+
+// Execution de la lecture du registre de temprature du LM92
+// Prvu pour appel cyclique, la squence est droule par l'interprteur
+void I2C_LM92_SM_Execute(S_Descr_LM92_SM *pDescr)
+{
+    switch ( pDescr->Lm92state )  {
+        case  LM92_SM_Idle :
+            // Passe  Busy
+            I2C_SM_ProgStart(&pDescr->I2cProg, lm92_read_temp_seq, pDescr->Frame);
+            pDescr->Lm92state = LM92_SM_Busy;
+            #ifdef USE_LED_MEASURE
+                BSP_LEDOn(BSP_LED_6);   // Marque dbut squence active
+            #endif
+        break;
+
+        case  LM92_SM_Busy :
+            I2C_SM_ProgExecute(&pDescr->I2cProg);
+            if (I2C_SM_ProgIsDone(&pDescr->I2cProg)) {
+                if (pDescr->I2cProg.Result == I2C_SM_XFER_Ok) {
+                    I2C_Master_DevicePtrSet(&I2cLm92Kit, lm92_temp_ptr);
+                    pDescr->Msb = pDescr->Frame[0];
+                    pDescr->Lsb = pDescr->Frame[1];
+                    // Effectue les calculs des tempratures
+                    I2C_LM92_SM_Convert(pDescr);
+                    pDescr->Lm92state = LM92_SM_ready;
+                    #ifdef USE_LED_MEASURE
+                        BSP_LEDOff(BSP_LED_6); // marque fin squence
+                    #endif
+                } else {
+                    // Nack ou erreur : nouvelle lecture
+                    // pointeur du LM92 inconnu
+                    I2C_Master_DeviceInvalidate(&I2cLm92Kit);
+                    pDescr->Lm92state = LM92_SM_Idle;
+                }
             }
         break;
 
@@ -226,14 +378,22 @@ void I2C_LM92_SM_Execute(S_Descr_LM92_SM *pDescr)
             // Attente du Restart de l'utilisateur
             // aprs lecture des rsultats
         break;
+
+        case  LM92_SM_Config :
+            // Mode alarme, jamais atteint sans le moteur
+        break;
     }
        
 } // end I2C_LM92_SM_Execute
+
+#endif
    
 
+// Enveloppe float, calcule  la demande (bibliothque soft-float)
 float I2C_LM92_SM_GetTemp(S_Descr_LM92_SM *pDescr)
 {
-    return pDescr->Temperature;
+    // bit poid faible = 0.0625 degr
+    return (pDescr->RawTemp / 8) * 0.0625;
 }
 
 int32_t I2C_LM92_SM_GetTempMilli(S_Descr_LM92_SM *pDescr) {
@@ -244,6 +404,10 @@ int16_t I2C_LM92_SM_GetRawTemp(S_Descr_LM92_SM *pDescr) {
     return pDescr->RawTemp;
 }
 
+uint8_t I2C_LM92_SM_GetAlarmFlags(S_Descr_LM92_SM *pDescr) {
+    return pDescr->AlarmFlags;
+}
+
  
 
 
@@ -15,6 +15,18 @@
 //      28.05.2015  CHR remplacement typedef32.h par stdint.h et adaptations
 //      10.05.2016  CHR maj version et mise en ordre des commentaire pour viter des warnings
 //      (SCA 11.04.2017 adaptation Harmony 1.08 (pas de modif de ce fichier))
+//      17.10.2026  lecture par transaction du moteur Mc32_I2cMaster
+//                  (LM92_USE_I2C_MASTER dans le .c)
+//      17.10.2026  squence micro-tapes par table, suppression E_LM92_Sequence
+//      17.10.2026  cache du pointeur LM92 (Lm92Dev), lecture seule si
+//                  le pointeur est dj sur la temprature
+//      17.10.2026  Lm92Dev remplac par I2cLm92Kit (Mc32gestI2cLM92.h),
+//                  cache unique partag avec les fonctions i2c_xxx
+//      17.10.2026  plus de float dans le descripteur, prfrer
+//                  I2C_LM92_SM_GetTempMilli
+//      17.10.2026  mode alarme (moteur Mc32_I2cMaster uniquement) :
+//                  programmation des seuils, lecture sur INT/T_CRIT_A
+//                  ou rafrachissement lent
 //
 // Principe utilisation :
 // ----------------------
@@ -28,43 +40,67 @@
 //
 // d) Obtention des rsultat (Test dans cycle lents)
 //    if (I2C_LM92_SM_IsReady(&pDescr) == true) {
-//        // Obtention de la temprature
-//        float Mytemp = I2C_LM92_SM_GetTemp(&Descr);
+//        // Obtention de la temprature (entier, sans float)
+//        int32_t MyTempMilli = I2C_LM92_SM_GetTempMilli(&Descr);
 //        // Relance le traitement
 //        I2C_LM92_SM_Restart(&Descr);
 //    }
+//
+// e) Mode alarme (optionnel, aprs b) :
+//    if (!I2C_LM92_SM_AlarmInit(&Descr, &MyAlarmCfg)) { pas de moteur }
+//    Les seuils et la configuration sont crits par Execute, ensuite
+//    l'tat Idle ne lance une lecture que si IntPinActive() est vraie
+//    ou si RefreshMs est coul. Le reste de l'utilisation est inchang.
 //----------------------------------------------------------
 
 #include <stdint.h>
 
 #include "Mc32_I2cUtil_SM.h"
+#include "Mc32_I2cMaster.h"
 
 // enumeration  Etat principal
-typedef enum { LM92_SM_Idle, LM92_SM_Busy, LM92_SM_ready} E_LM92_state;
+typedef enum { LM92_SM_Idle, LM92_SM_Busy, LM92_SM_ready, LM92_SM_Config} E_LM92_state;
+
+// Drapeaux d'alarme (3 bits de poids faible du registre temprature)
+#define LM92_FLAG_TLOW     0x01     // T < T_LOW
+#define LM92_FLAG_THIGH    0x02     // T > T_HIGH
+#define LM92_FLAG_TCRIT    0x04     // T > T_CRIT
 
-// enumeration  Etapes de la squence
-typedef enum { LM92_I2CSEQ_Idle,
-               LM92_I2CSEQ_Start,
-               LM92_I2CSEQ_WriteAddrW,
-               LM92_I2CSEQ_WritePtrTemp,
-               LM92_I2CSEQ_ReStart,
-               LM92_I2CSEQ_WriteAddrR,
-               LM92_I2CSEQ_ReadMsb,
-               LM92_I2CSEQ_ReadLsb,
-               LM92_I2CSEQ_Stop,
-                                } E_LM92_Sequence;
+// Registre configuration : INT en mode comparateur, actifs bas,
+// fault queue (4 mesures hors fentre avant activation des sorties)
+#define LM92_CONFIG_FAULT_QUEUE  0x10
+
+// Configuration du mode alarme (seuils en millime de degr)
+// Les sorties INT et T_CRIT_A retombent  seuil - THystMilli
+typedef struct {
+    int32_t THighMilli;
+    int32_t TLowMilli;
+    int32_t TCritMilli;
+    int32_t THystMilli;
+    uint8_t Config;                 // registre configuration du LM92
+    uint32_t RefreshMs;             // lecture de fond, max 50000 ms
+    bool (*IntPinActive)(void);     // tat INT/T_CRIT_A, NULL si non cbl
+} S_LM92_ALARM_CFG;
 
 // Descripteur LM92 pour traitement par machine d'tat
 typedef struct {
     // I2C_MODULE i2cModuleId;         // Id du Module I2C
     E_LM92_state Lm92state;         // Etat principal
-    E_LM92_Sequence Lm92Sequence;   // Etapes de la squence
-    S_Descr_I2C_SM I2cSmInfo;       // Descripteur pour fonction I2C_SM
+    S_I2C_SM_PROG I2cProg;          // Squence pour fonction I2C_SM
+    S_I2C_TRANSACTION I2cTrans;     // Transaction pour Mc32_I2cMaster
+    uint8_t Ptr;                    // pointeur registre  crire
+    uint8_t Frame[2];               // Msb, Lsb lus par la squence
     uint8_t Lsb;
     uint8_t Msb;
     int16_t RawTemp;        // valeur brute registre tempratue
     int32_t TempMilli;      // temprature en millime de degr
-    float Temperature;     // temprature en degr
+    uint8_t AlarmFlags;     // LM92_FLAG_xx de la dernire lecture
+    // Mode alarme
+    const S_LM92_ALARM_CFG *pAlarmCfg;  // NULL : lecture continue
+    S_I2C_TRANSACTION I2cCfgTrans;      // criture d'un registre
+    uint8_t CfgTx[3];                   // pointeur, Msb, Lsb
+    uint8_t AlarmStep;                  // registre en cours d'criture
+    uint32_t NextRefresh;               // chance lecture de fond
 } S_Descr_LM92_SM;
 
 // Descripteur gestion LM92 par State Machine
@@ -86,5 +122,10 @@ bool I2C_LM92_SM_IsReady(S_Descr_LM92_SM *pDescr);
 float I2C_LM92_SM_GetTemp(S_Descr_LM92_SM *pDescr);
 int32_t I2C_LM92_SM_GetTempMilli(S_Descr_LM92_SM *pDescr);
 int16_t I2C_LM92_SM_GetRawTemp(S_Descr_LM92_SM *pDescr);
+uint8_t I2C_LM92_SM_GetAlarmFlags(S_Descr_LM92_SM *pDescr);
+
+// Mode alarme, disponible avec LM92_USE_I2C_MASTER
+// retourne false sans le moteur (la lecture continue est conserve)
+bool I2C_LM92_SM_AlarmInit(S_Descr_LM92_SM *pDescr, const S_LM92_ALARM_CFG *pCfg);
 
 #endif
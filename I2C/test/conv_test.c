@@ -0,0 +1,255 @@
+/*******************************************************************************
+ * @file conv_test.c
+ * @summary
+ *
+ * Host test of the integer temperature conversions against the float path,
+ * for the 65536 raw values of the 16 bits registers
+ *
+ * Writes one CSV line per conversion :
+ *
+ *  - lm92          : LM92_ConvRawToMilli against LM92_ConvRawToDeg
+ *  - ds18b20       : DS18B20_ConvRawToMilli against DS18B20_ConvRawToDeg
+ *                    (ReadDS18B20Milli, ReadDS18B20 and DS18B20_SM)
+ *  - lm92_sm       : I2C_LM92_SM_GetTempMilli against I2C_LM92_SM_GetTemp,
+ *                    each raw value is put in the fake LM92 and read by
+ *                    I2C_LM92_SM_Execute (I2C_LM92_SM_Convert)
+ *
+ * The float result in degrees times 1000, truncated, must be bit-exact
+ * with the integer one : Raw * 62.5 holds in the 24 bits of a float.
+ *
+ * Columns :
+ *  values          : raw values compared
+ *  mismatches      : integer result different from the float one
+ *  int_ns          : host time of one integer conversion (or getter)
+ *  float_ns        : host time of one float conversion (or getter)
+ *
+ * Host times only rank the two paths : the host has an FPU, the PIC32MX
+ * calls the soft-float library, so the gap is larger on target.
+ *
+ * Usage : conv_test [LoopTicks]
+ *  LoopTicks   : application time between two I2C_LM92_SM_Execute calls
+ *
+ * Exit code is 1 on any mismatch
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fake_plib_i2c.h"
+#include "Mc32gestI2cLM92.h"
+#include "Mc32gestI2cLM92_SM.h"
+#include "Mc32_DS18b20.h"
+
+/* Raw values of a 16 bits register */
+#define CONV_VALUES         65536
+
+/* Passes over all values for the host times */
+#define CONV_TIME_PASSES    200
+
+/* Default application time between two I2C_LM92_SM_Execute calls */
+#define CONV_LOOP_TICKS     400
+
+/* I2C_LM92_SM_Execute calls before a read is declared stuck */
+#define CONV_MAX_LOOPS      100000
+
+/* Conversions compared, integer then float */
+typedef int32_t (*CONV_MILLI)(int16_t Raw);
+typedef void (*CONV_DEG)(int16_t Raw, float* pTemp);
+
+static uint32_t convLoopTicks = CONV_LOOP_TICKS;
+static int convErrors;
+static volatile int32_t convSinkMilli;
+static volatile float convSinkDeg;
+
+/*****************************************************************************/
+
+/**
+ * conv_float_to_milli
+ *
+ * @param Temp : Temperature of the float path [degree]
+ * @return Thousandths of degree, truncated as a float to int conversion
+ */
+static int32_t conv_float_to_milli(float Temp)
+{
+    return (int32_t)(Temp * 1000.0f);
+}
+
+/**
+ * conv_host_ns
+ * @return Host monotonic time [ns]
+ */
+static double conv_host_ns(void)
+{
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+    return (double)Now.tv_sec * 1e9 + (double)Now.tv_nsec;
+}
+
+/**
+ * conv_print
+ *
+ * One CSV line, counts a mismatch as an error
+ */
+static void conv_print(const char* pConv, uint32_t Values, uint32_t Mismatches,
+                       double IntNs, double FloatNs)
+{
+    printf("%s,%lu,%lu,%.2f,%.2f\n",
+           pConv,
+           (unsigned long)Values,
+           (unsigned long)Mismatches,
+           IntNs,
+           FloatNs);
+
+    if(Mismatches != 0)
+    {
+        fprintf(stderr, "%s : %lu values differ from the float path\n",
+                pConv, (unsigned long)Mismatches);
+        convErrors++;
+    }
+}
+
+/*****************************************************************************/
+
+/**
+ * conv_milli_ns / conv_deg_ns
+ *
+ * @return Host time of one conversion over all raw values [ns]
+ */
+static double conv_milli_ns(CONV_MILLI Milli)
+{
+    double Start = conv_host_ns();
+    uint32_t Pass;
+    uint32_t Raw;
+
+    for( Pass = 0 ; Pass < CONV_TIME_PASSES ; Pass++ )
+    {
+        for( Raw = 0 ; Raw < CONV_VALUES ; Raw++ )
+            convSinkMilli = Milli((int16_t)Raw);
+    }
+    return (conv_host_ns() - Start) / ((double)CONV_TIME_PASSES * CONV_VALUES);
+}
+
+static double conv_deg_ns(CONV_DEG Deg)
+{
+    double Start = conv_host_ns();
+    uint32_t Pass;
+    uint32_t Raw;
+    float Temp;
+
+    for( Pass = 0 ; Pass < CONV_TIME_PASSES ; Pass++ )
+    {
+        for( Raw = 0 ; Raw < CONV_VALUES ; Raw++ )
+        {
+            Deg((int16_t)Raw, &Temp);
+            convSinkDeg = Temp;
+        }
+    }
+    return (conv_host_ns() - Start) / ((double)CONV_TIME_PASSES * CONV_VALUES);
+}
+
+/**
+ * conv_test
+ *
+ * Integer and float conversions of a driver over all raw values
+ *
+ * @param pConv : Conversion name
+ */
+static void conv_test(const char* pConv, CONV_MILLI Milli, CONV_DEG Deg)
+{
+    uint32_t Mismatches = 0;
+    uint32_t Raw;
+    float Temp;
+
+    for( Raw = 0 ; Raw < CONV_VALUES ; Raw++ )
+    {
+        Deg((int16_t)Raw, &Temp);
+        if(Milli((int16_t)Raw) != conv_float_to_milli(Temp))
+            Mismatches++;
+    }
+
+    conv_print(pConv, CONV_VALUES, Mismatches, conv_milli_ns(Milli), conv_deg_ns(Deg));
+}
+
+/*****************************************************************************/
+
+/**
+ * conv_lm92_sm_read
+ *
+ * One read of the temperature register by the state machine
+ *
+ * @return true if the read ended
+ */
+static bool conv_lm92_sm_read(S_Descr_LM92_SM* pDescr)
+{
+    uint32_t Loops = 0;
+
+    I2C_LM92_SM_Restart(pDescr);
+    while(!I2C_LM92_SM_IsReady(pDescr) && (Loops < CONV_MAX_LOOPS))
+    {
+        I2C_LM92_SM_Execute(pDescr);
+        FakeI2c_Advance(convLoopTicks);
+        Loops++;
+    }
+    return I2C_LM92_SM_IsReady(pDescr);
+}
+
+/**
+ * conv_test_lm92_sm
+ *
+ * Every raw value read on the fake bus and converted by the state machine
+ */
+static void conv_test_lm92_sm(void)
+{
+    S_Descr_LM92_SM Descr;
+    uint32_t Mismatches = 0;
+    uint32_t Raw;
+    uint32_t Pass;
+    double Start;
+    double IntNs;
+    double FloatNs;
+
+    FakeI2c_Reset();
+    I2C_LM92_SM_Init(&Descr, true);
+
+    for( Raw = 0 ; Raw < CONV_VALUES ; Raw++ )
+    {
+        FakeI2c_SlaveRegisterSet(0, (uint16_t)Raw);
+        if(!conv_lm92_sm_read(&Descr) ||
+           (I2C_LM92_SM_GetRawTemp(&Descr) != (int16_t)Raw) ||
+           (I2C_LM92_SM_GetTempMilli(&Descr) != conv_float_to_milli(I2C_LM92_SM_GetTemp(&Descr))))
+        {
+            Mismatches++;
+        }
+    }
+
+    /* Getters of the last value, the float one converts at each call */
+    Start = conv_host_ns();
+    for( Pass = 0 ; Pass < CONV_TIME_PASSES * CONV_VALUES ; Pass++ )
+        convSinkMilli = I2C_LM92_SM_GetTempMilli(&Descr);
+    IntNs = (conv_host_ns() - Start) / ((double)CONV_TIME_PASSES * CONV_VALUES);
+
+    Start = conv_host_ns();
+    for( Pass = 0 ; Pass < CONV_TIME_PASSES * CONV_VALUES ; Pass++ )
+        convSinkDeg = I2C_LM92_SM_GetTemp(&Descr);
+    FloatNs = (conv_host_ns() - Start) / ((double)CONV_TIME_PASSES * CONV_VALUES);
+
+    conv_print("lm92_sm", CONV_VALUES, Mismatches, IntNs, FloatNs);
+}
+
+/*****************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    if(argc > 1)
+        convLoopTicks = (uint32_t)strtoul(argv[1], NULL, 0);
+
+    printf("conversion,values,mismatches,int_ns,float_ns\n");
+
+    conv_test("lm92", LM92_ConvRawToMilli, LM92_ConvRawToDeg);
+    conv_test("ds18b20", DS18B20_ConvRawToMilli, DS18B20_ConvRawToDeg);
+    conv_test_lm92_sm();
+
+    return (convErrors == 0) ? 0 : 1;
+}
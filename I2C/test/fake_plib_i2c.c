@@ -0,0 +1,862 @@
+/*******************************************************************************
+ * @file fake_plib_i2c.c
+ * @summary
+ *
+ * Host simulation of the PIC32MX I2C bus of the kit for i2c_bus_test
+ * One action of the module runs at a time, it ends after its SCL clocks
+ * (start 1, byte and ack 9, read 8, ack 1, stop 1) unless the slave
+ * stretches SCL. Its end sets the master interrupt flag, a collision
+ * sets the bus one. Flags are latched until PLIB_INT_SourceFlagClear.
+ * The port pins of the lines see the same wired AND levels, edges made
+ * with them (bus recovery) clock the slave and make start / stop.
+ * Delays of Mc32Delays.h, clock service and LEDs are simulated here too.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+#include "fake_plib_i2c.h"
+#include "peripheral/ports/plib_ports.h"
+#include "peripheral/int/plib_int.h"
+#include "system/clk/sys_clk.h"
+#include "bsp_config.h"
+#include "Mc32Delays.h"
+
+/* Interrupt sources of plib_int.h */
+#define FAKE_INT_SOURCES    (INT_SOURCE_I2C_5_BUS + 1)
+
+/* Port channels of plib_ports.h */
+#define FAKE_PORT_CHANNELS  (PORTS_CHANNEL_G + 1)
+
+/* Lines of FAKE_I2C_BUS */
+#define FAKE_SCL_CHANNEL    PORTS_CHANNEL_A
+#define FAKE_SCL_POS        PORTS_BIT_POS_2
+#define FAKE_SDA_CHANNEL    PORTS_CHANNEL_A
+#define FAKE_SDA_POS        PORTS_BIT_POS_3
+
+/* Actions of the module */
+typedef enum
+{
+    FAKE_OP_NONE,
+    FAKE_OP_START,
+    FAKE_OP_RESTART,
+    FAKE_OP_WRITE,
+    FAKE_OP_READ,
+    FAKE_OP_ACK,
+    FAKE_OP_STOP,
+} E_FAKE_OP;
+
+/* State of one simulated module */
+typedef struct
+{
+    bool Enabled;
+    uint32_t BitTicks;                      /* SCL clock from baud rate */
+    E_FAKE_OP Op;                           /* Running action */
+    uint32_t OpLeft;                        /* Its ticks still to run */
+    uint8_t TxByte;
+    bool AckSend;                           /* Ack (true) or nack to send */
+    bool Acked;                             /* Last byte sent acknowledged */
+    bool RxFull;
+    uint8_t RxByte;
+    bool StartSeen;                         /* S and P status bits */
+    bool StopSeen;
+    bool Collision;
+} S_FAKE_I2C;
+
+/* State of the slave */
+typedef struct
+{
+    bool Present;
+    uint16_t Regs[FAKE_I2C_SLAVE_REGS];
+    uint8_t Ptr;
+    bool AddressNext;                       /* Next byte is the address */
+    bool Selected;
+    bool Reading;
+    uint8_t Index;                          /* Bytes since the address */
+    uint32_t SdaHold;                       /* SCL pulses before SDA release */
+    bool SclHold;
+    uint32_t SclHoldAfter;                  /* Bytes before SCL hold */
+} S_FAKE_SLAVE;
+
+static S_FAKE_I2C fakeI2c[I2C_NUMBER_OF_MODULES];
+static S_FAKE_SLAVE fakeSlave;
+static uint16_t fakeLat[FAKE_PORT_CHANNELS];
+static uint16_t fakeOut[FAKE_PORT_CHANNELS]; /* Pins set as output */
+static bool fakeScl = true;                 /* Line levels */
+static bool fakeSda = true;
+static uint32_t fakeNow;
+static uint32_t fakeLast;                   /* Time of the last update */
+static uint32_t fakeAccessTicks = 2;
+static S_FAKE_I2C_COUNTERS fakeCounters;
+static FAKE_I2C_ISR fakeIsr[FAKE_INT_SOURCES];
+static uint32_t fakeIntEnabled;             /* One bit per source */
+static uint32_t fakeIntFlags;
+static bool fakeIntOn = true;               /* Global enable */
+static bool fakeInIsr;
+
+/*****************************************************************************/
+
+/**
+ * fake_int_set
+ *
+ * @param Source : Interrupt source to flag
+ */
+static void fake_int_set(INT_SOURCE Source)
+{
+    fakeIntFlags |= (1u << Source);
+}
+
+/**
+ * fake_int_raise
+ *
+ * Call the handlers of enabled and set sources
+ * Not nested, PLIB calls of a handler do not raise again
+ */
+static void fake_int_raise(void)
+{
+    INT_SOURCE Source;
+
+    if(fakeInIsr || !fakeIntOn)
+        return;
+
+    fakeInIsr = true;
+    for( Source = 0 ; Source < FAKE_INT_SOURCES ; Source++ )
+    {
+        if(((fakeIntEnabled & fakeIntFlags & (1u << Source)) != 0) &&
+           (fakeIsr[Source] != NULL))
+        {
+            fakeCounters.Interrupts++;
+            fakeIsr[Source]();
+        }
+    }
+    fakeInIsr = false;
+}
+
+/**
+ * fake_pin_low
+ *
+ * @return true while the pin is an output cleared
+ */
+static bool fake_pin_low(PORTS_CHANNEL Channel, PORTS_BIT_POS Pos)
+{
+    uint16_t Mask = (uint16_t)(1u << Pos);
+
+    return ((fakeOut[Channel] & Mask) != 0) && ((fakeLat[Channel] & Mask) == 0);
+}
+
+/**
+ * fake_slave_clock
+ *
+ * One SCL pulse seen by the slave
+ */
+static void fake_slave_clock(void)
+{
+    if((fakeSlave.SdaHold > 0) && (fakeSlave.SdaHold != FAKE_I2C_HOLD_FOREVER))
+        fakeSlave.SdaHold--;
+}
+
+/**
+ * fake_slave_start / fake_slave_stop
+ *
+ * Conditions seen by the slave
+ */
+static void fake_slave_start(void)
+{
+    fakeSlave.AddressNext = true;
+    fakeSlave.Selected = false;
+    fakeCounters.Starts++;
+}
+
+static void fake_slave_stop(void)
+{
+    fakeSlave.AddressNext = false;
+    fakeSlave.Selected = false;
+    fakeCounters.Stops++;
+}
+
+/**
+ * fake_lines_update
+ *
+ * Wired AND levels of the lines, edges made by the port pins
+ */
+static void fake_lines_update(void)
+{
+    bool SclPin = fake_pin_low(FAKE_SCL_CHANNEL, FAKE_SCL_POS);
+    bool Scl = !(SclPin || fakeSlave.SclHold);
+    bool Sda;
+
+    if(fakeScl && !Scl && SclPin)
+    {
+        fakeCounters.PortClocks++;
+        fake_slave_clock();
+    }
+    Sda = !(fake_pin_low(FAKE_SDA_CHANNEL, FAKE_SDA_POS) || (fakeSlave.SdaHold > 0));
+
+    /* SDA edge while SCL stays high */
+    if(fakeScl && Scl && (fakeSda != Sda))
+    {
+        if(Sda)
+            fake_slave_stop();
+        else
+            fake_slave_start();
+    }
+    fakeScl = Scl;
+    fakeSda = Sda;
+}
+
+/**
+ * fake_slave_moved
+ *
+ * A byte is moved, the slave may then stretch SCL
+ */
+static void fake_slave_moved(void)
+{
+    fakeCounters.Bytes++;
+    if(fakeSlave.SclHoldAfter > 0)
+    {
+        fakeSlave.SclHoldAfter--;
+        if(fakeSlave.SclHoldAfter == 0)
+            fakeSlave.SclHold = true;
+    }
+}
+
+/**
+ * fake_slave_write
+ *
+ * @param Byte : Byte received by the slave
+ * @return true if acknowledged
+ */
+static bool fake_slave_write(uint8_t Byte)
+{
+    if(fakeSlave.AddressNext)
+    {
+        fakeSlave.AddressNext = false;
+        fakeSlave.Selected = fakeSlave.Present && ((Byte & 0xFE) == FAKE_I2C_SLAVE_ADDRESS);
+        fakeSlave.Reading = ((Byte & 0x01) != 0);
+        fakeSlave.Index = 0;
+        return fakeSlave.Selected;
+    }
+    if(!fakeSlave.Selected || fakeSlave.Reading)
+        return false;
+
+    if(fakeSlave.Index == 0)
+    {
+        fakeSlave.Ptr = Byte % FAKE_I2C_SLAVE_REGS;
+        fakeCounters.PtrWrites++;
+    }
+    else if(fakeSlave.Index == 1)
+        fakeSlave.Regs[fakeSlave.Ptr] = (uint16_t)((Byte << 8) | (fakeSlave.Regs[fakeSlave.Ptr] & 0x00FF));
+    else
+        fakeSlave.Regs[fakeSlave.Ptr] = (uint16_t)((fakeSlave.Regs[fakeSlave.Ptr] & 0xFF00) | Byte);
+    fakeSlave.Index++;
+    return true;
+}
+
+/**
+ * fake_slave_read
+ *
+ * @return Byte sent by the slave, 0xFF (SDA released) if not selected
+ */
+static uint8_t fake_slave_read(void)
+{
+    uint16_t Reg = fakeSlave.Regs[fakeSlave.Ptr];
+
+    if(!fakeSlave.Selected || !fakeSlave.Reading)
+        return 0xFF;
+
+    return (uint8_t)(((fakeSlave.Index++ & 1) == 0) ? (Reg >> 8) : Reg);
+}
+
+/**
+ * fake_i2c_collision
+ *
+ * The module lost the bus, it stops and flags the bus interrupt
+ */
+static void fake_i2c_collision(S_FAKE_I2C* pI2c)
+{
+    pI2c->Op = FAKE_OP_NONE;
+    pI2c->Collision = true;
+    fakeCounters.Collisions++;
+    fake_int_set(INT_SOURCE_I2C_2_BUS);
+}
+
+/**
+ * fake_i2c_clocks
+ *
+ * @param Clocks : SCL pulses made by the module
+ */
+static void fake_i2c_clocks(uint8_t Clocks)
+{
+    while(Clocks-- > 0)
+        fake_slave_clock();
+    fake_lines_update();
+}
+
+/**
+ * fake_i2c_end
+ *
+ * End of the running action of FAKE_I2C_BUS
+ */
+static void fake_i2c_end(S_FAKE_I2C* pI2c)
+{
+    bool SdaHeld = (fakeSlave.SdaHold > 0);
+
+    switch(pI2c->Op)
+    {
+        case FAKE_OP_START:
+        case FAKE_OP_RESTART:
+            pI2c->StartSeen = true;
+            pI2c->StopSeen = false;
+            fake_slave_start();
+            break;
+
+        case FAKE_OP_WRITE:
+            fake_i2c_clocks(9);
+            /* A one bit sent while SDA is held is lost */
+            if(SdaHeld && (pI2c->TxByte != 0))
+            {
+                fake_i2c_collision(pI2c);
+                return;
+            }
+            pI2c->Acked = fake_slave_write(pI2c->TxByte);
+            fake_slave_moved();
+            break;
+
+        case FAKE_OP_READ:
+            fake_i2c_clocks(8);
+            pI2c->RxByte = fake_slave_read();
+            pI2c->RxFull = true;
+            fake_slave_moved();
+            break;
+
+        case FAKE_OP_ACK:
+            fake_i2c_clocks(1);
+            if(!pI2c->AckSend)
+                fakeSlave.Reading = false;
+            break;
+
+        case FAKE_OP_STOP:
+            fake_i2c_clocks(1);
+            if(fakeSlave.SdaHold > 0)
+            {
+                fake_i2c_collision(pI2c);
+                return;
+            }
+            pI2c->StartSeen = false;
+            pI2c->StopSeen = true;
+            fake_slave_stop();
+            break;
+
+        case FAKE_OP_NONE:
+            return;
+    }
+
+    pI2c->Op = FAKE_OP_NONE;
+    fake_int_set(INT_SOURCE_I2C_2_MASTER);
+}
+
+/**
+ * fake_i2c_update
+ *
+ * Let the running action of FAKE_I2C_BUS progress up to now
+ * The action stalls while the slave holds SCL
+ */
+static void fake_i2c_update(void)
+{
+    S_FAKE_I2C* pI2c = &fakeI2c[FAKE_I2C_BUS];
+    uint32_t Elapsed = fakeNow - fakeLast;
+
+    fakeLast = fakeNow;
+    if(!pI2c->Enabled || (pI2c->Op == FAKE_OP_NONE) || fakeSlave.SclHold)
+        return;
+
+    if(Elapsed >= pI2c->OpLeft)
+        fake_i2c_end(pI2c);
+    else
+        pI2c->OpLeft -= Elapsed;
+}
+
+/**
+ * fake_access
+ *
+ * CPU time of one PLIB call, then state at this time
+ */
+static void fake_access(void)
+{
+    fakeNow += fakeAccessTicks;
+    fakeCounters.Accesses++;
+    fake_i2c_update();
+    fake_int_raise();
+}
+
+/**
+ * fake_i2c_access
+ *
+ * @param I2cId : I2C module
+ * @return Simulated module, after the CPU time of the call
+ */
+static S_FAKE_I2C* fake_i2c_access(I2C_MODULE_ID I2cId)
+{
+    fake_access();
+    return &fakeI2c[I2cId];
+}
+
+/**
+ * fake_i2c_action
+ *
+ * Start an action, only the module of the bus ends its actions
+ *
+ * @param Clocks : SCL clocks of the action
+ */
+static S_FAKE_I2C* fake_i2c_action(I2C_MODULE_ID I2cId, E_FAKE_OP Op, uint8_t Clocks)
+{
+    S_FAKE_I2C* pI2c = fake_i2c_access(I2cId);
+
+    if(!pI2c->Enabled || (pI2c->Op != FAKE_OP_NONE))
+        return pI2c;
+
+    pI2c->Op = Op;
+    pI2c->OpLeft = pI2c->BitTicks * Clocks;
+    return pI2c;
+}
+
+/*****************************************************************************/
+
+void FakeI2c_Reset(void)
+{
+    I2C_MODULE_ID I2cId;
+
+    memset(fakeI2c, 0, sizeof(fakeI2c));
+    for( I2cId = 0 ; I2cId < I2C_NUMBER_OF_MODULES ; I2cId++ )
+        fakeI2c[I2cId].BitTicks = FAKE_CORE_TIMER_HZ / 100000;
+    memset(&fakeSlave, 0, sizeof(fakeSlave));
+    fakeSlave.Present = true;
+    memset(fakeLat, 0, sizeof(fakeLat));
+    memset(fakeOut, 0, sizeof(fakeOut));
+    fakeScl = true;
+    fakeSda = true;
+    fakeNow = 0;
+    fakeLast = 0;
+    fakeIntEnabled = 0;
+    fakeIntFlags = 0;
+    fakeIntOn = true;
+    fakeInIsr = false;
+    FakeI2c_ClearCounters();
+}
+
+void FakeI2c_SetAccessTicks(uint32_t Ticks)
+{
+    fakeAccessTicks = Ticks;
+}
+
+void FakeI2c_Advance(uint32_t Ticks)
+{
+    const S_FAKE_I2C* pI2c = &fakeI2c[FAKE_I2C_BUS];
+    uint32_t Step;
+
+    /* Step to each action end, its handler runs at that time */
+    while(Ticks > 0)
+    {
+        Step = Ticks;
+        if(pI2c->Enabled && (pI2c->Op != FAKE_OP_NONE) && !fakeSlave.SclHold &&
+           (pI2c->OpLeft < Step))
+        {
+            Step = (pI2c->OpLeft > 0) ? pI2c->OpLeft : 1;
+        }
+        fakeNow += Step;
+        Ticks -= Step;
+        fake_i2c_update();
+        fake_int_raise();
+    }
+}
+
+uint32_t FakeI2c_Now(void)
+{
+    return fakeNow;
+}
+
+uint32_t FakeI2c_CoreTimer(void)
+{
+    fake_access();
+    return fakeNow;
+}
+
+uint32_t FakeI2c_BitTicks(void)
+{
+    return fakeI2c[FAKE_I2C_BUS].BitTicks;
+}
+
+void FakeI2c_SlavePresent(bool Present)
+{
+    fakeSlave.Present = Present;
+}
+
+void FakeI2c_SlaveRegisterSet(uint8_t Ptr, uint16_t Value)
+{
+    fakeSlave.Regs[Ptr % FAKE_I2C_SLAVE_REGS] = Value;
+}
+
+uint16_t FakeI2c_SlaveRegisterGet(uint8_t Ptr)
+{
+    return fakeSlave.Regs[Ptr % FAKE_I2C_SLAVE_REGS];
+}
+
+uint8_t FakeI2c_SlavePtr(void)
+{
+    return fakeSlave.Ptr;
+}
+
+void FakeI2c_HoldSda(uint32_t Clocks)
+{
+    fake_i2c_update();
+    fakeSlave.SdaHold = Clocks;
+    fake_lines_update();
+}
+
+void FakeI2c_HoldScl(bool Hold)
+{
+    fake_i2c_update();
+    fakeSlave.SclHold = Hold;
+    fakeSlave.SclHoldAfter = 0;
+    fake_lines_update();
+}
+
+void FakeI2c_HoldSclAfter(uint32_t Bytes)
+{
+    fakeSlave.SclHoldAfter = Bytes;
+}
+
+bool FakeI2c_SclIsHigh(void)
+{
+    return fakeScl;
+}
+
+bool FakeI2c_SdaIsHigh(void)
+{
+    return fakeSda;
+}
+
+S_FAKE_I2C_COUNTERS FakeI2c_Counters(void)
+{
+    return fakeCounters;
+}
+
+void FakeI2c_ClearCounters(void)
+{
+    memset(&fakeCounters, 0, sizeof(fakeCounters));
+}
+
+void FakeI2c_SetVector(INT_SOURCE Source, FAKE_I2C_ISR Isr)
+{
+    fakeIsr[Source] = Isr;
+}
+
+unsigned int FakeI2c_IsrState(void)
+{
+    return fakeIntOn ? 1 : 0;
+}
+
+unsigned int FakeI2c_IsrDisable(void)
+{
+    unsigned int State = FakeI2c_IsrState();
+
+    fakeIntOn = false;
+    return State;
+}
+
+void FakeI2c_IsrRestore(unsigned int State)
+{
+    fakeIntOn = (State != 0);
+    fake_int_raise();
+}
+
+/*****************************************************************************/
+
+void delay_us(uint32_t us)
+{
+    FakeI2c_Advance(us * (FAKE_CORE_TIMER_HZ / 1000000));
+}
+
+void delay_ms(uint32_t ms)
+{
+    while(ms-- > 0)
+        delay_us(1000);
+}
+
+uint32_t SYS_CLK_SystemFrequencyGet(void)
+{
+    return FAKE_SYSCLK_HZ;
+}
+
+uint32_t SYS_CLK_PeripheralFrequencyGet(CLK_BUSES_PERIPHERAL PeripheralBus)
+{
+    (void)PeripheralBus;
+    return FAKE_PBCLK_HZ;
+}
+
+void BSP_LEDOn(BSP_LED led)
+{
+    (void)led;
+}
+
+void BSP_LEDOff(BSP_LED led)
+{
+    (void)led;
+}
+
+/*****************************************************************************/
+
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    fakeIntEnabled |= (1u << source);
+    fake_int_raise();
+}
+
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    fakeIntEnabled &= ~(1u << source);
+}
+
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    fakeIntFlags &= ~(1u << source);
+}
+
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority)
+{
+    (void)index;
+    (void)vector;
+    (void)priority;
+}
+
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_SUBPRIORITY_LEVEL subPriority)
+{
+    (void)index;
+    (void)vector;
+    (void)subPriority;
+}
+
+/*****************************************************************************/
+
+void PLIB_PORTS_PinSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fake_access();
+    fakeLat[channel] |= (uint16_t)(1u << bitPos);
+    fake_lines_update();
+}
+
+void PLIB_PORTS_PinClear(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fake_access();
+    fakeLat[channel] &= (uint16_t)~(1u << bitPos);
+    fake_lines_update();
+}
+
+bool PLIB_PORTS_PinGet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fake_access();
+    if((channel == FAKE_SCL_CHANNEL) && (bitPos == FAKE_SCL_POS))
+        return fakeScl;
+    if((channel == FAKE_SDA_CHANNEL) && (bitPos == FAKE_SDA_POS))
+        return fakeSda;
+    return ((fakeLat[channel] & (1u << bitPos)) != 0);
+}
+
+void PLIB_PORTS_PinDirectionInputSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fake_access();
+    fakeOut[channel] &= (uint16_t)~(1u << bitPos);
+    fake_lines_update();
+}
+
+void PLIB_PORTS_PinDirectionOutputSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fake_access();
+    fakeOut[channel] |= (uint16_t)(1u << bitPos);
+    fake_lines_update();
+}
+
+/*****************************************************************************/
+
+void PLIB_I2C_Enable(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index)->Enabled = true;
+}
+
+void PLIB_I2C_Disable(I2C_MODULE_ID index)
+{
+    S_FAKE_I2C* pI2c = fake_i2c_access(index);
+
+    /* Clearing ON aborts the action and resets the status bits */
+    pI2c->Enabled = false;
+    pI2c->Op = FAKE_OP_NONE;
+    pI2c->RxFull = false;
+    pI2c->StartSeen = false;
+    pI2c->StopSeen = false;
+}
+
+void PLIB_I2C_BaudRateSet(I2C_MODULE_ID index, uint32_t clockFrequency, I2C_BAUD_RATE baudRate)
+{
+    (void)clockFrequency;
+    fake_i2c_access(index)->BitTicks = FAKE_CORE_TIMER_HZ / baudRate;
+}
+
+void PLIB_I2C_HighFrequencyEnable(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+void PLIB_I2C_StopInIdleDisable(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+void PLIB_I2C_SlaveClockStretchingEnable(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+void PLIB_I2C_SlaveClockRelease(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+bool PLIB_I2C_BusIsIdle(I2C_MODULE_ID index)
+{
+    return (fake_i2c_access(index)->Op == FAKE_OP_NONE);
+}
+
+bool PLIB_I2C_ArbitrationLossHasOccurred(I2C_MODULE_ID index)
+{
+    return fake_i2c_access(index)->Collision;
+}
+
+void PLIB_I2C_ArbitrationLossClear(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index)->Collision = false;
+}
+
+bool PLIB_I2C_StartWasDetected(I2C_MODULE_ID index)
+{
+    return fake_i2c_access(index)->StartSeen;
+}
+
+bool PLIB_I2C_StopWasDetected(I2C_MODULE_ID index)
+{
+    return fake_i2c_access(index)->StopSeen;
+}
+
+bool PLIB_I2C_ReceiverOverflowHasOccurred(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+    return false;
+}
+
+void PLIB_I2C_ReceiverOverflowClear(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+bool PLIB_I2C_TransmitterOverflowHasOccurred(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+    return false;
+}
+
+void PLIB_I2C_TransmitterOverflowClear(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+}
+
+void PLIB_I2C_MasterStart(I2C_MODULE_ID index)
+{
+    S_FAKE_I2C* pI2c = fake_i2c_action(index, FAKE_OP_START, 1);
+
+    /* Start needs both lines high */
+    if((index == FAKE_I2C_BUS) && (pI2c->Op == FAKE_OP_START) && (!fakeScl || !fakeSda))
+        fake_i2c_collision(pI2c);
+}
+
+void PLIB_I2C_MasterStartRepeat(I2C_MODULE_ID index)
+{
+    S_FAKE_I2C* pI2c = fake_i2c_action(index, FAKE_OP_RESTART, 1);
+
+    /* SDA is released first, it must go high */
+    if((index == FAKE_I2C_BUS) && (pI2c->Op == FAKE_OP_RESTART) && (fakeSlave.SdaHold > 0))
+        fake_i2c_collision(pI2c);
+}
+
+void PLIB_I2C_MasterStop(I2C_MODULE_ID index)
+{
+    fake_i2c_action(index, FAKE_OP_STOP, 1);
+}
+
+bool PLIB_I2C_TransmitterIsReady(I2C_MODULE_ID index)
+{
+    /* The byte goes to the shift register at once, TBF never stays set */
+    fake_i2c_access(index);
+    return true;
+}
+
+bool PLIB_I2C_TransmitterIsBusy(I2C_MODULE_ID index)
+{
+    fake_i2c_access(index);
+    return false;
+}
+
+void PLIB_I2C_TransmitterByteSend(I2C_MODULE_ID index, uint8_t data)
+{
+    fake_i2c_action(index, FAKE_OP_WRITE, 9)->TxByte = data;
+}
+
+bool PLIB_I2C_TransmitterByteHasCompleted(I2C_MODULE_ID index)
+{
+    return (fake_i2c_access(index)->Op != FAKE_OP_WRITE);
+}
+
+bool PLIB_I2C_TransmitterByteWasAcknowledged(I2C_MODULE_ID index)
+{
+    return fake_i2c_access(index)->Acked;
+}
+
+void PLIB_I2C_MasterReceiverClock1Byte(I2C_MODULE_ID index)
+{
+    fake_i2c_action(index, FAKE_OP_READ, 8);
+}
+
+bool PLIB_I2C_ReceivedByteIsAvailable(I2C_MODULE_ID index)
+{
+    return fake_i2c_access(index)->RxFull;
+}
+
+uint8_t PLIB_I2C_ReceivedByteGet(I2C_MODULE_ID index)
+{
+    S_FAKE_I2C* pI2c = fake_i2c_access(index);
+
+    pI2c->RxFull = false;
+    return pI2c->RxByte;
+}
+
+bool PLIB_I2C_MasterReceiverReadyToAcknowledge(I2C_MODULE_ID index)
+{
+    E_FAKE_OP Op = fake_i2c_access(index)->Op;
+
+    return (Op != FAKE_OP_READ) && (Op != FAKE_OP_ACK);
+}
+
+void PLIB_I2C_ReceivedByteAcknowledge(I2C_MODULE_ID index, bool ack)
+{
+    fake_i2c_action(index, FAKE_OP_ACK, 1)->AckSend = ack;
+}
+
+bool PLIB_I2C_ReceiverByteAcknowledgeHasCompleted(I2C_MODULE_ID index)
+{
+    return (fake_i2c_access(index)->Op != FAKE_OP_ACK);
+}
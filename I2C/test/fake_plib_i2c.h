@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * @file fake_plib_i2c.h
+ * @summary
+ *
+ * Host simulation of the PIC32MX I2C bus of the kit for i2c_bus_test
+ *
+ * Time is counted in core timer ticks (SYSCLK / 2), the value returned
+ * by _CP0_GET_COUNT(). Each PLIB call and each core timer read costs
+ * AccessTicks of CPU, each action of the module (start, byte with its
+ * ack, ack, stop) lasts its SCL clocks at the rate of PLIB_I2C_BaudRateSet.
+ *
+ * SCL and SDA are wired AND lines : low while the port pin RA2 (SCL2) or
+ * RA3 (SDA2) is an output cleared, or while the slave holds it.
+ * A start on a low line and a one bit or a stop while SDA is held set
+ * the bus collision. Module actions stall while the slave holds SCL.
+ *
+ * The slave on the bus is a register pointer device as the LM92 : the
+ * first byte written is the pointer, next ones fill the 16 bits register
+ * (MSB first), reads return the register MSB first.
+ *
+ * Enabled interrupt sources call the handler given to FakeI2c_SetVector
+ * while their flag is set : master at the end of each action, bus on
+ * a collision. Handlers are not nested.
+ *
+ ******************************************************************************/
+
+#ifndef FAKE_PLIB_I2C_H
+#define FAKE_PLIB_I2C_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "peripheral/i2c/plib_i2c.h"
+#include "peripheral/int/plib_int.h"
+
+/* Core timer frequency [Hz], SYSCLK 80 MHz / 2 */
+#define FAKE_CORE_TIMER_HZ  40000000u
+
+/* System and peripheral bus frequency [Hz] */
+#define FAKE_SYSCLK_HZ      80000000u
+#define FAKE_PBCLK_HZ       80000000u
+
+/* Module wired to the simulated lines */
+#define FAKE_I2C_BUS        I2C_ID_2
+
+/* Slave address (8 bits, write) and number of its registers */
+#define FAKE_I2C_SLAVE_ADDRESS  0x90
+#define FAKE_I2C_SLAVE_REGS     8
+
+/* FakeI2c_HoldSda : line never released */
+#define FAKE_I2C_HOLD_FOREVER   0xFFFFFFFFu
+
+/* Simulation counters */
+typedef struct
+{
+    uint32_t Accesses;                      /* PLIB calls and core timer reads */
+    uint32_t Starts;                        /* Start and restart conditions */
+    uint32_t Stops;                         /* Stop conditions on the lines */
+    uint32_t Bytes;                         /* Bytes moved by the module */
+    uint32_t PtrWrites;                     /* Pointer bytes received by the slave */
+    uint32_t PortClocks;                    /* SCL pulses of the port pins */
+    uint32_t Collisions;                    /* Bus collisions */
+    uint32_t Interrupts;                    /* Handlers called */
+} S_FAKE_I2C_COUNTERS;
+
+/* Interrupt handler, as the __ISR function of the vector on target */
+typedef void (*FAKE_I2C_ISR)(void);
+
+/**
+ * FakeI2c_Reset
+ *
+ * Back to power up state, time and counters at 0, lines released,
+ * slave present with its registers and pointer at 0
+ * Handlers given to FakeI2c_SetVector are kept
+ */
+void FakeI2c_Reset(void);
+
+/**
+ * FakeI2c_SetAccessTicks
+ *
+ * @param Ticks : CPU time of one PLIB call or core timer read
+ */
+void FakeI2c_SetAccessTicks(uint32_t Ticks);
+
+/**
+ * FakeI2c_Advance
+ *
+ * Let time run, as the application or a delay does
+ *
+ * @param Ticks : Elapsed core timer ticks
+ */
+void FakeI2c_Advance(uint32_t Ticks);
+
+/**
+ * FakeI2c_Now
+ * @return Simulated core timer, without CPU time
+ */
+uint32_t FakeI2c_Now(void);
+
+/**
+ * FakeI2c_BitTicks
+ * @return Time of one SCL clock on FAKE_I2C_BUS
+ */
+uint32_t FakeI2c_BitTicks(void);
+
+/**
+ * FakeI2c_SlavePresent
+ *
+ * @param Present : false, the slave acknowledges nothing
+ */
+void FakeI2c_SlavePresent(bool Present);
+
+/**
+ * FakeI2c_SlaveRegisterSet / FakeI2c_SlaveRegisterGet
+ *
+ * @param Ptr : Register (pointer value)
+ * @param Value : 16 bits content
+ */
+void FakeI2c_SlaveRegisterSet(uint8_t Ptr, uint16_t Value);
+uint16_t FakeI2c_SlaveRegisterGet(uint8_t Ptr);
+
+/**
+ * FakeI2c_SlavePtr
+ * @return Register pointer of the slave
+ */
+uint8_t FakeI2c_SlavePtr(void);
+
+/**
+ * FakeI2c_HoldSda
+ *
+ * The slave holds SDA low, as after a reset in the middle of a read
+ *
+ * @param Clocks : SCL pulses before it releases SDA, 0 to release now,
+ *                 FAKE_I2C_HOLD_FOREVER for a dead slave
+ */
+void FakeI2c_HoldSda(uint32_t Clocks);
+
+/**
+ * FakeI2c_HoldScl
+ *
+ * @param Hold : true, the slave stretches SCL until released
+ */
+void FakeI2c_HoldScl(bool Hold);
+
+/**
+ * FakeI2c_HoldSclAfter
+ *
+ * The slave stretches SCL once some bytes are moved (stuck in a transfer)
+ *
+ * @param Bytes : Bytes moved before the hold, 0 for none
+ */
+void FakeI2c_HoldSclAfter(uint32_t Bytes);
+
+/**
+ * FakeI2c_SclIsHigh / FakeI2c_SdaIsHigh
+ * @return Level of the line
+ */
+bool FakeI2c_SclIsHigh(void);
+bool FakeI2c_SdaIsHigh(void);
+
+/**
+ * FakeI2c_Counters
+ * @return Counters since the last FakeI2c_ClearCounters
+ */
+S_FAKE_I2C_COUNTERS FakeI2c_Counters(void);
+
+/**
+ * FakeI2c_ClearCounters
+ */
+void FakeI2c_ClearCounters(void);
+
+/**
+ * FakeI2c_SetVector
+ *
+ * @param Source : Interrupt source
+ * @param Isr : Handler called while the source is enabled and set,
+ *              NULL for none
+ */
+void FakeI2c_SetVector(INT_SOURCE Source, FAKE_I2C_ISR Isr);
+
+#endif /* FAKE_PLIB_I2C_H */
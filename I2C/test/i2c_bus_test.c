@@ -0,0 +1,704 @@
+/*******************************************************************************
+ * @file i2c_bus_test.c
+ * @summary
+ *
+ * Host test of the bounded I2C primitives and of the bus recovery on the
+ * fake PLIB_I2C of the kit bus (I2C2, SCL2/RA2, SDA2/RA3)
+ *
+ * Writes one CSV line per scenario, for each layer :
+ *
+ *  - ccs           : i2c_xxx_timeout of Mc32_I2cUtilCCS.c
+ *  - sm            : I2C_SM_Transfer of Mc32_I2cUtil_SM.c, executed every
+ *                    LoopTicks as the application does
+ *  - master        : I2C_Master_Submit / I2C_Master_Wait of Mc32_I2cMaster.c,
+ *                    the fake calls I2C_Master_InterruptHandler
+ *
+ * Scenarios :
+ *  read            : pointer write, restart, 2 bytes read, register checked
+ *  sda_stuck_N     : the slave holds SDA for N SCL pulses (dead slave for
+ *                    forever), the start collides, the recovery gives at
+ *                    most 9 pulses then a stop, the next read must pass
+ *                    if SDA was released
+ *  scl_stuck       : the slave stretches SCL after the address byte, the
+ *                    deadline ends the transfer (I2C_TIMEOUT_US,
+ *                    I2C_SM_TIMEOUT_US or I2C_MASTER_TIMEOUT_US), the read
+ *                    must pass once SCL is released
+ *  nack            : no slave, the address is not acknowledged
+ *  cache           : pointer cache of the LM92 (I2cLm92Kit, S_I2C_DEVICE),
+ *                    kept after an acknowledged pointer write, cleared by
+ *                    a nack, by a write of another register and by a bus
+ *                    recovery of any client
+ *
+ * Columns :
+ *  result          : status of the layer
+ *  elapsed_us      : call (or submit) to end, microseconds
+ *  port_clocks     : SCL pulses of the recovery, stop included
+ *  stops           : stop conditions seen on the lines
+ *  collisions      : bus collisions of the module
+ *
+ * Usage : i2c_bus_test [LoopTicks [AccessTicks]]
+ *  LoopTicks   : application time between two I2C_SM_TransferExecute calls
+ *  AccessTicks : CPU time of one PLIB call
+ *
+ * Exit code is 1 if a scenario does not end as expected
+ *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "fake_plib_i2c.h"
+#include "Mc32_I2cTimeout.h"
+#include "Mc32_I2cUtilCCS.h"
+#include "Mc32_I2cUtil_SM.h"
+#include "Mc32_I2cMaster.h"
+#include "Mc32gestI2cLM92.h"
+
+/* Clocks of I2C_BusRecovery before it gives up */
+#define TEST_RECOVERY_CLOCKS    9
+
+/* Longest I2C_BusRecovery, 9 clocks of 10 us and the stop */
+#define TEST_RECOVERY_MAX_US    150
+
+/* Register read by the scenarios and its content */
+#define TEST_PTR                0
+#define TEST_VALUE              0x1A38
+
+/* Other register written by the cache scenarios */
+#define TEST_OTHER_PTR          1
+
+/* Default application time between two I2C_SM_TransferExecute calls */
+#define TEST_LOOP_TICKS         40
+
+/* I2C_SM_TransferExecute calls before a transfer is declared stuck */
+#define TEST_MAX_LOOPS          1000000
+
+static uint32_t testLoopTicks = TEST_LOOP_TICKS;
+static int testErrors;
+
+/*****************************************************************************/
+
+/**
+ * test_prepare
+ *
+ * Fake bus at power up, slave register to read
+ */
+static void test_prepare(void)
+{
+    FakeI2c_Reset();
+    FakeI2c_SlaveRegisterSet(TEST_PTR, TEST_VALUE);
+}
+
+/**
+ * test_check
+ *
+ * @param pTest : Scenario name
+ * @param Ok : Expected condition
+ * @param pWhat : Condition, printed if not met
+ */
+static void test_check(const char* pTest, bool Ok, const char* pWhat)
+{
+    if(!Ok)
+    {
+        fprintf(stderr, "%s : %s\n", pTest, pWhat);
+        testErrors++;
+    }
+}
+
+/**
+ * test_print
+ *
+ * One CSV line
+ */
+static void test_print(const char* pTest, const char* pResult, uint32_t ElapsedTicks)
+{
+    S_FAKE_I2C_COUNTERS Counters = FakeI2c_Counters();
+
+    printf("%s,%s,%.1f,%lu,%lu,%lu\n",
+           pTest,
+           pResult,
+           (double)ElapsedTicks * 1e6 / FAKE_CORE_TIMER_HZ,
+           (unsigned long)Counters.PortClocks,
+           (unsigned long)Counters.Stops,
+           (unsigned long)Counters.Collisions);
+}
+
+/**
+ * test_us
+ *
+ * @return Core timer ticks of Us microseconds
+ */
+static uint32_t test_us(uint32_t Us)
+{
+    return Us * (FAKE_CORE_TIMER_HZ / 1000000);
+}
+
+/**
+ * test_check_recovery
+ *
+ * Lines after a stuck SDA of Clocks pulses and one recovery
+ */
+static void test_check_recovery(const char* pTest, uint32_t Clocks)
+{
+    S_FAKE_I2C_COUNTERS Counters = FakeI2c_Counters();
+
+    if(Clocks <= TEST_RECOVERY_CLOCKS)
+    {
+        test_check(pTest, Counters.PortClocks == (Clocks + 1), "recovery clocks");
+        test_check(pTest, FakeI2c_SdaIsHigh(), "SDA still low");
+        test_check(pTest, Counters.Stops == 1, "no stop after recovery");
+    }
+    else
+    {
+        test_check(pTest, Counters.PortClocks == (TEST_RECOVERY_CLOCKS + 1),
+                   "recovery not bounded to 9 clocks");
+        test_check(pTest, !FakeI2c_SdaIsHigh(), "SDA released");
+    }
+}
+
+/*****************************************************************************/
+
+/**
+ * ccs_read
+ *
+ * Register read with the bounded primitives
+ *
+ * @param pValue : Register read
+ * @return First status not OK, I2C_STATUS_OK if all passed
+ */
+static E_I2C_STATUS ccs_read(uint16_t* pValue)
+{
+    E_I2C_STATUS Status;
+    bool Ack = false;
+    uint8_t Msb = 0;
+    uint8_t Lsb = 0;
+
+    Status = i2c_start_timeout(I2C_TIMEOUT_US);
+    if(Status == I2C_STATUS_OK)
+        Status = i2c_write_timeout(FAKE_I2C_SLAVE_ADDRESS, &Ack, I2C_TIMEOUT_US);
+    if((Status == I2C_STATUS_OK) && Ack)
+        Status = i2c_write_timeout(TEST_PTR, &Ack, I2C_TIMEOUT_US);
+    if((Status == I2C_STATUS_OK) && Ack)
+        Status = i2c_reStart_timeout(I2C_TIMEOUT_US);
+    if((Status == I2C_STATUS_OK) && Ack)
+        Status = i2c_write_timeout(FAKE_I2C_SLAVE_ADDRESS | 0x01, &Ack, I2C_TIMEOUT_US);
+    if((Status == I2C_STATUS_OK) && Ack)
+        Status = i2c_read_timeout(true, &Msb, I2C_TIMEOUT_US);
+    if((Status == I2C_STATUS_OK) && Ack)
+        Status = i2c_read_timeout(false, &Lsb, I2C_TIMEOUT_US);
+    if(Status == I2C_STATUS_OK)
+        Status = i2c_stop_timeout(I2C_TIMEOUT_US);
+
+    *pValue = Ack ? (uint16_t)((Msb << 8) | Lsb) : 0;
+    return Status;
+}
+
+/**
+ * ccs_status
+ * @return Name of the status
+ */
+static const char* ccs_status(E_I2C_STATUS Status)
+{
+    switch(Status)
+    {
+        case I2C_STATUS_OK:         return "ok";
+        case I2C_STATUS_TIMEOUT:    return "timeout";
+        case I2C_STATUS_COLLISION:  return "collision";
+    }
+    return "?";
+}
+
+/**
+ * test_ccs_read
+ */
+static void test_ccs_read(void)
+{
+    const char* pTest = "ccs_read";
+    uint16_t Value;
+    E_I2C_STATUS Status;
+    uint32_t Start;
+
+    test_prepare();
+    i2c_init(false);
+    Start = FakeI2c_Now();
+    Status = ccs_read(&Value);
+    test_print(pTest, ccs_status(Status), FakeI2c_Now() - Start);
+
+    test_check(pTest, Status == I2C_STATUS_OK, "status");
+    test_check(pTest, Value == TEST_VALUE, "register read");
+    test_check(pTest, FakeI2c_Counters().Stops == 1, "no stop");
+}
+
+/**
+ * test_ccs_sda_stuck
+ *
+ * @param pTest : Scenario name
+ * @param Clocks : SCL pulses before the slave releases SDA
+ */
+static void test_ccs_sda_stuck(const char* pTest, uint32_t Clocks)
+{
+    uint16_t Value;
+    E_I2C_STATUS Status;
+    uint32_t Start;
+    uint32_t Elapsed;
+
+    test_prepare();
+    i2c_init(false);
+    FakeI2c_HoldSda(Clocks);
+    Start = FakeI2c_Now();
+    Status = i2c_start_timeout(I2C_TIMEOUT_US);
+    Elapsed = FakeI2c_Now() - Start;
+    test_print(pTest, ccs_status(Status), Elapsed);
+
+    test_check(pTest, Status == I2C_STATUS_COLLISION, "status");
+    test_check(pTest, Elapsed < test_us(TEST_RECOVERY_MAX_US), "recovery too long");
+    test_check_recovery(pTest, Clocks);
+
+    /* Next read passes if the slave let SDA go, ends with an error if not */
+    Start = FakeI2c_Now();
+    Status = ccs_read(&Value);
+    Elapsed = FakeI2c_Now() - Start;
+    if(Clocks <= TEST_RECOVERY_CLOCKS)
+    {
+        test_check(pTest, Status == I2C_STATUS_OK, "read after recovery");
+        test_check(pTest, Value == TEST_VALUE, "register read after recovery");
+    }
+    else
+    {
+        test_check(pTest, Status == I2C_STATUS_COLLISION, "read on a dead bus");
+        test_check(pTest, Elapsed < test_us(TEST_RECOVERY_MAX_US), "read on a dead bus too long");
+    }
+}
+
+/**
+ * test_ccs_scl_stuck
+ */
+static void test_ccs_scl_stuck(void)
+{
+    const char* pTest = "ccs_scl_stuck";
+    uint16_t Value;
+    E_I2C_STATUS Status;
+    uint32_t Start;
+    uint32_t Elapsed;
+    bool Ack;
+
+    test_prepare();
+    i2c_init(false);
+    FakeI2c_HoldSclAfter(1);
+    Status = i2c_start_timeout(I2C_TIMEOUT_US);
+    if(Status == I2C_STATUS_OK)
+        Status = i2c_write_timeout(FAKE_I2C_SLAVE_ADDRESS, &Ack, I2C_TIMEOUT_US);
+
+    /* The byte after the address never ends */
+    Start = FakeI2c_Now();
+    if(Status == I2C_STATUS_OK)
+        Status = i2c_write_timeout(TEST_PTR, &Ack, I2C_TIMEOUT_US);
+    Elapsed = FakeI2c_Now() - Start;
+    test_print(pTest, ccs_status(Status), Elapsed);
+
+    test_check(pTest, Status == I2C_STATUS_TIMEOUT, "status");
+    test_check(pTest, Elapsed >= test_us(I2C_TIMEOUT_US), "deadline too short");
+    test_check(pTest, Elapsed < test_us(I2C_TIMEOUT_US + TEST_RECOVERY_MAX_US),
+               "deadline not bounded");
+
+    FakeI2c_HoldScl(false);
+    Status = ccs_read(&Value);
+    test_check(pTest, (Status == I2C_STATUS_OK) && (Value == TEST_VALUE),
+               "read after SCL release");
+}
+
+/**
+ * test_ccs_cache
+ *
+ * I2C_ReadRawTempLM92Cached writes the pointer only when the cache is
+ * not valid
+ */
+static void test_ccs_cache(void)
+{
+    const char* pTest = "ccs_cache";
+    uint32_t Start;
+    int16_t Raw;
+
+    test_prepare();
+    I2C_InitLM92();
+    test_check(pTest, I2C_Master_DevicePtrIs(&I2cLm92Kit, TEST_PTR), "pointer not cached");
+
+    FakeI2c_ClearCounters();
+    Raw = I2C_ReadRawTempLM92Cached();
+    test_check(pTest, (uint16_t)Raw == TEST_VALUE, "register read");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 0, "pointer written again");
+
+    /* Nacked pointer write : not cached */
+    FakeI2c_SlavePresent(false);
+    I2C_WriteCfgReadRawTempLM92();
+    test_check(pTest, !I2C_Master_DevicePtrIs(&I2cLm92Kit, TEST_PTR), "pointer cached after a nack");
+    FakeI2c_SlavePresent(true);
+
+    FakeI2c_ClearCounters();
+    Raw = I2C_ReadRawTempLM92Cached();
+    test_check(pTest, (uint16_t)Raw == TEST_VALUE, "register read after a nack");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 1, "pointer not written after a nack");
+
+    /* Recovery of the bus : cache out of date */
+    FakeI2c_HoldSda(3);
+    i2c_start_timeout(I2C_TIMEOUT_US);
+    test_check(pTest, !I2C_Master_DevicePtrIs(&I2cLm92Kit, TEST_PTR), "pointer cached after a recovery");
+
+    FakeI2c_ClearCounters();
+    Start = FakeI2c_Now();
+    Raw = I2C_ReadRawTempLM92Cached();
+    test_print(pTest, ((uint16_t)Raw == TEST_VALUE) ? "ok" : "error", FakeI2c_Now() - Start);
+    test_check(pTest, (uint16_t)Raw == TEST_VALUE, "register read after a recovery");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 1, "pointer not written after a recovery");
+}
+
+/*****************************************************************************/
+
+/**
+ * sm_run
+ *
+ * I2C_SM_TransferExecute every LoopTicks until the transfer ends
+ *
+ * @return Result of the transfer
+ */
+static E_I2C_SM_XFER sm_run(S_I2C_SM_TRANSFER* pXfer, uint16_t* pValue)
+{
+    static const uint8_t Tx[1] = { TEST_PTR };
+    uint8_t Rx[2] = { 0, 0 };
+    uint32_t Loops = 0;
+
+    I2C_SM_Transfer(pXfer, FAKE_I2C_SLAVE_ADDRESS, Tx, 1, Rx, 2, NULL);
+    while(!I2C_SM_TransferIsDone(pXfer) && (Loops < TEST_MAX_LOOPS))
+    {
+        I2C_SM_TransferExecute(pXfer);
+        FakeI2c_Advance(testLoopTicks);
+        Loops++;
+    }
+    *pValue = (uint16_t)((Rx[0] << 8) | Rx[1]);
+    return pXfer->Result;
+}
+
+/**
+ * sm_result
+ * @return Name of the result
+ */
+static const char* sm_result(E_I2C_SM_XFER Result)
+{
+    switch(Result)
+    {
+        case I2C_SM_XFER_Idle:      return "idle";
+        case I2C_SM_XFER_Busy:      return "busy";
+        case I2C_SM_XFER_Ok:        return "ok";
+        case I2C_SM_XFER_Nack:      return "nack";
+        case I2C_SM_XFER_Error:     return "error";
+        case I2C_SM_XFER_Timeout:   return "timeout";
+    }
+    return "?";
+}
+
+/**
+ * test_sm
+ *
+ * @param pTest : Scenario name
+ * @param HoldAfter : Bytes before the slave stretches SCL, 0 for none
+ */
+static void test_sm(const char* pTest, uint32_t HoldAfter)
+{
+    S_Descr_I2C_SM Descr;
+    S_I2C_SM_TRANSFER Xfer;
+    E_I2C_SM_XFER Result;
+    uint16_t Value;
+    uint32_t Start;
+    uint32_t Elapsed;
+
+    test_prepare();
+    I2C_SM_init(false, &Descr);
+    FakeI2c_HoldSclAfter(HoldAfter);
+    Start = FakeI2c_Now();
+    Result = sm_run(&Xfer, &Value);
+    Elapsed = FakeI2c_Now() - Start;
+    test_print(pTest, sm_result(Result), Elapsed);
+
+    if(HoldAfter == 0)
+    {
+        test_check(pTest, Result == I2C_SM_XFER_Ok, "result");
+        test_check(pTest, Value == TEST_VALUE, "register read");
+        return;
+    }
+
+    test_check(pTest, Result == I2C_SM_XFER_Timeout, "result");
+    test_check(pTest, Elapsed >= test_us(I2C_SM_TIMEOUT_US), "deadline too short");
+    /* Start and address steps before, the deadline seen at the next call */
+    test_check(pTest, Elapsed < (test_us(I2C_SM_TIMEOUT_US + TEST_RECOVERY_MAX_US) + (4 * testLoopTicks)),
+               "deadline not bounded");
+
+    FakeI2c_HoldScl(false);
+    Result = sm_run(&Xfer, &Value);
+    test_check(pTest, (Result == I2C_SM_XFER_Ok) && (Value == TEST_VALUE),
+               "read after SCL release");
+}
+
+/*****************************************************************************/
+
+/**
+ * master_isr
+ *
+ * __ISR(_I2C_2_VECTOR) of the application
+ */
+static void master_isr(void)
+{
+    I2C_Master_InterruptHandler(&I2cMasterKit);
+}
+
+/**
+ * master_init
+ *
+ * Engine initialized again on the fake bus at power up
+ */
+static void master_init(void)
+{
+    I2cMasterKit.Initialized = false;
+    I2C_Master_Init(&I2cMasterKit, I2C_MASTER_KIT_ID, false);
+    FakeI2c_SetVector(I2cMasterKit.IntSourceMaster, master_isr);
+    FakeI2c_SetVector(I2cMasterKit.IntSourceBus, master_isr);
+}
+
+/**
+ * master_read
+ *
+ * @param pDevice : Pointer cache of the slave
+ * @param pValue : Register read
+ * @return Result of the transaction
+ */
+static E_I2C_MASTER_RESULT master_read(S_I2C_DEVICE* pDevice, uint16_t* pValue)
+{
+    static const uint8_t Tx[1] = { TEST_PTR };
+    uint8_t Rx[2] = { 0, 0 };
+    S_I2C_TRANSACTION Trans = { 0 };
+    E_I2C_MASTER_RESULT Result;
+
+    Trans.Address = FAKE_I2C_SLAVE_ADDRESS;
+    Trans.pTx = Tx;
+    Trans.TxLen = 1;
+    Trans.pRx = Rx;
+    Trans.RxLen = 2;
+    Trans.Priority = I2C_PRIO_NORMAL;
+    Trans.pDevice = pDevice;
+    Trans.Result = I2C_MASTER_IDLE;
+
+    if(!I2C_Master_Submit(&I2cMasterKit, &Trans))
+        return I2C_MASTER_IDLE;
+    Result = I2C_Master_Wait(&I2cMasterKit, &Trans);
+
+    *pValue = (uint16_t)((Rx[0] << 8) | Rx[1]);
+    return Result;
+}
+
+/**
+ * master_result
+ * @return Name of the result
+ */
+static const char* master_result(E_I2C_MASTER_RESULT Result)
+{
+    switch(Result)
+    {
+        case I2C_MASTER_IDLE:       return "idle";
+        case I2C_MASTER_PENDING:    return "pending";
+        case I2C_MASTER_OK:         return "ok";
+        case I2C_MASTER_NACK:       return "nack";
+        case I2C_MASTER_BUS_ERROR:  return "bus_error";
+        case I2C_MASTER_TIMEOUT:    return "timeout";
+    }
+    return "?";
+}
+
+/**
+ * test_master_read
+ *
+ * @param pTest : Scenario name
+ * @param Present : false, no slave on the bus
+ */
+static void test_master_read(const char* pTest, bool Present)
+{
+    S_I2C_DEVICE Device;
+    E_I2C_MASTER_RESULT Result;
+    uint16_t Value;
+    uint32_t Start;
+
+    test_prepare();
+    FakeI2c_SlavePresent(Present);
+    master_init();
+    I2C_Master_DeviceInit(&Device, FAKE_I2C_SLAVE_ADDRESS);
+    Start = FakeI2c_Now();
+    Result = master_read(&Device, &Value);
+    test_print(pTest, master_result(Result), FakeI2c_Now() - Start);
+
+    if(Present)
+    {
+        test_check(pTest, Result == I2C_MASTER_OK, "result");
+        test_check(pTest, Value == TEST_VALUE, "register read");
+        test_check(pTest, Device.PtrValid && (Device.Ptr == TEST_PTR), "pointer not cached");
+    }
+    else
+    {
+        test_check(pTest, Result == I2C_MASTER_NACK, "result");
+        test_check(pTest, !Device.PtrValid, "pointer cached after a nack");
+    }
+    test_check(pTest, FakeI2c_Counters().Stops == 1, "no stop");
+    test_check(pTest, FakeI2c_Counters().Interrupts > 0, "not ended by interrupts");
+}
+
+/**
+ * test_master_scl_stuck
+ */
+static void test_master_scl_stuck(void)
+{
+    const char* pTest = "master_scl_stuck";
+    S_I2C_DEVICE Device;
+    E_I2C_MASTER_RESULT Result;
+    uint16_t Value;
+    uint32_t Start;
+    uint32_t Elapsed;
+
+    test_prepare();
+    master_init();
+    I2C_Master_DeviceInit(&Device, FAKE_I2C_SLAVE_ADDRESS);
+    Result = master_read(&Device, &Value);
+    test_check(pTest, Device.PtrValid, "pointer not cached");
+
+    /* Stuck after the address, the cached pointer skips the write */
+    FakeI2c_ClearCounters();
+    FakeI2c_HoldSclAfter(1);
+    Start = FakeI2c_Now();
+    Result = master_read(&Device, &Value);
+    Elapsed = FakeI2c_Now() - Start;
+    test_print(pTest, master_result(Result), Elapsed);
+
+    test_check(pTest, Result == I2C_MASTER_TIMEOUT, "result");
+    test_check(pTest, Elapsed >= test_us(I2C_MASTER_TIMEOUT_US), "deadline too short");
+    test_check(pTest, Elapsed < test_us(I2C_MASTER_TIMEOUT_US + TEST_RECOVERY_MAX_US),
+               "deadline not bounded");
+    test_check(pTest, !Device.PtrValid, "pointer cached after a timeout");
+
+    FakeI2c_HoldScl(false);
+    Result = master_read(&Device, &Value);
+    test_check(pTest, (Result == I2C_MASTER_OK) && (Value == TEST_VALUE),
+               "read after SCL release");
+}
+
+/**
+ * test_master_sda_stuck
+ *
+ * @param pTest : Scenario name
+ * @param Clocks : SCL pulses before the slave releases SDA
+ */
+static void test_master_sda_stuck(const char* pTest, uint32_t Clocks)
+{
+    S_I2C_DEVICE Device;
+    E_I2C_MASTER_RESULT Result;
+    uint16_t Value;
+    uint32_t Start;
+    uint32_t Elapsed;
+
+    test_prepare();
+    master_init();
+    I2C_Master_DeviceInit(&Device, FAKE_I2C_SLAVE_ADDRESS);
+    FakeI2c_HoldSda(Clocks);
+    Start = FakeI2c_Now();
+    Result = master_read(&Device, &Value);
+    Elapsed = FakeI2c_Now() - Start;
+    test_print(pTest, master_result(Result), Elapsed);
+
+    test_check(pTest, Result == I2C_MASTER_BUS_ERROR, "result");
+    test_check(pTest, Elapsed < test_us(TEST_RECOVERY_MAX_US), "recovery too long");
+    test_check_recovery(pTest, Clocks);
+
+    Result = master_read(&Device, &Value);
+    if(Clocks <= TEST_RECOVERY_CLOCKS)
+        test_check(pTest, (Result == I2C_MASTER_OK) && (Value == TEST_VALUE),
+                   "read after recovery");
+    else
+        test_check(pTest, Result == I2C_MASTER_BUS_ERROR, "read on a dead bus");
+}
+
+/**
+ * test_master_cache
+ *
+ * The engine writes the pointer again after a write of another register
+ * with the same device and after a recovery of another client
+ */
+static void test_master_cache(void)
+{
+    const char* pTest = "master_cache";
+    static const uint8_t Tx[3] = { TEST_OTHER_PTR, 0x12, 0x34 };
+    S_I2C_TRANSACTION Trans = { 0 };
+    E_I2C_MASTER_RESULT Result;
+    uint16_t Value;
+    uint32_t Start;
+
+    test_prepare();
+    master_init();
+    I2C_Master_DeviceInit(&I2cLm92Kit, FAKE_I2C_SLAVE_ADDRESS);
+    master_read(&I2cLm92Kit, &Value);
+
+    FakeI2c_ClearCounters();
+    Result = master_read(&I2cLm92Kit, &Value);
+    test_check(pTest, (Result == I2C_MASTER_OK) && (Value == TEST_VALUE), "cached read");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 0, "pointer written again");
+
+    /* Write of another register (as the alarm thresholds) */
+    Trans.Address = FAKE_I2C_SLAVE_ADDRESS;
+    Trans.pTx = Tx;
+    Trans.TxLen = sizeof(Tx);
+    Trans.Priority = I2C_PRIO_NORMAL;
+    Trans.pDevice = &I2cLm92Kit;
+    Trans.Result = I2C_MASTER_IDLE;
+    I2C_Master_Submit(&I2cMasterKit, &Trans);
+    Result = I2C_Master_Wait(&I2cMasterKit, &Trans);
+    test_check(pTest, Result == I2C_MASTER_OK, "register write");
+    test_check(pTest, I2C_Master_DevicePtrIs(&I2cLm92Kit, TEST_OTHER_PTR), "written pointer not cached");
+
+    FakeI2c_ClearCounters();
+    Result = master_read(&I2cLm92Kit, &Value);
+    test_check(pTest, (Result == I2C_MASTER_OK) && (Value == TEST_VALUE), "read after a write");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 1, "pointer not written after a write");
+
+    /* Recovery by another client of the bus */
+    I2C_BusRecovery(I2C_MASTER_KIT_ID);
+    FakeI2c_ClearCounters();
+    Start = FakeI2c_Now();
+    Result = master_read(&I2cLm92Kit, &Value);
+    test_print(pTest, master_result(Result), FakeI2c_Now() - Start);
+    test_check(pTest, (Result == I2C_MASTER_OK) && (Value == TEST_VALUE), "read after a recovery");
+    test_check(pTest, FakeI2c_Counters().PtrWrites == 1, "pointer not written after a recovery");
+}
+
+/*****************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    if(argc > 1)
+        testLoopTicks = (uint32_t)strtoul(argv[1], NULL, 0);
+    if(argc > 2)
+        FakeI2c_SetAccessTicks((uint32_t)strtoul(argv[2], NULL, 0));
+
+    printf("test,result,elapsed_us,port_clocks,stops,collisions\n");
+
+    test_ccs_read();
+    test_ccs_sda_stuck("ccs_sda_stuck_3", 3);
+    test_ccs_sda_stuck("ccs_sda_stuck_9", TEST_RECOVERY_CLOCKS);
+    test_ccs_sda_stuck("ccs_sda_stuck_forever", FAKE_I2C_HOLD_FOREVER);
+    test_ccs_scl_stuck();
+    test_ccs_cache();
+
+    test_sm("sm_read", 0);
+    test_sm("sm_scl_stuck", 1);
+
+    test_master_read("master_read", true);
+    test_master_read("master_nack", false);
+    test_master_sda_stuck("master_sda_stuck_3", 3);
+    test_master_sda_stuck("master_sda_stuck_forever", FAKE_I2C_HOLD_FOREVER);
+    test_master_scl_stuck();
+    test_master_cache();
+
+    return (testErrors == 0) ? 0 : 1;
+}
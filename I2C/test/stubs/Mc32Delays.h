@@ -0,0 +1,10 @@
+/* Host stub of Mc32Delays.h, delays let the simulated time run */
+#ifndef MC32DELAYS_H
+#define MC32DELAYS_H
+
+#include <stdint.h>
+
+void delay_us(uint32_t us);
+void delay_ms(uint32_t ms);
+
+#endif /* MC32DELAYS_H */
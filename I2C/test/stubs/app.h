@@ -0,0 +1,9 @@
+/* Host stub of app.h, only what Mc32_I2cUtilCCS.c needs */
+#ifndef APP_H
+#define APP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "system/clk/sys_clk.h"
+
+#endif /* APP_H */
@@ -0,0 +1,14 @@
+/* Host stub of bsp_config.h, LEDs of the kit do nothing */
+#ifndef BSP_CONFIG_H
+#define BSP_CONFIG_H
+
+typedef enum
+{
+    BSP_LED_0, BSP_LED_1, BSP_LED_2, BSP_LED_3,
+    BSP_LED_4, BSP_LED_5, BSP_LED_6, BSP_LED_7,
+} BSP_LED;
+
+void BSP_LEDOn(BSP_LED led);
+void BSP_LEDOff(BSP_LED led);
+
+#endif /* BSP_CONFIG_H */
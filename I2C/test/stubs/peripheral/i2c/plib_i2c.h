@@ -0,0 +1,57 @@
+/* Host stub of the Harmony I2C peripheral library
+ * Implemented by fake_plib_i2c.c, only I2C_ID_2 (bus of the kit) is
+ * wired to the simulated lines, the other modules never end an action */
+#ifndef PLIB_I2C_H
+#define PLIB_I2C_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    I2C_ID_1,
+    I2C_ID_2,
+    I2C_ID_3,
+    I2C_ID_4,
+    I2C_ID_5,
+    I2C_NUMBER_OF_MODULES
+} I2C_MODULE_ID;
+
+typedef uint32_t I2C_BAUD_RATE;
+
+void PLIB_I2C_Enable(I2C_MODULE_ID index);
+void PLIB_I2C_Disable(I2C_MODULE_ID index);
+void PLIB_I2C_BaudRateSet(I2C_MODULE_ID index, uint32_t clockFrequency, I2C_BAUD_RATE baudRate);
+void PLIB_I2C_HighFrequencyEnable(I2C_MODULE_ID index);
+void PLIB_I2C_StopInIdleDisable(I2C_MODULE_ID index);
+void PLIB_I2C_SlaveClockStretchingEnable(I2C_MODULE_ID index);
+void PLIB_I2C_SlaveClockRelease(I2C_MODULE_ID index);
+
+bool PLIB_I2C_BusIsIdle(I2C_MODULE_ID index);
+bool PLIB_I2C_ArbitrationLossHasOccurred(I2C_MODULE_ID index);
+void PLIB_I2C_ArbitrationLossClear(I2C_MODULE_ID index);
+bool PLIB_I2C_StartWasDetected(I2C_MODULE_ID index);
+bool PLIB_I2C_StopWasDetected(I2C_MODULE_ID index);
+bool PLIB_I2C_ReceiverOverflowHasOccurred(I2C_MODULE_ID index);
+void PLIB_I2C_ReceiverOverflowClear(I2C_MODULE_ID index);
+bool PLIB_I2C_TransmitterOverflowHasOccurred(I2C_MODULE_ID index);
+void PLIB_I2C_TransmitterOverflowClear(I2C_MODULE_ID index);
+
+void PLIB_I2C_MasterStart(I2C_MODULE_ID index);
+void PLIB_I2C_MasterStartRepeat(I2C_MODULE_ID index);
+void PLIB_I2C_MasterStop(I2C_MODULE_ID index);
+
+bool PLIB_I2C_TransmitterIsReady(I2C_MODULE_ID index);
+bool PLIB_I2C_TransmitterIsBusy(I2C_MODULE_ID index);
+void PLIB_I2C_TransmitterByteSend(I2C_MODULE_ID index, uint8_t data);
+bool PLIB_I2C_TransmitterByteHasCompleted(I2C_MODULE_ID index);
+bool PLIB_I2C_TransmitterByteWasAcknowledged(I2C_MODULE_ID index);
+
+void PLIB_I2C_MasterReceiverClock1Byte(I2C_MODULE_ID index);
+bool PLIB_I2C_ReceivedByteIsAvailable(I2C_MODULE_ID index);
+uint8_t PLIB_I2C_ReceivedByteGet(I2C_MODULE_ID index);
+bool PLIB_I2C_MasterReceiverReadyToAcknowledge(I2C_MODULE_ID index);
+void PLIB_I2C_ReceivedByteAcknowledge(I2C_MODULE_ID index, bool ack);
+bool PLIB_I2C_ReceiverByteAcknowledgeHasCompleted(I2C_MODULE_ID index);
+
+#endif /* PLIB_I2C_H */
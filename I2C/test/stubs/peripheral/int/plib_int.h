@@ -0,0 +1,47 @@
+/* Host stub of the Harmony interrupt peripheral library
+ * Implemented by fake_plib_i2c.c, enabled sources call the handlers
+ * given to FakeI2c_SetVector */
+#ifndef PLIB_INT_H
+#define PLIB_INT_H
+
+#include <stdbool.h>
+
+typedef enum
+{
+    INT_ID_0,
+} INT_MODULE_ID;
+
+typedef enum
+{
+    INT_SOURCE_I2C_1_MASTER, INT_SOURCE_I2C_1_BUS,
+    INT_SOURCE_I2C_2_MASTER, INT_SOURCE_I2C_2_BUS,
+    INT_SOURCE_I2C_3_MASTER, INT_SOURCE_I2C_3_BUS,
+    INT_SOURCE_I2C_4_MASTER, INT_SOURCE_I2C_4_BUS,
+    INT_SOURCE_I2C_5_MASTER, INT_SOURCE_I2C_5_BUS,
+} INT_SOURCE;
+
+typedef enum
+{
+    INT_VECTOR_I2C1, INT_VECTOR_I2C2, INT_VECTOR_I2C3, INT_VECTOR_I2C4,
+    INT_VECTOR_I2C5,
+} INT_VECTOR;
+
+typedef enum
+{
+    INT_PRIORITY_LEVEL0, INT_PRIORITY_LEVEL1, INT_PRIORITY_LEVEL2, INT_PRIORITY_LEVEL3,
+    INT_PRIORITY_LEVEL4, INT_PRIORITY_LEVEL5, INT_PRIORITY_LEVEL6, INT_PRIORITY_LEVEL7,
+} INT_PRIORITY_LEVEL;
+
+typedef enum
+{
+    INT_SUBPRIORITY_LEVEL0, INT_SUBPRIORITY_LEVEL1,
+    INT_SUBPRIORITY_LEVEL2, INT_SUBPRIORITY_LEVEL3,
+} INT_SUBPRIORITY_LEVEL;
+
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority);
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_SUBPRIORITY_LEVEL subPriority);
+
+#endif /* PLIB_INT_H */
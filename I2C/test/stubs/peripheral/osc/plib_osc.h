@@ -0,0 +1,5 @@
+/* Host stub of the Harmony oscillator peripheral library, not used */
+#ifndef PLIB_OSC_H
+#define PLIB_OSC_H
+
+#endif /* PLIB_OSC_H */
@@ -0,0 +1,34 @@
+/* Host stub of the Harmony ports peripheral library
+ * Implemented by fake_plib_i2c.c, SCL2/RA2 and SDA2/RA3 are the lines
+ * of the simulated bus, other pins are plain latches */
+#ifndef PLIB_PORTS_H
+#define PLIB_PORTS_H
+
+#include <stdbool.h>
+
+typedef enum
+{
+    PORTS_ID_0,
+} PORTS_MODULE_ID;
+
+typedef enum
+{
+    PORTS_CHANNEL_A, PORTS_CHANNEL_B, PORTS_CHANNEL_C, PORTS_CHANNEL_D,
+    PORTS_CHANNEL_E, PORTS_CHANNEL_F, PORTS_CHANNEL_G,
+} PORTS_CHANNEL;
+
+typedef enum
+{
+    PORTS_BIT_POS_0, PORTS_BIT_POS_1, PORTS_BIT_POS_2, PORTS_BIT_POS_3,
+    PORTS_BIT_POS_4, PORTS_BIT_POS_5, PORTS_BIT_POS_6, PORTS_BIT_POS_7,
+    PORTS_BIT_POS_8, PORTS_BIT_POS_9, PORTS_BIT_POS_10, PORTS_BIT_POS_11,
+    PORTS_BIT_POS_12, PORTS_BIT_POS_13, PORTS_BIT_POS_14, PORTS_BIT_POS_15,
+} PORTS_BIT_POS;
+
+void PLIB_PORTS_PinSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+void PLIB_PORTS_PinClear(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+bool PLIB_PORTS_PinGet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+void PLIB_PORTS_PinDirectionInputSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+void PLIB_PORTS_PinDirectionOutputSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos);
+
+#endif /* PLIB_PORTS_H */
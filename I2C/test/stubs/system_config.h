@@ -0,0 +1,7 @@
+/* Host stub of system_config.h, LEDs of the kit do nothing */
+#ifndef SYSTEM_CONFIG_H
+#define SYSTEM_CONFIG_H
+
+#include "bsp_config.h"
+
+#endif /* SYSTEM_CONFIG_H */
@@ -0,0 +1,3 @@
+/* Host stub of the generated project path, the static driver of the
+ * repository is found by the include path of the Makefile */
+#include <drv_i2c_static.h>
@@ -0,0 +1,19 @@
+/* Host stub of <xc.h>, core timer is the simulated time of the fake I2C
+ * Interrupt enable of XC32 builtins is the one of the fake handlers */
+#ifndef XC_H
+#define XC_H
+
+#include <stdint.h>
+
+uint32_t FakeI2c_CoreTimer(void);
+unsigned int FakeI2c_IsrState(void);
+unsigned int FakeI2c_IsrDisable(void);
+void FakeI2c_IsrRestore(unsigned int State);
+
+#define _CP0_GET_COUNT()    FakeI2c_CoreTimer()
+
+#define __builtin_get_isr_state()       FakeI2c_IsrState()
+#define __builtin_disable_interrupts()  FakeI2c_IsrDisable()
+#define __builtin_set_isr_state(s)      FakeI2c_IsrRestore(s)
+
+#endif /* XC_H */
@@ -11,6 +11,7 @@
 //      Adaptation  la plib_spi                09.02.2015 CHR
 //      maj version compilateur et Harmony      24.05.2016 CHR
 //      Correction de la squence de lecture    25.05.2016 CHR
+//      Version non bloquante par jetons        17.10.2026
 //      Version KIT     PCB 11020_B
 //	Version		:	V1.2
 //	Compilateur	:	XC32 V1.40 + Harmony 1.06
@@ -19,69 +20,157 @@
 
 // #define MARKER_READ 1
 
+// Profondeur du buffer tendu [octets], limite des octets en vol
+#define SPI_ASYNC_DEPTH 16
+
 #include "app.h"
 #include "Mc32SpiUtil.h"
-#include "peripheral\SPI\plib_spi.h"
+#include "peripheral/spi/plib_spi.h"
 
+// Etat d'un SPI en mode non bloquant
+// Le jeton d'un octet est son numro d'ordre d'criture
+typedef struct {
+   SPI_TOKEN TxCount;                   // octets crits dans le fifo
+   SPI_TOKEN RxCount;                   // octets relus du fifo
+   bool Ready;                          // buffer tendu activ
+   uint8_t RxData[SPI_ASYNC_DEPTH];     // octets reus, index jeton
+} S_SPI_ASYNC;
 
-void spi_write1( uint8_t Val){
-   int SpiBusy;
-   
-   PLIB_SPI_BufferWrite(SPI_ID_1, Val);
+static S_SPI_ASYNC SpiAsync1;
+static S_SPI_ASYNC SpiAsync2;
 
-   do {
-     SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_1) ;
-   } while (SpiBusy == 1);
-}
 
+// Activation du buffer tendu, SPI arrt pendant le changement
+static void spi_async_init(SPI_MODULE_ID SpiId, S_SPI_ASYNC *pAsync){
+   PLIB_SPI_Disable(SpiId);
+   PLIB_SPI_FIFOEnable(SpiId);
+   PLIB_SPI_BufferClear(SpiId);
+   PLIB_SPI_ReceiverOverflowClear(SpiId);
+   PLIB_SPI_Enable(SpiId);
 
-void spi_write2( uint8_t Val){
-   int SpiBusy;
-   
-   PLIB_SPI_BufferWrite(SPI_ID_2, Val);
-   do {
-     SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_2) ;
-   } while (SpiBusy == 1);
+   pAsync->TxCount = 0;
+   pAsync->RxCount = 0;
+   pAsync->Ready = true;
 }
 
-uint8_t spi_read1( uint8_t Val){
-   int SpiBusy;  
-   uint32_t lu;
-   
-   PLIB_SPI_BufferWrite(SPI_ID_1, Val);
-   // Attends fin transmission
-   do {
-        SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_1) ;
-   } while (SpiBusy == 1);
-   
-   // Attend arrive dans fifo
-   while (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_1));
+// Relit les octets arrivs dans le fifo
+static void spi_async_drain(SPI_MODULE_ID SpiId, S_SPI_ASYNC *pAsync){
+   while ((pAsync->RxCount != pAsync->TxCount) &&
+          !PLIB_SPI_ReceiverFIFOIsEmpty(SpiId)) {
 #ifdef MARKER_READ
-   LED3_W  = 1;
+      LED3_W  = 1;
 #endif
-   lu = PLIB_SPI_BufferRead(SPI_ID_1);
+      pAsync->RxData[pAsync->RxCount % SPI_ASYNC_DEPTH] = PLIB_SPI_BufferRead(SpiId);
+      pAsync->RxCount++;
 #ifdef MARKER_READ
-   LED3_W  = 0;
+      LED3_W  = 0;
 #endif
-   return lu;
+   }
 }
 
- uint8_t spi_read2( uint8_t Val){
-   int SpiBusy;
-   uint8_t lu;
-   
-   PLIB_SPI_BufferWrite(SPI_ID_2, Val);
-  
+// Place l'octet dans le fifo
+// N'attend que si SPI_ASYNC_DEPTH octets sont dj en vol
+static SPI_TOKEN spi_async_write(SPI_MODULE_ID SpiId, S_SPI_ASYNC *pAsync, uint8_t Val){
+   SPI_TOKEN Token;
+
+   // Activation au premier appel, l'appelant n'a rien  initialiser
+   if (!pAsync->Ready)
+      spi_async_init(SpiId, pAsync);
+
    do {
-      SpiBusy =  PLIB_SPI_IsBusy(SPI_ID_2) ;
-   } while (SpiBusy == 1);
-   
-   // Attend arrive dans fifo
-   while (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID_2));
-   
-   lu = PLIB_SPI_BufferRead(SPI_ID_2);
-   return lu;
+      spi_async_drain(SpiId, pAsync);
+   } while (((pAsync->TxCount - pAsync->RxCount) >= SPI_ASYNC_DEPTH) ||
+            PLIB_SPI_TransmitBufferIsFull(SpiId));
+
+   PLIB_SPI_BufferWrite(SpiId, Val);
+   Token = pAsync->TxCount;
+   pAsync->TxCount++;
+   return Token;
+}
+
+// Vrai quand l'octet du jeton est reu
+static bool spi_async_done(SPI_MODULE_ID SpiId, S_SPI_ASYNC *pAsync, SPI_TOKEN Token){
+   spi_async_drain(SpiId, pAsync);
+   return (int32_t)(pAsync->RxCount - Token) > 0;
+}
+
+// Attend l'octet du jeton et le retourne
+static uint8_t spi_async_wait(SPI_MODULE_ID SpiId, S_SPI_ASYNC *pAsync, SPI_TOKEN Token){
+   while (!spi_async_done(SpiId, pAsync, Token));
+   return pAsync->RxData[Token % SPI_ASYNC_DEPTH];
+}
+
+
+void spi_async_init1(void){
+   spi_async_init(SPI_ID_1, &SpiAsync1);
+}
+
+void spi_async_init2(void){
+   spi_async_init(SPI_ID_2, &SpiAsync2);
+}
+
+SPI_TOKEN spi_write1_async( uint8_t Val){
+   return spi_async_write(SPI_ID_1, &SpiAsync1, Val);
+}
+
+SPI_TOKEN spi_write2_async( uint8_t Val){
+   return spi_async_write(SPI_ID_2, &SpiAsync2, Val);
+}
+
+SPI_TOKEN spi_read1_async( uint8_t Val){
+   return spi_async_write(SPI_ID_1, &SpiAsync1, Val);
+}
+
+SPI_TOKEN spi_read2_async( uint8_t Val){
+   return spi_async_write(SPI_ID_2, &SpiAsync2, Val);
 }
 
+bool spi_done1( SPI_TOKEN Token){
+   return spi_async_done(SPI_ID_1, &SpiAsync1, Token);
+}
 
+bool spi_done2( SPI_TOKEN Token){
+   return spi_async_done(SPI_ID_2, &SpiAsync2, Token);
+}
+
+uint8_t spi_wait1( SPI_TOKEN Token){
+   return spi_async_wait(SPI_ID_1, &SpiAsync1, Token);
+}
+
+uint8_t spi_wait2( SPI_TOKEN Token){
+   return spi_async_wait(SPI_ID_2, &SpiAsync2, Token);
+}
+
+// Attend la fin de tous les octets en vol (avant de relcher le CS)
+void spi_flush1(void){
+   if (SpiAsync1.TxCount != SpiAsync1.RxCount)
+      spi_async_wait(SPI_ID_1, &SpiAsync1, SpiAsync1.TxCount - 1);
+}
+
+void spi_flush2(void){
+   if (SpiAsync2.TxCount != SpiAsync2.RxCount)
+      spi_async_wait(SPI_ID_2, &SpiAsync2, SpiAsync2.TxCount - 1);
+}
 
+
+// Fonctions CCS like sur le buffer tendu
+// L'criture place l'octet dans le fifo et n'attend que s'il est plein,
+// les octets en vol sont vids par la lecture suivante ou spi_flushX.
+// La lecture attend son propre octet (donc aussi les critures en vol)
+// et ne retourne jamais un octet laiss dans le fifo par une criture.
+
+void spi_write1( uint8_t Val){
+   spi_write1_async(Val);
+}
+
+void spi_write2( uint8_t Val){
+   spi_write2_async(Val);
+}
+
+uint8_t spi_read1( uint8_t Val){
+   return spi_wait1(spi_read1_async(Val));
+}
+
+uint8_t spi_read2( uint8_t Val){
+   return spi_wait2(spi_read2_async(Val));
+}
@@ -14,6 +14,18 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
+
+// spi_writeX et les fonctions _async rendent la main ds que l'octet est
+// dans le fifo (attente seulement si 16 octets sont en vol).
+// spi_readX attend son octet, donc aussi les critures prcdentes.
+// Aprs une suite d'critures seules, appeler spi_flushX avant de
+// relcher le CS.
+// Le buffer tendu est activ au premier appel (ou par spi_async_initX)
+
+// Jeton d'un octet transmis, son rsultat reste disponible
+// jusqu' la rception des 16 octets suivants
+typedef uint32_t SPI_TOKEN;
 
 
 // prototypes des fonctions
@@ -22,4 +34,18 @@ void spi_write2( uint8_t Val);
 uint8_t spi_read1( uint8_t Val);
 uint8_t spi_read2( uint8_t Val);
 
+// prototypes des fonctions non bloquantes
+void spi_async_init1(void);
+void spi_async_init2(void);
+SPI_TOKEN spi_write1_async( uint8_t Val);
+SPI_TOKEN spi_write2_async( uint8_t Val);
+SPI_TOKEN spi_read1_async( uint8_t Val);
+SPI_TOKEN spi_read2_async( uint8_t Val);
+bool spi_done1( SPI_TOKEN Token);
+bool spi_done2( SPI_TOKEN Token);
+uint8_t spi_wait1( SPI_TOKEN Token);
+uint8_t spi_wait2( SPI_TOKEN Token);
+void spi_flush1(void);
+void spi_flush2(void);
+
 #endif
@@ -0,0 +1,143 @@
+//--------------------------------------------------------
+// Mc32gestSpiLm70_SM.C
+//--------------------------------------------------------
+// Gestion SPI du capteur de temprature LM70
+//	Description :	Fonctions pour machine tat du LM70
+//
+//      Date            :       17.10.2026
+//	Version		:	V1.0
+//	Compilateur	:	XC32 V1.40 & Harmony 1_06
+//
+// La lecture d'une trame de 16 bits est confie  la queue de SPI_SM,
+// la machine d'tat ne fait que la relancer et convertir le rsultat.
+//----------------------------------------------------------
+
+#include "Mc32gestSpiLM70_SM.h"
+#include "SPI_SM.h"
+
+// Dfinition pour LM70 (CS_LM70 = RD3)
+#define lm70_cs_channel  PORTS_CHANNEL_D
+#define lm70_cs_bit_pos  PORTS_BIT_POS_3
+#define lm70_freq        5000000      // SCK max 6.25 MHz
+
+// Trame : D15..D5 temprature (complment  2), D4..D0  1
+#define lm70_temp_shift  5
+#define lm70_lsb_milli   250          // bit poid faible = 0.25 degr
+
+//--------------------------------------------------------
+// SPI_LM70_SM_Init
+// Initialisation mcanisme SM du LM70
+// --------------------------------------------------------
+
+void SPI_LM70_SM_Init(S_Descr_LM70_SM *pDescr, S_SPI_SM_DESCR *pSpi)
+{
+   pDescr->Lm70state = LM70_SM_Idle;
+   pDescr->pSpi = pSpi;
+
+   // Une trame de 16 bits, un seul accs au fifo
+   pDescr->Device.CsChannel = lm70_cs_channel;
+   pDescr->Device.CsBitPos = lm70_cs_bit_pos;
+   pDescr->Device.BaudRate = lm70_freq;
+   pDescr->Device.ClockPolarity = SPI_CLOCK_POLARITY_IDLE_LOW;
+   pDescr->Device.DataPhase = SPI_OUTPUT_DATA_PHASE_ON_IDLE_TO_ACTIVE_CLOCK;
+   pDescr->Device.Width = SPI_COMMUNICATION_WIDTH_16BITS;
+   pDescr->Device.ByteOrder = SPI_BYTE_ORDER_MSB_FIRST;
+
+   // Lecture seule, le LM70 ne reoit que des octets bidons
+   pDescr->Job.pDevice = &pDescr->Device;
+   pDescr->Job.nBytes = sizeof(pDescr->Frame);
+   pDescr->Job.pBytesToWrite = NULL;
+   pDescr->Job.pBytesRead = pDescr->Frame;
+   pDescr->Job.Callback = NULL;
+   pDescr->Job.pDone = &pDescr->FrameDone;
+
+   pDescr->FrameDone = false;
+   pDescr->NewSample = false;
+   pDescr->RawTemp = 0;
+   pDescr->TempMilli = 0;
+   pDescr->SampleIndex = 0;
+   pDescr->NbSamples = 0;
+}
+
+// --------------------
+// SPI_LM70_SM_IsReady
+//
+// Vrai si une mesure n'a pas encore t lue
+
+bool SPI_LM70_SM_IsReady(S_Descr_LM70_SM *pDescr) {
+    return pDescr->NewSample;
+}
+
+// Execution de la lecture de la temprature du LM70
+// Prvu pour appel cyclique, les lectures s'enchanent
+void SPI_LM70_SM_Execute(S_Descr_LM70_SM *pDescr)
+{
+    int16_t RawTemp;
+
+    switch ( pDescr->Lm70state )  {
+        case  LM70_SM_Idle :
+            // Place la lecture dans la queue, ressaie si elle est pleine
+            pDescr->FrameDone = false;
+            if (SPI_SM_QueueSubmit(pDescr->pSpi, &pDescr->Job)) {
+                pDescr->Lm70state = LM70_SM_Busy;
+            }
+        break;
+
+        case  LM70_SM_Busy :
+            if (pDescr->FrameDone) {
+                // Effectue les calculs des tempratures (entiers)
+                RawTemp = pDescr->Frame[0];
+                RawTemp = RawTemp << 8;
+                RawTemp = RawTemp | pDescr->Frame[1];
+                pDescr->RawTemp = RawTemp;
+                RawTemp = RawTemp >> lm70_temp_shift;   // dcalage sign
+                pDescr->TempMilli = (int32_t)RawTemp * lm70_lsb_milli;
+
+                // Mmorise dans le buffer circulaire
+                pDescr->Samples[pDescr->SampleIndex] = pDescr->TempMilli;
+                pDescr->SampleIndex = (pDescr->SampleIndex + 1) % LM70_NB_SAMPLES;
+                if (pDescr->NbSamples < LM70_NB_SAMPLES) {
+                    pDescr->NbSamples++;
+                }
+                pDescr->NewSample = true;
+
+                // Relance aussitt la lecture suivante
+                pDescr->Lm70state = LM70_SM_Idle;
+            }
+        break;
+    }
+
+} // end SPI_LM70_SM_Execute
+
+
+int32_t SPI_LM70_SM_GetTempMilli(S_Descr_LM70_SM *pDescr) {
+    pDescr->NewSample = false;
+    return pDescr->TempMilli;
+}
+
+int16_t SPI_LM70_SM_GetRawTemp(S_Descr_LM70_SM *pDescr) {
+    return pDescr->RawTemp;
+}
+
+// --------------------
+// SPI_LM70_SM_GetSamples
+//
+// Copie les dernires mesures [mC], la plus rcente en premier
+// Retourne le nombre de mesures copies
+
+uint8_t SPI_LM70_SM_GetSamples(S_Descr_LM70_SM *pDescr, int32_t *pSamples, uint8_t NbMax) {
+    uint8_t Nb;
+    uint8_t Index = pDescr->SampleIndex;
+    uint8_t i;
+
+    Nb = pDescr->NbSamples;
+    if (Nb > NbMax) {
+        Nb = NbMax;
+    }
+
+    for (i = 0; i < Nb; i++) {
+        Index = (Index + LM70_NB_SAMPLES - 1) % LM70_NB_SAMPLES;
+        pSamples[i] = pDescr->Samples[Index];
+    }
+    return Nb;
+}
@@ -0,0 +1,70 @@
+#ifndef Mc32GestSpiLM70_SM_H
+#define Mc32GestSpiLM70_SM_H
+//----------------------------------------------------------
+// Mc32GestSpiLM70_SM.h
+//----------------------------------------------------------
+//	Description :	Gestion par SPI du capteur temperature LM70 du Kit
+//                      Version State Machine sur SPI_SM
+//	Version		:	V1.0    17.10.2026
+//	Compilateur	:	XC32 V1.40
+//
+//----------------------------------------------------------
+//
+// Principe utilisation :
+// ----------------------
+//
+// a) dclarer un descripteur
+//
+// b) appeler SPI_LM70_SM_Init avec &Descripteur et le descripteur SPI_SM
+//    (SPI_Init ou SPI_SM_Init dj effectu)
+//
+// c) Appeler cycliquement (Cycle rapide ncessaire)
+//    SPI_LM70_SM_Execute avec &Descripteur
+//    Les lectures s'enchanent sans attente de l'utilisateur
+//
+// d) Obtention des rsultat (Test dans cycle lents)
+//    if (SPI_LM70_SM_IsReady(&Descr) == true) {
+//        // Obtention de la temprature (efface IsReady)
+//        int32_t MyTemp = SPI_LM70_SM_GetTempMilli(&Descr);
+//    }
+//    Les LM70_NB_SAMPLES dernires mesures sont disponibles
+//    par SPI_LM70_SM_GetSamples
+//----------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "SPI_SM.h"
+
+// Nombre de mesures conserves
+#define LM70_NB_SAMPLES 8
+
+// enumeration  Etat principal
+typedef enum { LM70_SM_Idle, LM70_SM_Busy} E_LM70_state;
+
+// Descripteur LM70 pour traitement par machine d'tat
+typedef struct {
+    E_LM70_state Lm70state;         // Etat principal
+    S_SPI_SM_DESCR *pSpi;           // Descripteur SPI_SM utilis
+    S_SPI_DEVICE Device;            // CS et rglages SPI du LM70
+    S_SPI_JOB Job;                  // Lecture d'une trame
+    uint8_t Frame[2];               // trame reue, MSB en premier
+    volatile bool FrameDone;        // fin de lecture de la trame
+    bool NewSample;                 // mesure pas encore lue
+    int16_t RawTemp;                // valeur brute registre temprature
+    int32_t TempMilli;              // temprature en millime de degr
+    int32_t Samples[LM70_NB_SAMPLES]; // dernires mesures [mC]
+    uint8_t SampleIndex;            // prochaine place dans Samples
+    uint8_t NbSamples;              // nombre de mesures dans Samples
+} S_Descr_LM70_SM;
+
+// prototypes des fonctions
+void SPI_LM70_SM_Init(S_Descr_LM70_SM *pDescr, S_SPI_SM_DESCR *pSpi);
+void SPI_LM70_SM_Execute(S_Descr_LM70_SM *pDescr);
+bool SPI_LM70_SM_IsReady(S_Descr_LM70_SM *pDescr);
+
+int32_t SPI_LM70_SM_GetTempMilli(S_Descr_LM70_SM *pDescr);
+int16_t SPI_LM70_SM_GetRawTemp(S_Descr_LM70_SM *pDescr);
+uint8_t SPI_LM70_SM_GetSamples(S_Descr_LM70_SM *pDescr, int32_t *pSamples, uint8_t NbMax);
+
+#endif
@@ -18,21 +18,28 @@
  * Only peoples mentionned in Readme.md contributed to this code
  * 
  * @creation 20.05.2023
- * @lastmodif 20.05.2023
+ * @lastmodif 17.10.2026
  * 
  ******************************************************************************/
 
+#include <string.h>
+#include <xc.h>                 // pour _CP0_GET_COUNT()
 #include "SPI_SM.h"
 #include "peripheral/spi/plib_spi.h"
+#include "peripheral/ports/plib_ports.h"
+#include "peripheral/int/plib_int.h"
+#include "peripheral/dma/plib_dma.h"
+#include "sys/kmem.h"           // pour KVA_TO_PA()
 #include "system/clk/sys_clk.h" // pour SYS_CLK_PeripheralFrequencyGet()
 
 /*****************************************************************************/
 
-/* Select which SPI to use */
+/* Select which SPI to use with SPI_Init */
 #define SPI_ID SPI_ID_1
 
-/* Select peripheral CS */
-#define SPI_CS CS_LM70
+/* Select peripheral CS (CS_LM70 = RD3) */
+#define SPI_CS_CHANNEL  PORTS_CHANNEL_D
+#define SPI_CS_BIT_POS  PORTS_BIT_POS_3
 
 /* Select SPI frequency to use */
 #define SPI_FREQ 5000000
@@ -41,10 +48,1258 @@
  * to shift peripheric internal register */
 #define DUMMY_BYTE  0x81
 
+/* Transfers advanced by the SPI interrupt, for every module
+ * Uncomment only once the application provides the __ISR of each
+ * used SPI vector calling SPI_SM_InterruptHandler (see SPI_SM.h),
+ * otherwise transfers are advanced by SPI_DoTasks() */
+// #define SPI_USE_INTERRUPT
+
+/* Priority must match the ipl of the __ISR declaration */
+#define SPI_INT_PRIORITY    INT_PRIORITY_LEVEL3
+
+/* Bulk transfers by DMA with SPI_StartDma()
+ * Uncomment to use them, two DMA channels per SPI module are then
+ * claimed (SPI_DMA_CHANNEL_TX / RX) */
+// #define SPI_USE_DMA
+
+/* DMA channels used with SPI_Init, two per SPI module */
+#define SPI_DMA_CHANNEL_TX      DMA_CHANNEL_0
+#define SPI_DMA_CHANNEL_RX      DMA_CHANNEL_1
+
+/* Measures of transfers times and passes, see SPI_SM_StatsReport
+ * Uncomment to fill them */
+// #define SPI_SM_STATS
+
+#ifdef SPI_SM_STATS
+#include <stdio.h>              // pour snprintf() de SPI_SM_StatsReport
+#endif
+
+/* Enhanced buffer depth [bytes], 16 words of 8 bits down to 4 of 32 bits */
+#define SPI_FIFO_DEPTH  16
+
+/*****************************************************************************/
+
+/* Descriptor used by SPI_Init, SPI_DoTasks, ... */
+S_SPI_SM_DESCR DescrSpi;
+
+/* Configuration used by SPI_Init */
+static const S_SPI_SM_CONFIG spiDefaultConfig =
+{
+    {
+        SPI_CS_CHANNEL,
+        SPI_CS_BIT_POS,
+        SPI_FREQ,
+        SPI_CLOCK_POLARITY_IDLE_LOW,
+        SPI_OUTPUT_DATA_PHASE_ON_IDLE_TO_ACTIVE_CLOCK,
+        SPI_COMMUNICATION_WIDTH_8BITS,
+        SPI_BYTE_ORDER_MSB_FIRST,
+    },
+    SPI_DMA_CHANNEL_TX,
+    SPI_DMA_CHANNEL_RX,
+    SPI_INT_PRIORITY,
+};
+
+/* Interrupt sources and vectors of DMA channels */
+static const INT_SOURCE spiDmaIntSource[] =
+{
+    INT_SOURCE_DMA_0, INT_SOURCE_DMA_1, INT_SOURCE_DMA_2, INT_SOURCE_DMA_3,
+    INT_SOURCE_DMA_4, INT_SOURCE_DMA_5, INT_SOURCE_DMA_6, INT_SOURCE_DMA_7,
+};
+
+#if defined(SPI_USE_DMA) && defined(SPI_USE_INTERRUPT)
+static const INT_VECTOR spiDmaIntVector[] =
+{
+    INT_VECTOR_DMA0, INT_VECTOR_DMA1, INT_VECTOR_DMA2, INT_VECTOR_DMA3,
+    INT_VECTOR_DMA4, INT_VECTOR_DMA5, INT_VECTOR_DMA6, INT_VECTOR_DMA7,
+};
+#endif
+
+/*****************************************************************************/
+
+static void SPI_QueueRun(S_SPI_SM_DESCR* pDescr);
+
+/*****************************************************************************/
+
+/**
+ * SPI_WordSize
+ * 
+ * @param Width : SPI communication width
+ * @return Bytes per word
+ */
+static uint8_t SPI_WordSize(SPI_COMMUNICATION_WIDTH Width)
+{
+    uint8_t Size = 1;
+
+    if(Width == SPI_COMMUNICATION_WIDTH_32BITS)
+        Size = 4;
+    else if(Width == SPI_COMMUNICATION_WIDTH_16BITS)
+        Size = 2;
+
+    return Size;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SetResources
+ * 
+ * Interrupt source, vector and DMA triggers matching the SPI module
+ * 
+ * @param pDescr : Descriptor to fill
+ * @param SpiId : SPI module
+ */
+static void SPI_SetResources(S_SPI_SM_DESCR* pDescr, SPI_MODULE_ID SpiId)
+{
+    pDescr->SpiId = SpiId;
+
+    switch(SpiId)
+    {
+        case SPI_ID_2 :
+            pDescr->IntSourceRx = INT_SOURCE_SPI_2_RECEIVE;
+            pDescr->IntVector = INT_VECTOR_SPI2;
+            pDescr->DmaTriggerTx = DMA_TRIGGER_SPI_2_TRANSMIT;
+            pDescr->DmaTriggerRx = DMA_TRIGGER_SPI_2_RECEIVE;
+            break;
+        case SPI_ID_3 :
+            pDescr->IntSourceRx = INT_SOURCE_SPI_3_RECEIVE;
+            pDescr->IntVector = INT_VECTOR_SPI3;
+            pDescr->DmaTriggerTx = DMA_TRIGGER_SPI_3_TRANSMIT;
+            pDescr->DmaTriggerRx = DMA_TRIGGER_SPI_3_RECEIVE;
+            break;
+        case SPI_ID_4 :
+            pDescr->IntSourceRx = INT_SOURCE_SPI_4_RECEIVE;
+            pDescr->IntVector = INT_VECTOR_SPI4;
+            pDescr->DmaTriggerTx = DMA_TRIGGER_SPI_4_TRANSMIT;
+            pDescr->DmaTriggerRx = DMA_TRIGGER_SPI_4_RECEIVE;
+            break;
+        default :
+            pDescr->IntSourceRx = INT_SOURCE_SPI_1_RECEIVE;
+            pDescr->IntVector = INT_VECTOR_SPI1;
+            pDescr->DmaTriggerTx = DMA_TRIGGER_SPI_1_TRANSMIT;
+            pDescr->DmaTriggerRx = DMA_TRIGGER_SPI_1_RECEIVE;
+            break;
+    }
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_ConfigureDevice
+ * 
+ * Write device settings in SPI registers
+ * SPI is stopped during the change
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pDevice : Settings to write
+ */
+static void SPI_ConfigureDevice(S_SPI_SM_DESCR* pDescr, const S_SPI_DEVICE* pDevice)
+{
+    SPI_MODULE_ID SpiId = pDescr->SpiId;
+
+    PLIB_SPI_Disable(SpiId);
+    PLIB_SPI_CommunicationWidthSelect(SpiId, pDevice->Width);
+    PLIB_SPI_BaudRateSet(SpiId, SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1), pDevice->BaudRate);
+    PLIB_SPI_ClockPolaritySelect(SpiId, pDevice->ClockPolarity);
+    PLIB_SPI_OutputDataPhaseSelect(SpiId, pDevice->DataPhase);
+    PLIB_SPI_Enable(SpiId);
+
+    pDescr->ActiveSettings = *pDevice;
+    pDescr->WordSize = SPI_WordSize(pDevice->Width);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SelectDevice
+ * 
+ * Select the device for next transfer
+ * SPI registers are only written when settings differ
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pDevice : Device to talk to
+ */
+static void SPI_SelectDevice(S_SPI_SM_DESCR* pDescr, const S_SPI_DEVICE* pDevice)
+{
+    const S_SPI_DEVICE* pActive = &pDescr->ActiveSettings;
+
+    if((pDevice->BaudRate != pActive->BaudRate) ||
+       (pDevice->ClockPolarity != pActive->ClockPolarity) ||
+       (pDevice->DataPhase != pActive->DataPhase) ||
+       (pDevice->Width != pActive->Width))
+    {
+        SPI_ConfigureDevice(pDescr, pDevice);
+    }
+
+    pDescr->pDevice = pDevice;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_ResetRings
+ * 
+ * Empty both ring buffers before a new transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_ResetRings(S_SPI_SM_DESCR* pDescr)
+{
+    pDescr->TxRing.Head = 0;
+    pDescr->TxRing.Tail = 0;
+    pDescr->RxRing.Head = 0;
+    pDescr->RxRing.Tail = 0;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_StatsStart
+ * 
+ * Note start time and size of a transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer
+ */
+static void SPI_StatsStart(S_SPI_SM_DESCR* pDescr, uint32_t nBytes)
+{
+#ifdef SPI_SM_STATS
+    pDescr->Stats.StartTick = _CP0_GET_COUNT();
+    pDescr->Stats.StartBytes = nBytes;
+#else
+    (void)pDescr;
+    (void)nBytes;
+#endif
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_StatsEnd
+ * 
+ * Account the time and size of the ended transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_StatsEnd(S_SPI_SM_DESCR* pDescr)
+{
+#ifdef SPI_SM_STATS
+    S_SPI_SM_STATS* pStats = &pDescr->Stats;
+    uint32_t Ticks = _CP0_GET_COUNT() - pStats->StartTick;
+
+    pStats->Transfers++;
+    pStats->Bytes += pStats->StartBytes;
+    pStats->TicksTotal += Ticks;
+    pStats->TicksLast = Ticks;
+    if(Ticks > pStats->TicksMax)
+        pStats->TicksMax = Ticks;
+#else
+    (void)pDescr;
+#endif
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_EndTransfer
+ * 
+ * Release CS, update state and signal the end of transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_EndTransfer(S_SPI_SM_DESCR* pDescr)
+{
+    SPI_CALLBACK JobCallback;
+
+#ifdef SPI_USE_INTERRUPT
+    PLIB_INT_SourceDisable(INT_ID_0, pDescr->IntSourceRx);
+#endif
+
+    PLIB_PORTS_PinSet(PORTS_ID_0, pDescr->pDevice->CsChannel, pDescr->pDevice->CsBitPos);
+    SPI_StatsEnd(pDescr);
+
+    /* Nothing left to read in the reception ring buffer */
+    if(pDescr->RxDiscard || (pDescr->pRx != NULL))
+        pDescr->State = SPI_STATE_IDLE;
+    else
+        pDescr->State = SPI_STATE_IDLE_READ_DATA_AVAILABLE;
+
+    JobCallback = pDescr->JobCallback;
+    pDescr->JobCallback = NULL;
+
+    if(pDescr->pJobDone != NULL)
+    {
+        *pDescr->pJobDone = true;
+        pDescr->pJobDone = NULL;
+    }
+
+    if(JobCallback != NULL)
+        JobCallback(pDescr->State);
+
+    if(pDescr->Callback != NULL)
+        pDescr->Callback(pDescr->State);
+
+    /* Next job back to back */
+    SPI_QueueRun(pDescr);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_NextTxByte
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Next byte to send from stream, ring buffer or dummy
+ */
+static uint8_t SPI_NextTxByte(S_SPI_SM_DESCR* pDescr)
+{
+    uint8_t TxByte;
+
+    if(pDescr->pTx != NULL)
+        TxByte = *pDescr->pTx++;
+    else if(pDescr->TxRing.Head != pDescr->TxRing.Tail)
+        TxByte = pDescr->TxRing.Data[pDescr->TxRing.Tail++];
+    else
+        TxByte = DUMMY_BYTE;
+
+    return TxByte;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_PutRxByte
+ * 
+ * Store a received byte in stream or ring buffer
+ * Datas received while writing are not considered
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param RxByte : Byte received
+ */
+static void SPI_PutRxByte(S_SPI_SM_DESCR* pDescr, uint8_t RxByte)
+{
+    if(!pDescr->RxDiscard)
+    {
+        if(pDescr->pRx != NULL)
+            *pDescr->pRx++ = RxByte;
+        else
+            pDescr->RxRing.Data[pDescr->RxRing.Head++] = RxByte;
+    }
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_ServiceFifo
+ * 
+ * Drain the reception FIFO then refill the transmission FIFO
+ * Words in flight never exceed what the reception FIFO can hold
+ * Bytes of words are taken and stored in the byte order of the device
+ * Called by the interrupt or by SPI_SM_DoTasks
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_ServiceFifo(S_SPI_SM_DESCR* pDescr)
+{
+    SPI_MODULE_ID SpiId = pDescr->SpiId;
+    uint8_t WordSize = pDescr->WordSize;
+    bool LsbFirst = (pDescr->pDevice->ByteOrder == SPI_BYTE_ORDER_LSB_FIRST);
+    uint32_t Word;
+    uint8_t iByte;
+
+#ifdef SPI_SM_STATS
+    pDescr->Stats.FifoServices++;
+#endif
+
+    while((pDescr->RxPending > 0) && !PLIB_SPI_ReceiverFIFOIsEmpty(SpiId))
+    {
+        switch(WordSize)
+        {
+            case 4 :
+                Word = PLIB_SPI_BufferRead32bit(SpiId);
+                break;
+            case 2 :
+                Word = PLIB_SPI_BufferRead16bit(SpiId);
+                break;
+            default :
+                Word = PLIB_SPI_BufferRead(SpiId);
+                break;
+        }
+
+        if(LsbFirst)
+        {
+            for( iByte = 0 ; iByte < WordSize ; iByte++ )
+                SPI_PutRxByte(pDescr, (uint8_t)(Word >> (8 * iByte)));
+        }
+        else
+        {
+            for( iByte = WordSize ; iByte > 0 ; iByte-- )
+                SPI_PutRxByte(pDescr, (uint8_t)(Word >> (8 * (iByte - 1))));
+        }
+
+        pDescr->RxPending--;
+    }
+
+    while((pDescr->TxPending > 0) &&
+          ((pDescr->RxPending - pDescr->TxPending) < (SPI_FIFO_DEPTH / WordSize)) &&
+          !PLIB_SPI_TransmitBufferIsFull(SpiId))
+    {
+        Word = 0;
+        if(LsbFirst)
+        {
+            for( iByte = 0 ; iByte < WordSize ; iByte++ )
+                Word |= (uint32_t)SPI_NextTxByte(pDescr) << (8 * iByte);
+        }
+        else
+        {
+            for( iByte = 0 ; iByte < WordSize ; iByte++ )
+                Word = (Word << 8) | SPI_NextTxByte(pDescr);
+        }
+
+        switch(WordSize)
+        {
+            case 4 :
+                PLIB_SPI_BufferWrite32bit(SpiId, Word);
+                break;
+            case 2 :
+                PLIB_SPI_BufferWrite16bit(SpiId, (uint16_t)Word);
+                break;
+            default :
+                PLIB_SPI_BufferWrite(SpiId, (uint8_t)Word);
+                break;
+        }
+
+        pDescr->TxPending--;
+    }
+
+    if(pDescr->RxPending == 0)
+        SPI_EndTransfer(pDescr);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_StartTransfer
+ * 
+ * Common start of every transfer
+ * Engine buffers must be set up by the caller
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer
+ * @param BusyState : State during transfer
+ */
+static void SPI_StartTransfer(S_SPI_SM_DESCR* pDescr, uint32_t nBytes,
+                              SPI_STATES BusyState)
+{
+    pDescr->TxPending = nBytes / pDescr->WordSize;
+    pDescr->RxPending = nBytes / pDescr->WordSize;
+    pDescr->State = BusyState;
+
+    SPI_StatsStart(pDescr, nBytes);
+    PLIB_PORTS_PinClear(PORTS_ID_0, pDescr->pDevice->CsChannel, pDescr->pDevice->CsBitPos);
+
+    /* Prime FIFO, following bytes are pushed as received ones come back */
+    SPI_ServiceFifo(pDescr);
+
+#ifdef SPI_USE_INTERRUPT
+    if(pDescr->RxPending > 0)
+        PLIB_INT_SourceEnable(INT_ID_0, pDescr->IntSourceRx);
+#endif
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_StartBuffered
+ * 
+ * Start of read, write and read/write through the ring buffers
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param BusyState : State during transfer
+ */
+static void SPI_StartBuffered(S_SPI_SM_DESCR* pDescr, uint8_t nBytes,
+                              uint8_t* pBytesToWrite, SPI_STATES BusyState)
+{
+    uint8_t iData = 0;
+
+    /* Only whole words are transferred */
+    if((nBytes % SPI_WordSize(pDescr->DefaultDevice.Width)) != 0)
+        return;
+
+    SPI_ResetRings(pDescr);
+
+    /* Copy datas, caller buffer is free at return */
+    if(pBytesToWrite != NULL)
+    {
+        for( iData = 0 ; iData < nBytes ; iData++ )
+            pDescr->TxRing.Data[pDescr->TxRing.Head++] = *(pBytesToWrite + iData);
+    }
+
+    pDescr->pTx = NULL;
+    pDescr->pRx = NULL;
+    pDescr->RxDiscard = (BusyState == SPI_STATE_BUSY_WRITE);
+
+    SPI_SelectDevice(pDescr, &pDescr->DefaultDevice);
+    SPI_StartTransfer(pDescr, nBytes, BusyState);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_QueueRun
+ * 
+ * Start the next queued job if the bus is free
+ * Called from SPI_SM_DoTasks, at end of transfer and at submission
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_QueueRun(S_SPI_SM_DESCR* pDescr)
+{
+    S_SPI_JOB* pJob;
+    unsigned int IntState;
+
+    /* Nothing queued, no need to lock */
+    if(pDescr->QueueHead == pDescr->QueueTail)
+        return;
+
+    /* Queue is shared with interrupts */
+    IntState = __builtin_get_isr_state();
+    __builtin_disable_interrupts();
+
+    if((pDescr->State == SPI_STATE_IDLE) && (pDescr->QueueHead != pDescr->QueueTail))
+    {
+        pJob = &pDescr->Queue[pDescr->QueueTail % SPI_SM_QUEUE_SIZE];
+        pDescr->QueueTail++;
+
+        SPI_ResetRings(pDescr);
+
+        pDescr->pTx = pJob->pBytesToWrite;
+        pDescr->pRx = pJob->pBytesRead;
+        pDescr->RxDiscard = (pJob->pBytesRead == NULL);
+        pDescr->JobCallback = pJob->Callback;
+        pDescr->pJobDone = pJob->pDone;
+
+        SPI_SelectDevice(pDescr, pJob->pDevice);
+        SPI_StartTransfer(pDescr, pJob->nBytes, SPI_STATE_BUSY_STREAM);
+    }
+
+    __builtin_set_isr_state(IntState);
+}
+
+/*****************************************************************************/
+
+#ifdef SPI_USE_DMA
+
+/**
+ * SPI_DmaChannelSetup
+ * 
+ * Program one DMA channel for a transfer triggered by the SPI
+ * Cells are one SPI word, the block ends after the biggest size
+ * 
+ * @param Channel : DMA channel to program
+ * @param Trigger : SPI interrupt starting each cell transfer
+ * @param pSource : Source address (virtual)
+ * @param SourceSize : Source size in bytes, 256 at most
+ * @param pDestination : Destination address (virtual)
+ * @param DestinationSize : Destination size in bytes, 256 at most
+ * @param CellSize : Bytes moved at each trigger
+ */
+static void SPI_DmaChannelSetup(DMA_CHANNEL Channel, DMA_TRIGGER_SOURCE Trigger,
+                                const volatile void* pSource, uint16_t SourceSize,
+                                volatile void* pDestination, uint16_t DestinationSize,
+                                uint8_t CellSize)
+{
+    PLIB_DMA_ChannelXDisable(DMA_ID_0, Channel);
+    PLIB_DMA_ChannelXPrioritySelect(DMA_ID_0, Channel, DMA_CHANNEL_PRIORITY_3);
+    PLIB_DMA_ChannelXSourceStartAddressSet(DMA_ID_0, Channel, KVA_TO_PA(pSource));
+    PLIB_DMA_ChannelXSourceSizeSet(DMA_ID_0, Channel, SourceSize);
+    PLIB_DMA_ChannelXDestinationStartAddressSet(DMA_ID_0, Channel, KVA_TO_PA(pDestination));
+    PLIB_DMA_ChannelXDestinationSizeSet(DMA_ID_0, Channel, DestinationSize);
+    PLIB_DMA_ChannelXCellSizeSet(DMA_ID_0, Channel, CellSize);
+    PLIB_DMA_ChannelXStartIRQSet(DMA_ID_0, Channel, Trigger);
+    PLIB_DMA_ChannelXTriggerEnable(DMA_ID_0, Channel, DMA_CHANNEL_TRIGGER_TRANSFER_START);
+    PLIB_DMA_ChannelXINTSourceFlagClear(DMA_ID_0, Channel, DMA_INT_BLOCK_TRANSFER_COMPLETE);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_DmaIsComplete
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return true when every byte is received (or sent when write only)
+ */
+static bool SPI_DmaIsComplete(S_SPI_SM_DESCR* pDescr)
+{
+    bool Complete;
+
+    if(pDescr->RxDiscard)
+    {
+        Complete = PLIB_DMA_ChannelXINTSourceFlagGet(DMA_ID_0, pDescr->DmaChannelTx,
+                                                     DMA_INT_BLOCK_TRANSFER_COMPLETE) &&
+                   PLIB_SPI_TransmitBufferIsEmpty(pDescr->SpiId) &&
+                   !PLIB_SPI_IsBusy(pDescr->SpiId);
+    }
+    else
+    {
+        Complete = PLIB_DMA_ChannelXINTSourceFlagGet(DMA_ID_0, pDescr->DmaChannelRx,
+                                                     DMA_INT_BLOCK_TRANSFER_COMPLETE);
+    }
+
+    return Complete;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_DmaEnd
+ * 
+ * Free the DMA channels and end the transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+static void SPI_DmaEnd(S_SPI_SM_DESCR* pDescr)
+{
+#ifdef SPI_USE_INTERRUPT
+    PLIB_INT_SourceDisable(INT_ID_0, pDescr->DmaIntSourceRx);
+#endif
+
+    PLIB_DMA_ChannelXDisable(DMA_ID_0, pDescr->DmaChannelTx);
+    PLIB_DMA_ChannelXDisable(DMA_ID_0, pDescr->DmaChannelRx);
+    PLIB_DMA_ChannelXINTSourceFlagClear(DMA_ID_0, pDescr->DmaChannelTx, DMA_INT_BLOCK_TRANSFER_COMPLETE);
+    PLIB_DMA_ChannelXINTSourceFlagClear(DMA_ID_0, pDescr->DmaChannelRx, DMA_INT_BLOCK_TRANSFER_COMPLETE);
+
+    /* When writing only, reception FIFO was left to overflow */
+    while(!PLIB_SPI_ReceiverFIFOIsEmpty(pDescr->SpiId))
+        PLIB_SPI_BufferRead(pDescr->SpiId);
+    PLIB_SPI_ReceiverOverflowClear(pDescr->SpiId);
+
+    SPI_EndTransfer(pDescr);
+}
+
+#endif /* SPI_USE_DMA */
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_Init
+ * 
+ * One time call when starting programm, for each SPI module
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param SpiId : SPI module to use (SPI_ID_1 to SPI_ID_4)
+ * @param pConfig : Default device, DMA channels and interrupt priority
+ */
+void SPI_SM_Init(S_SPI_SM_DESCR* pDescr, SPI_MODULE_ID SpiId,
+                 const S_SPI_SM_CONFIG* pConfig)
+{
+    SPI_SetResources(pDescr, SpiId);
+    pDescr->DmaChannelTx = pConfig->DmaChannelTx;
+    pDescr->DmaChannelRx = pConfig->DmaChannelRx;
+    pDescr->DmaIntSourceRx = spiDmaIntSource[pConfig->DmaChannelRx];
+    pDescr->DefaultDevice = pConfig->DefaultDevice;
+    pDescr->pTx = NULL;
+    pDescr->pRx = NULL;
+    pDescr->RxDiscard = false;
+    pDescr->TxPending = 0;
+    pDescr->RxPending = 0;
+    pDescr->Callback = NULL;
+    pDescr->JobCallback = NULL;
+    pDescr->pJobDone = NULL;
+    SPI_ResetRings(pDescr);
+    SPI_SM_StatsReset(pDescr);
+
+	PLIB_SPI_Disable(SpiId);
+	PLIB_SPI_BufferClear(SpiId);
+	PLIB_SPI_StopInIdleDisable(SpiId);
+	PLIB_SPI_PinEnable(SpiId, SPI_PIN_DATA_OUT);
+	PLIB_SPI_InputSamplePhaseSelect(SpiId, SPI_INPUT_SAMPLING_PHASE_IN_MIDDLE );
+	PLIB_SPI_MasterEnable(SpiId);
+	PLIB_SPI_FramedCommunicationDisable(SpiId);
+	PLIB_SPI_FIFOEnable(SpiId);
+
+#ifdef SPI_USE_INTERRUPT
+    /* Interrupt as soon as a byte is received */
+    PLIB_SPI_FIFOInterruptModeSelect(SpiId, SPI_FIFO_INTERRUPT_WHEN_RECEIVE_BUFFER_IS_NOT_EMPTY);
+    PLIB_INT_SourceDisable(INT_ID_0, pDescr->IntSourceRx);
+    PLIB_INT_SourceFlagClear(INT_ID_0, pDescr->IntSourceRx);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, pDescr->IntVector, pConfig->IntPriority);
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, pDescr->IntVector, INT_SUBPRIORITY_LEVEL0);
+#endif
+
+#ifdef SPI_USE_DMA
+    /* Each free place in transmission FIFO and each byte received
+     * trigger a DMA cell transfer */
+    PLIB_SPI_FIFOInterruptModeSelect(SpiId, SPI_FIFO_INTERRUPT_WHEN_TRANSMIT_BUFFER_IS_NOT_FULL);
+    PLIB_SPI_FIFOInterruptModeSelect(SpiId, SPI_FIFO_INTERRUPT_WHEN_RECEIVE_BUFFER_IS_NOT_EMPTY);
+    PLIB_DMA_Enable(DMA_ID_0);
+#ifdef SPI_USE_INTERRUPT
+    PLIB_INT_SourceDisable(INT_ID_0, pDescr->DmaIntSourceRx);
+    PLIB_INT_SourceFlagClear(INT_ID_0, pDescr->DmaIntSourceRx);
+    PLIB_INT_VectorPrioritySet(INT_ID_0, spiDmaIntVector[pConfig->DmaChannelRx], pConfig->IntPriority);
+    PLIB_INT_VectorSubPrioritySet(INT_ID_0, spiDmaIntVector[pConfig->DmaChannelRx], INT_SUBPRIORITY_LEVEL0);
+#endif
+#endif
+
+    /* Width, baud rate and clock mode, SPI is enabled there */
+    PLIB_PORTS_PinSet(PORTS_ID_0, pDescr->DefaultDevice.CsChannel, pDescr->DefaultDevice.CsBitPos);
+    SPI_ConfigureDevice(pDescr, &pDescr->DefaultDevice);
+    pDescr->pDevice = &pDescr->DefaultDevice;
+
+    pDescr->QueueHead = 0;
+    pDescr->QueueTail = 0;
+	pDescr->State = SPI_STATE_IDLE;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_DoTasks
+ * 
+ * State machine handling
+ * Should be call cyclically 
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_DoTasks(S_SPI_SM_DESCR* pDescr)
+{
+#ifdef SPI_SM_STATS
+    if((pDescr->State != SPI_STATE_IDLE) &&
+       (pDescr->State != SPI_STATE_IDLE_READ_DATA_AVAILABLE) &&
+       (pDescr->State != SPI_STATE_UNINITIALIZED))
+    {
+        pDescr->Stats.DoTasksBusy++;
+    }
+#endif
+
+	switch(pDescr->State)
+	{
+		case SPI_STATE_UNINITIALIZED :
+			/* Use SPI_SM_Init() at launch */
+			break;
+			
+		case SPI_STATE_IDLE :
+            /* Waiting for a start or a queued job */
+            SPI_QueueRun(pDescr);
+			break;		
+			
+		case SPI_STATE_BUSY_WRITE :
+		case SPI_STATE_BUSY_READ :	
+		case SPI_STATE_BUSY_READ_WRITE :
+		case SPI_STATE_BUSY_STREAM :
+            
+#ifndef SPI_USE_INTERRUPT
+            SPI_ServiceFifo(pDescr);
+#endif
+            /* Otherwise transfer is advanced by SPI_SM_InterruptHandler */
+			break;
+
+		case SPI_STATE_BUSY_DMA :
+
+#ifdef SPI_USE_DMA
+            /* Transfer is done by DMA, only check the end */
+            if(SPI_DmaIsComplete(pDescr))
+                SPI_DmaEnd(pDescr);
+#endif
+			break;
+			
+		case SPI_STATE_IDLE_READ_DATA_AVAILABLE :
+            
+            /* Use SPI_SM_ReadByte or SPI_SM_ReadBlock to get datas */
+            if (pDescr->RxRing.Head == pDescr->RxRing.Tail)
+                pDescr->State = SPI_STATE_IDLE;
+			break;			
+	} 
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StartRead
+ * 
+ * Write one or multiple dummy bytes
+ * to receive datas back to be read
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ */
+void SPI_SM_StartRead(S_SPI_SM_DESCR* pDescr, uint8_t nBytes)
+{
+    /* Watchdog */
+    if(pDescr->State == SPI_STATE_IDLE)
+        SPI_StartBuffered(pDescr, nBytes, NULL, SPI_STATE_BUSY_READ);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StartWrite
+ * 
+ * Write one or multiple bytes by SPI
+ * datas received back are not considered
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ * @param pBytesToWrite : Pointer to datas to write
+ */
+void SPI_SM_StartWrite(S_SPI_SM_DESCR* pDescr, uint8_t nBytes,
+                       uint8_t* pBytesToWrite)
+{
+    /* Watchdog */
+    if(pDescr->State == SPI_STATE_IDLE)
+        SPI_StartBuffered(pDescr, nBytes, pBytesToWrite, SPI_STATE_BUSY_WRITE);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StartReadWrite
+ * 
+ * Simultaneous write and read
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ * @param pBytesToWrite : Pointer to datas to write
+ */
+void SPI_SM_StartReadWrite(S_SPI_SM_DESCR* pDescr, uint8_t nBytes,
+                           uint8_t* pBytesToWrite)
+{
+    /* Watchdog */
+    if(pDescr->State == SPI_STATE_IDLE)
+        SPI_StartBuffered(pDescr, nBytes, pBytesToWrite, SPI_STATE_BUSY_READ_WRITE);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StartStream
+ * 
+ * Transfer of any length, FIFO is topped up as it drains
+ * Buffers are used in place and must stay valid until the end
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_SM_StartStream(S_SPI_SM_DESCR* pDescr, uint32_t nBytes,
+                        const uint8_t* pBytesToWrite, uint8_t* pBytesRead)
+{
+    bool Started = false;
+
+    /* Watchdog, only whole words are transferred */
+    if((pDescr->State == SPI_STATE_IDLE) &&
+       ((nBytes % SPI_WordSize(pDescr->DefaultDevice.Width)) == 0))
+    {
+        /* Ring buffers left empty, dummy bytes sent if no datas */
+        SPI_ResetRings(pDescr);
+
+        pDescr->pTx = pBytesToWrite;
+        pDescr->pRx = pBytesRead;
+        pDescr->RxDiscard = (pBytesRead == NULL);
+
+        SPI_SelectDevice(pDescr, &pDescr->DefaultDevice);
+        SPI_StartTransfer(pDescr, nBytes, SPI_STATE_BUSY_STREAM);
+        Started = true;
+    }
+
+    return Started;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StartDma
+ * 
+ * Bulk transfer by two DMA channels, CPU is only used for setup
+ * When only reading, pBytesRead is filled with dummy bytes and sent
+ * DMA moves words in memory order, wide words must be LSB first
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_SM_StartDma(S_SPI_SM_DESCR* pDescr, uint16_t nBytes,
+                     const uint8_t* pBytesToWrite, uint8_t* pBytesRead)
+{
+    bool Started = false;
+
+#ifdef SPI_USE_DMA
+    const S_SPI_DEVICE* pDevice = &pDescr->DefaultDevice;
+    uint8_t WordSize = SPI_WordSize(pDevice->Width);
+    uint16_t iData = 0;
+
+    /* Watchdog, only whole words in memory order,
+     * one block as size registers are 8 bits */
+    if((pDescr->State == SPI_STATE_IDLE) && (nBytes > 0) &&
+       (nBytes <= SPI_SM_DMA_MAX_BYTES) && ((nBytes % WordSize) == 0) &&
+       ((WordSize == 1) || (pDevice->ByteOrder == SPI_BYTE_ORDER_LSB_FIRST)) &&
+       ((pBytesToWrite != NULL) || (pBytesRead != NULL)))
+    {
+        /* Each dummy byte is sent before its place receives a byte */
+        if(pBytesToWrite == NULL)
+        {
+            for( iData = 0 ; iData < nBytes ; iData++ )
+                pBytesRead[iData] = DUMMY_BYTE;
+            pBytesToWrite = pBytesRead;
+        }
+
+        pDescr->pTx = pBytesToWrite;
+        pDescr->pRx = pBytesRead;
+        pDescr->RxDiscard = (pBytesRead == NULL);
+        pDescr->TxPending = 0;
+        pDescr->RxPending = 0;
+        pDescr->State = SPI_STATE_BUSY_DMA;
+        SPI_StatsStart(pDescr, nBytes);
+
+        SPI_SelectDevice(pDescr, pDevice);
+        SPI_DmaChannelSetup(pDescr->DmaChannelTx, pDescr->DmaTriggerTx,
+                            pBytesToWrite, nBytes,
+                            PLIB_SPI_BufferAddressGet(pDescr->SpiId), WordSize,
+                            WordSize);
+
+        PLIB_PORTS_PinClear(PORTS_ID_0, pDescr->pDevice->CsChannel, pDescr->pDevice->CsBitPos);
+
+        if(!pDescr->RxDiscard)
+        {
+            SPI_DmaChannelSetup(pDescr->DmaChannelRx, pDescr->DmaTriggerRx,
+                                PLIB_SPI_BufferAddressGet(pDescr->SpiId), WordSize,
+                                pBytesRead, nBytes, WordSize);
+#ifdef SPI_USE_INTERRUPT
+            PLIB_DMA_ChannelXINTSourceEnable(DMA_ID_0, pDescr->DmaChannelRx,
+                                             DMA_INT_BLOCK_TRANSFER_COMPLETE);
+            PLIB_INT_SourceFlagClear(INT_ID_0, pDescr->DmaIntSourceRx);
+            PLIB_INT_SourceEnable(INT_ID_0, pDescr->DmaIntSourceRx);
+#endif
+            PLIB_DMA_ChannelXEnable(DMA_ID_0, pDescr->DmaChannelRx);
+        }
+
+        /* First cell is forced, the following ones are triggered
+         * as the transmission FIFO empties */
+        PLIB_DMA_ChannelXEnable(DMA_ID_0, pDescr->DmaChannelTx);
+        PLIB_DMA_StartTransferSet(DMA_ID_0, pDescr->DmaChannelTx);
+
+        Started = true;
+    }
+#else
+    (void)pDescr;
+    (void)nBytes;
+    (void)pBytesToWrite;
+    (void)pBytesRead;
+#endif
+
+    return Started;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_SetWidth
+ * 
+ * Select word width and byte order of the following SPI_SM_Start*
+ * Registers are written at the start of the next transfer
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param Width : 8, 16 or 32 bits words
+ * @param ByteOrder : Order of bytes of words in buffers
+ * @return true if changed, false if a transfer is running
+ */
+bool SPI_SM_SetWidth(S_SPI_SM_DESCR* pDescr, SPI_COMMUNICATION_WIDTH Width,
+                     SPI_BYTE_ORDER ByteOrder)
+{
+    bool Changed = false;
+
+    /* Watchdog */
+    if(pDescr->State == SPI_STATE_IDLE)
+    {
+        pDescr->DefaultDevice.Width = Width;
+        pDescr->DefaultDevice.ByteOrder = ByteOrder;
+        Changed = true;
+    }
+
+    return Changed;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_QueueSubmit
+ * 
+ * Queue a transfer, jobs are run back to back as soon as the bus is free
+ * The job is copied, its buffers must stay valid until its callback
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pJob : Transfer to queue
+ * @return true if queued, false if queue is full or job is invalid
+ */
+bool SPI_SM_QueueSubmit(S_SPI_SM_DESCR* pDescr, const S_SPI_JOB* pJob)
+{
+    bool Queued = false;
+    unsigned int IntState;
+
+    if((pJob->pDevice != NULL) && (pJob->nBytes > 0) &&
+       ((pJob->nBytes % SPI_WordSize(pJob->pDevice->Width)) == 0))
+    {
+        /* Callbacks may submit from interrupt */
+        IntState = __builtin_get_isr_state();
+        __builtin_disable_interrupts();
+
+        if((uint8_t)(pDescr->QueueHead - pDescr->QueueTail) < SPI_SM_QUEUE_SIZE)
+        {
+            pDescr->Queue[pDescr->QueueHead % SPI_SM_QUEUE_SIZE] = *pJob;
+            pDescr->QueueHead++;
+            Queued = true;
+        }
+
+        __builtin_set_isr_state(IntState);
+    }
+
+    /* Start at once if the bus is free */
+    if(Queued)
+        SPI_QueueRun(pDescr);
+
+    return Queued;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_QueueCount
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Number of jobs waiting in queue
+ */
+uint8_t SPI_SM_QueueCount(S_SPI_SM_DESCR* pDescr)
+{
+    return (uint8_t)(pDescr->QueueHead - pDescr->QueueTail);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_GetState
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Current state of SPI state machine
+ */
+SPI_STATES SPI_SM_GetState(S_SPI_SM_DESCR* pDescr)
+{
+    return pDescr->State;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_UpdateState
+ * 
+ * Update state of SPI SM
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param NewState
+ */
+void SPI_SM_UpdateState(S_SPI_SM_DESCR* pDescr, SPI_STATES NewState)
+{
+    pDescr->State = NewState;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_ReadByte
+ * 
+ * Get the first byte in the SPI buffer
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Byte in reception buffer
+ */
+uint8_t SPI_SM_ReadByte(S_SPI_SM_DESCR* pDescr)
+{
+    uint8_t RxByte = 0;
+
+    if(pDescr->RxRing.Head != pDescr->RxRing.Tail)
+        RxByte = pDescr->RxRing.Data[pDescr->RxRing.Tail++];
+
+    return RxByte;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_BytesAvailable
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Number of bytes waiting in reception buffer
+ */
+uint8_t SPI_SM_BytesAvailable(S_SPI_SM_DESCR* pDescr)
+{
+    return (uint8_t)(pDescr->RxRing.Head - pDescr->RxRing.Tail);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_ReadBlock
+ * 
+ * Get up to n bytes of the SPI buffer in one call
+ * Ring buffer is copied in at most two pieces (before and after wrapping)
+ * State goes back to SPI_STATE_IDLE once the buffer is empty
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pDst : Pointer to store datas
+ * @param n : Maximum number of bytes to get
+ * @return Number of bytes copied
+ */
+size_t SPI_SM_ReadBlock(S_SPI_SM_DESCR* pDescr, uint8_t* pDst, size_t n)
+{
+    uint8_t Tail = pDescr->RxRing.Tail;
+    size_t Available = (uint8_t)(pDescr->RxRing.Head - Tail);
+    size_t Piece;
+
+    if(n > Available)
+        n = Available;
+
+    /* Up to the end of ring buffer */
+    Piece = SPI_SM_RING_SIZE - Tail;
+    if(Piece > n)
+        Piece = n;
+    memcpy(pDst, &pDescr->RxRing.Data[Tail], Piece);
+
+    /* Remaining from the start */
+    memcpy(pDst + Piece, &pDescr->RxRing.Data[0], n - Piece);
+
+    pDescr->RxRing.Tail = (uint8_t)(Tail + n);
+
+    /* No need to wait for SPI_SM_DoTasks */
+    if((pDescr->State == SPI_STATE_IDLE_READ_DATA_AVAILABLE) &&
+       (pDescr->RxRing.Head == pDescr->RxRing.Tail))
+    {
+        pDescr->State = SPI_STATE_IDLE;
+    }
+
+    return n;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_SetCallback
+ * 
+ * Register a function called when a transfer ends
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param Callback : Function to call, NULL to disable
+ */
+void SPI_SM_SetCallback(S_SPI_SM_DESCR* pDescr, SPI_CALLBACK Callback)
+{
+    pDescr->Callback = Callback;
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StatsReset
+ * 
+ * Clear measures, for example before a series of same size transfers
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_StatsReset(S_SPI_SM_DESCR* pDescr)
+{
+    memset(&pDescr->Stats, 0, sizeof(pDescr->Stats));
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_StatsReport
+ * 
+ * Write measures as one CSV line, columns of SPI_SM_STATS_CSV_HEADER
+ * Without SPI_SM_STATS only an empty string is written (no printf code)
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pBuf : Text buffer
+ * @param Size : Size of text buffer
+ * @return Number of characters written, without the final 0
+ */
+size_t SPI_SM_StatsReport(S_SPI_SM_DESCR* pDescr, char* pBuf, size_t Size)
+{
+#ifdef SPI_SM_STATS
+    const S_SPI_SM_STATS* pStats = &pDescr->Stats;
+    int Length;
+
+    Length = snprintf(pBuf, Size, "%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+                      (unsigned long)pStats->Transfers,
+                      (unsigned long)pStats->Bytes,
+                      (unsigned long)pStats->TicksTotal,
+                      (unsigned long)pStats->TicksMax,
+                      (unsigned long)pStats->TicksLast,
+                      (unsigned long)pStats->DoTasksBusy,
+                      (unsigned long)pStats->FifoServices);
+
+    /* Truncated line */
+    if((Length < 0) || ((size_t)Length >= Size))
+        Length = (Size > 0) ? (int)(Size - 1) : 0;
+
+    return (size_t)Length;
+#else
+    (void)pDescr;
+    if(Size > 0)
+        pBuf[0] = '\0';
+    return 0;
+#endif
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SM_InterruptHandler
+ * 
+ * Refill and drain the SPI FIFO from the interrupt
+ * Must be called from the vector of the SPI module
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_InterruptHandler(S_SPI_SM_DESCR* pDescr)
+{
+    SPI_STATES State = pDescr->State;
+
+    if((State == SPI_STATE_BUSY_WRITE) ||
+       (State == SPI_STATE_BUSY_READ) ||
+       (State == SPI_STATE_BUSY_READ_WRITE) ||
+       (State == SPI_STATE_BUSY_STREAM))
+    {
+        SPI_ServiceFifo(pDescr);
+    }
+
+    /* Flag is set again if FIFO still holds datas */
+    PLIB_INT_SourceFlagClear(INT_ID_0, pDescr->IntSourceRx);
+}
+
 /*****************************************************************************/
 
-/* State machine variable */
-SPI_STATES spiState = SPI_STATE_UNINITIALIZED;
+/**
+ * SPI_SM_DmaInterruptHandler
+ * 
+ * End a DMA transfer as soon as the last byte is received
+ * Must be called from the vector of the reception DMA channel
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_DmaInterruptHandler(S_SPI_SM_DESCR* pDescr)
+{
+#if defined(SPI_USE_DMA) && defined(SPI_USE_INTERRUPT)
+    if((pDescr->State == SPI_STATE_BUSY_DMA) && SPI_DmaIsComplete(pDescr))
+        SPI_DmaEnd(pDescr);
+
+    PLIB_INT_SourceFlagClear(INT_ID_0, pDescr->DmaIntSourceRx);
+#else
+    (void)pDescr;
+#endif
+}
 
 /*****************************************************************************/
 
@@ -56,21 +1311,7 @@ SPI_STATES spiState = SPI_STATE_UNINITIALIZED;
  */
 void SPI_Init(void)
 {
-	PLIB_SPI_Disable(SPI_ID);
-	PLIB_SPI_BufferClear(SPI_ID);
-	PLIB_SPI_StopInIdleDisable(SPI_ID);
-	PLIB_SPI_PinEnable(SPI_ID, SPI_PIN_DATA_OUT);
-	PLIB_SPI_CommunicationWidthSelect(SPI_ID, SPI_COMMUNICATION_WIDTH_8BITS);
-	PLIB_SPI_BaudRateSet(SPI_ID, SYS_CLK_PeripheralFrequencyGet(CLK_BUS_PERIPHERAL_1), SPI_FREQ);
-	PLIB_SPI_InputSamplePhaseSelect(SPI_ID, SPI_INPUT_SAMPLING_PHASE_IN_MIDDLE );
-	PLIB_SPI_ClockPolaritySelect(SPI_ID, SPI_CLOCK_POLARITY_IDLE_LOW);
-	PLIB_SPI_OutputDataPhaseSelect(SPI_ID, SPI_OUTPUT_DATA_PHASE_ON_IDLE_TO_ACTIVE_CLOCK);
-	PLIB_SPI_MasterEnable(SPI_ID);
-	PLIB_SPI_FramedCommunicationDisable(SPI_ID);
-	PLIB_SPI_FIFOEnable(SPI_ID);
-	PLIB_SPI_Enable(SPI_ID);
-  
-	spiState = SPI_STATE_IDLE;
+    SPI_SM_Init(&DescrSpi, SPI_ID, &spiDefaultConfig);
 }
 
 /*****************************************************************************/
@@ -83,42 +1324,7 @@ void SPI_Init(void)
  */
 void SPI_DoTasks(void)
 {
-	switch(spiState)
-	{
-		case SPI_STATE_UNINITIALIZED :
-			/* Use SPI_Init() at launch */
-			break;
-			
-		case SPI_STATE_IDLE :
-            /* Waiting for a start */
-			break;		
-			
-		case SPI_STATE_BUSY_WRITE :
-            
-            if(!PLIB_SPI_IsBusy(SPI_ID))
-            {
-                SPI_CS = 1;
-                spiState = SPI_STATE_IDLE;
-            }            
-			break;
-            
-		case SPI_STATE_BUSY_READ :	
-		case SPI_STATE_BUSY_READ_WRITE :
-            
-            if(!PLIB_SPI_IsBusy(SPI_ID) && !PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID))
-            {
-                SPI_CS = 1;
-                spiState = SPI_STATE_IDLE_READ_DATA_AVAILABLE;
-            }            
-			break;
-			
-		case SPI_STATE_IDLE_READ_DATA_AVAILABLE :
-            
-            /* Use SPI_ReadByte to get datas in FIFO */
-            if (PLIB_SPI_ReceiverFIFOIsEmpty(SPI_ID))
-                spiState = SPI_STATE_IDLE;
-			break;			
-	} 
+    SPI_SM_DoTasks(&DescrSpi);
 }
 
 /*****************************************************************************/
@@ -133,18 +1339,7 @@ void SPI_DoTasks(void)
  */
 void SPI_StartRead(uint8_t nBytes)
 {
-    /* Watchdog */
-    if(spiState == SPI_STATE_IDLE)
-    {
-        uint8_t iData = 0;
-
-        SPI_CS = 0;
-
-        for( iData = 0 ; iData < nBytes ; iData++ )
-            PLIB_SPI_BufferWrite(SPI_ID, DUMMY_BYTE);	
-
-        spiState = SPI_STATE_BUSY_READ;
-    }   
+    SPI_SM_StartRead(&DescrSpi, nBytes);
 }
 
 /*****************************************************************************/
@@ -160,18 +1355,7 @@ void SPI_StartRead(uint8_t nBytes)
  */
 void SPI_StartWrite(uint8_t nBytes, uint8_t* pBytesToWrite)
 {
-    /* Watchdog */
-    if(spiState == SPI_STATE_IDLE)
-    {
-        uint8_t iData = 0;
-
-        SPI_CS = 0;
-
-        for( iData = 0 ; iData < nBytes ; iData++ )
-            PLIB_SPI_BufferWrite(SPI_ID, *(pBytesToWrite + iData));	
-
-        spiState = SPI_STATE_BUSY_WRITE;
-    }
+    SPI_SM_StartWrite(&DescrSpi, nBytes, pBytesToWrite);
 }
 
 /*****************************************************************************/
@@ -186,18 +1370,85 @@ void SPI_StartWrite(uint8_t nBytes, uint8_t* pBytesToWrite)
  */
 void SPI_StartReadWrite(uint8_t nBytes, uint8_t* pBytesToWrite)
 {
-    /* Watchdog */
-    if(spiState == SPI_STATE_IDLE)
-    {
-        uint8_t iData = 0;
+    SPI_SM_StartReadWrite(&DescrSpi, nBytes, pBytesToWrite);
+}
 
-        SPI_CS = 0;
-        
-        for( iData = 0 ; iData < nBytes ; iData++ )
-            PLIB_SPI_BufferWrite(SPI_ID, *(pBytesToWrite + iData));	
+/*****************************************************************************/
 
-        spiState = SPI_STATE_BUSY_READ_WRITE;
-    }
+/**
+ * SPI_StartStream
+ * 
+ * Transfer of any length, see SPI_SM_StartStream
+ * 
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_StartStream(uint32_t nBytes, const uint8_t* pBytesToWrite,
+                     uint8_t* pBytesRead)
+{
+    return SPI_SM_StartStream(&DescrSpi, nBytes, pBytesToWrite, pBytesRead);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_StartDma
+ * 
+ * Bulk transfer by DMA, see SPI_SM_StartDma
+ * 
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_StartDma(uint16_t nBytes, const uint8_t* pBytesToWrite,
+                  uint8_t* pBytesRead)
+{
+    return SPI_SM_StartDma(&DescrSpi, nBytes, pBytesToWrite, pBytesRead);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SetWidth
+ * 
+ * Select word width and byte order, see SPI_SM_SetWidth
+ * 
+ * @param Width : 8, 16 or 32 bits words
+ * @param ByteOrder : Order of bytes of words in buffers
+ * @return true if changed, false if a transfer is running
+ */
+bool SPI_SetWidth(SPI_COMMUNICATION_WIDTH Width, SPI_BYTE_ORDER ByteOrder)
+{
+    return SPI_SM_SetWidth(&DescrSpi, Width, ByteOrder);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_QueueSubmit
+ * 
+ * Queue a transfer, see SPI_SM_QueueSubmit
+ * 
+ * @param pJob : Transfer to queue
+ * @return true if queued, false if queue is full or job is invalid
+ */
+bool SPI_QueueSubmit(const S_SPI_JOB* pJob)
+{
+    return SPI_SM_QueueSubmit(&DescrSpi, pJob);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_QueueCount
+ * @return Number of jobs waiting in queue
+ */
+uint8_t SPI_QueueCount(void)
+{
+    return SPI_SM_QueueCount(&DescrSpi);
 }
 
 /*****************************************************************************/
@@ -208,7 +1459,7 @@ void SPI_StartReadWrite(uint8_t nBytes, uint8_t* pBytesToWrite)
  */
 SPI_STATES SPI_GetState(void)
 {
-    return spiState; 
+    return SPI_SM_GetState(&DescrSpi); 
 }
 
 /*****************************************************************************/
@@ -222,7 +1473,7 @@ SPI_STATES SPI_GetState(void)
  */
 void SPI_UpdateState(SPI_STATES NewState)
 {
-    spiState = NewState; 
+    SPI_SM_UpdateState(&DescrSpi, NewState); 
 }
 
 /*****************************************************************************/
@@ -236,7 +1487,74 @@ void SPI_UpdateState(SPI_STATES NewState)
  */
 uint8_t SPI_ReadByte(void)
 {
-    return PLIB_SPI_BufferRead(SPI_ID); 
+    return SPI_SM_ReadByte(&DescrSpi); 
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_BytesAvailable
+ * @return Number of bytes waiting in reception buffer
+ */
+uint8_t SPI_BytesAvailable(void)
+{
+    return SPI_SM_BytesAvailable(&DescrSpi);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_ReadBlock
+ * 
+ * Get up to n bytes of the SPI buffer in one call
+ * 
+ * @param pDst : Pointer to store datas
+ * @param n : Maximum number of bytes to get
+ * @return Number of bytes copied
+ */
+size_t SPI_ReadBlock(uint8_t* pDst, size_t n)
+{
+    return SPI_SM_ReadBlock(&DescrSpi, pDst, n);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_SetCallback
+ * 
+ * Register a function called when a transfer ends
+ * 
+ * @param Callback : Function to call, NULL to disable
+ */
+void SPI_SetCallback(SPI_CALLBACK Callback)
+{
+    SPI_SM_SetCallback(&DescrSpi, Callback);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_InterruptHandler
+ * 
+ * Refill and drain the SPI FIFO from the interrupt
+ * Must be called from the SPI interrupt vector
+ */
+void SPI_InterruptHandler(void)
+{
+    SPI_SM_InterruptHandler(&DescrSpi);
+}
+
+/*****************************************************************************/
+
+/**
+ * SPI_DmaInterruptHandler
+ * 
+ * End a DMA transfer as soon as the last byte is received
+ * Must be called from the reception DMA channel vector
+ */
+void SPI_DmaInterruptHandler(void)
+{
+    SPI_SM_DmaInterruptHandler(&DescrSpi);
 }
 
 /*****************************************************************************/
@@ -11,6 +11,18 @@
  * 
  * Handle SPI by state machine
  * 
+ * Each SPI module is handled by its own descriptor :
+ * 
+ * a) declare a descriptor S_SPI_SM_DESCR
+ * 
+ * b) call SPI_SM_Init with &Descriptor, SPI_ID_x and a configuration
+ * 
+ * c) call SPI_SM_DoTasks cyclically with &Descriptor
+ *    and SPI_SM_InterruptHandler from the SPI vector (interrupt mode)
+ * 
+ * SPI_Init, SPI_DoTasks, ... work on DescrSpi with the #defines
+ * of SPI_SM.c, as before
+ * 
  * @authors
  * 
  * The official version is available at : 
@@ -18,14 +30,29 @@
  * Only peoples mentionned in Readme.md contributed to this code
  * 
  * @creation 20.05.2023
- * @lastmodif 20.05.2023
+ * @lastmodif 17.10.2026
  * 
  ******************************************************************************/
 
 #ifndef SPI_SM_H
 #define SPI_SM_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include "peripheral/spi/plib_spi.h"
+#include "peripheral/ports/plib_ports.h"
+#include "peripheral/int/plib_int.h"
+#include "peripheral/dma/plib_dma.h"
+
+/* Ring buffers size, uint8_t indexes wrap by themselves */
+#define SPI_SM_RING_SIZE    256
+
+/* DMA source and destination sizes are 8 bits on PIC32MX (0 means 256) */
+#define SPI_SM_DMA_MAX_BYTES    256
+
+/* Number of jobs waiting, uint8_t indexes wrap by themselves */
+#define SPI_SM_QUEUE_SIZE   8
 
 /* SPI STATE MACHINE */
 typedef enum
@@ -36,11 +63,392 @@ typedef enum
     SPI_STATE_BUSY_WRITE,        
     SPI_STATE_BUSY_READ_WRITE,
     SPI_STATE_BUSY_READ,
+    SPI_STATE_BUSY_STREAM,
+    SPI_STATE_BUSY_DMA,
 } SPI_STATES;
 
+/* Callback at end of transfer
+ * In interrupt mode it is called from the SPI interrupt */
+typedef void (*SPI_CALLBACK)(SPI_STATES EndState);
+
+/* Order of bytes of 16 and 32 bits words in buffers
+ * MSB first is the order on the wire, as in 8 bits mode
+ * LSB first matches uint16_t and uint32_t arrays (PIC32 is little endian) */
+typedef enum
+{
+    SPI_BYTE_ORDER_MSB_FIRST=0,
+    SPI_BYTE_ORDER_LSB_FIRST,
+} SPI_BYTE_ORDER;
+
+/* Settings of one peripheral on the bus
+ * SPI registers are only written when they differ from the last ones */
+typedef struct
+{
+    PORTS_CHANNEL CsChannel;                /* Chip select port */
+    PORTS_BIT_POS CsBitPos;                 /* Chip select pin */
+    uint32_t BaudRate;                      /* SPI clock [Hz] */
+    SPI_CLOCK_POLARITY ClockPolarity;       /* CPOL */
+    SPI_OUTPUT_DATA_PHASE DataPhase;        /* CPHA */
+    SPI_COMMUNICATION_WIDTH Width;          /* 8, 16 or 32 bits words */
+    SPI_BYTE_ORDER ByteOrder;               /* Bytes of words in buffers */
+} S_SPI_DEVICE;
+
+/* Queued transfer
+ * Words are sent and received in the byte order of the device */
+typedef struct
+{
+    const S_SPI_DEVICE* pDevice;            /* Peripheral to talk to */
+    uint32_t nBytes;                        /* Multiple of word size */
+    const uint8_t* pBytesToWrite;           /* NULL for dummy bytes */
+    uint8_t* pBytesRead;                    /* NULL to ignore datas */
+    SPI_CALLBACK Callback;                  /* NULL if not needed */
+    volatile bool* pDone;                   /* Set at end, NULL if not needed */
+} S_SPI_JOB;
+
+/* Configuration of one SPI module */
+typedef struct
+{
+    S_SPI_DEVICE DefaultDevice;             /* Used by SPI_SM_Start* */
+    DMA_CHANNEL DmaChannelTx;               /* Used by SPI_SM_StartDma */
+    DMA_CHANNEL DmaChannelRx;
+    INT_PRIORITY_LEVEL IntPriority;         /* Must match ipl of __ISR */
+} S_SPI_SM_CONFIG;
+
+/* Measures of a SPI module, filled when SPI_SM_STATS is defined
+ * Times are core timer ticks (SYSCLK / 2) from start to end of transfer */
+typedef struct
+{
+    uint32_t Transfers;                     /* Transfers ended */
+    uint32_t Bytes;                         /* Bytes of ended transfers */
+    uint32_t TicksTotal;                    /* Sum of transfer times */
+    uint32_t TicksMax;                      /* Longest transfer */
+    uint32_t TicksLast;                     /* Last transfer */
+    uint32_t DoTasksBusy;                   /* SPI_SM_DoTasks calls while busy */
+    uint32_t FifoServices;                  /* FIFO drain/refill passes */
+    uint32_t StartTick;                     /* Start of running transfer */
+    uint32_t StartBytes;                    /* Size of running transfer */
+} S_SPI_SM_STATS;
+
+/* Columns of SPI_SM_StatsReport */
+#define SPI_SM_STATS_CSV_HEADER \
+    "transfers,bytes,ticks_total,ticks_max,ticks_last,dotasks_busy,fifo_services\n"
+
+/* Ring buffer between the API and the FIFO */
+typedef struct
+{
+    uint8_t Data[SPI_SM_RING_SIZE];
+    volatile uint8_t Head;                  /* Next byte to put */
+    volatile uint8_t Tail;                  /* Next byte to get */
+} S_SPI_RING;
+
+/* Descriptor of one SPI module handled by state machine */
+typedef struct
+{
+    /* Peripheral resources */
+    SPI_MODULE_ID SpiId;
+    INT_SOURCE IntSourceRx;
+    INT_VECTOR IntVector;
+    DMA_CHANNEL DmaChannelTx;
+    DMA_CHANNEL DmaChannelRx;
+    DMA_TRIGGER_SOURCE DmaTriggerTx;
+    DMA_TRIGGER_SOURCE DmaTriggerRx;
+    INT_SOURCE DmaIntSourceRx;
+
+    /* State machine */
+    volatile SPI_STATES State;
+
+    /* Bytes waiting to be sent and bytes received */
+    S_SPI_RING TxRing;
+    S_SPI_RING RxRing;
+
+    /* Words still to write in FIFO and still to get back from it */
+    volatile uint32_t TxPending;
+    volatile uint32_t RxPending;
+
+    /* Stream buffers, NULL when the ring buffers are used */
+    const uint8_t* pTx;
+    uint8_t* pRx;
+
+    /* Received bytes are not considered */
+    bool RxDiscard;
+
+    /* Called at end of transfer, and at end of the running job */
+    SPI_CALLBACK Callback;
+    SPI_CALLBACK JobCallback;
+
+    /* End flag of the running job */
+    volatile bool* pJobDone;
+
+    /* Device of SPI_SM_Start*, settings in registers, device selected */
+    S_SPI_DEVICE DefaultDevice;
+    S_SPI_DEVICE ActiveSettings;
+    const S_SPI_DEVICE* pDevice;
+
+    /* Bytes per FIFO word */
+    uint8_t WordSize;
+
+    /* Jobs waiting for the bus */
+    S_SPI_JOB Queue[SPI_SM_QUEUE_SIZE];
+    volatile uint8_t QueueHead;
+    volatile uint8_t QueueTail;
+
+    /* Measures, see SPI_SM_STATS */
+    S_SPI_SM_STATS Stats;
+} S_SPI_SM_DESCR;
+
+/* Descriptor used by SPI_Init, SPI_DoTasks, ... */
+extern S_SPI_SM_DESCR DescrSpi;
+
+/*****************************************************************************/
+
 /**
- * SPI_Init
+ * SPI_SM_Init
+ *
+ * One time call when starting programm, for each SPI module
+ *
+ * @param pDescr : Descriptor of the module
+ * @param SpiId : SPI module to use (SPI_ID_1 to SPI_ID_4)
+ * @param pConfig : Default device, DMA channels and interrupt priority
+ */
+void SPI_SM_Init(S_SPI_SM_DESCR* pDescr, SPI_MODULE_ID SpiId,
+                 const S_SPI_SM_CONFIG* pConfig);
+
+/**
+ * SPI_SM_DoTasks
+ *
+ * State machine handling
+ * Should be call cyclically
+ *
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_DoTasks(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_StartRead
+ *
+ * Write one or multiple dummy bytes
+ * to receive datas back to be read
+ *
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ */
+void SPI_SM_StartRead(S_SPI_SM_DESCR* pDescr, uint8_t nBytes);
+
+/**
+ * SPI_SM_StartWrite
+ *
+ * Write one or multiple bytes by SPI
+ * datas received back are not considered
+ *
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ * @param pBytesToWrite : Pointer to datas to write
+ */
+void SPI_SM_StartWrite(S_SPI_SM_DESCR* pDescr, uint8_t nBytes,
+                       uint8_t* pBytesToWrite);
+
+/**
+ * SPI_SM_StartReadWrite
+ *
+ * Simultaneous write and read
+ *
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to write
+ * @param pBytesToWrite : Pointer to datas to write
+ */
+void SPI_SM_StartReadWrite(S_SPI_SM_DESCR* pDescr, uint8_t nBytes,
+                           uint8_t* pBytesToWrite);
+
+/**
+ * SPI_SM_StartStream
+ *
+ * Transfer of any length, FIFO is topped up as it drains
+ * Buffers are used in place and must stay valid until the end
+ * nBytes must be a multiple of the word size (see SPI_SM_SetWidth)
+ * State goes back to SPI_STATE_IDLE once every byte is received
+ *
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_SM_StartStream(S_SPI_SM_DESCR* pDescr, uint32_t nBytes,
+                        const uint8_t* pBytesToWrite, uint8_t* pBytesRead);
+
+/**
+ * SPI_SM_StartDma
+ *
+ * Bulk transfer by two DMA channels, CPU is only used for setup
+ * Only available when SPI_USE_DMA is defined in SPI_SM.c
+ * Buffers must be in RAM and stay valid until the end
+ * When only reading, pBytesRead is filled with dummy bytes and sent
+ * In 16 and 32 bits modes, cells are one word and buffers must be
+ * word aligned in SPI_BYTE_ORDER_LSB_FIRST, MSB first is refused
+ * At most SPI_SM_DMA_MAX_BYTES per call, longer transfers are refused
+ * and must be split or done by SPI_SM_StartStream
+ * State goes back to SPI_STATE_IDLE at the end, callback is called
+ *
+ * @param pDescr : Descriptor of the module
+ * @param nBytes : Number of bytes to transfer, 1 to SPI_SM_DMA_MAX_BYTES
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_SM_StartDma(S_SPI_SM_DESCR* pDescr, uint16_t nBytes,
+                     const uint8_t* pBytesToWrite, uint8_t* pBytesRead);
+
+/**
+ * SPI_SM_SetWidth
+ * 
+ * Select word width and byte order of the following SPI_SM_Start*
+ * 16 and 32 bits words need half or a quarter of the FIFO accesses
+ * Queued jobs use the width of their own device
  * 
+ * @param pDescr : Descriptor of the module
+ * @param Width : 8, 16 or 32 bits words
+ * @param ByteOrder : Order of bytes of words in buffers
+ * @return true if changed, false if a transfer is running
+ */
+bool SPI_SM_SetWidth(S_SPI_SM_DESCR* pDescr, SPI_COMMUNICATION_WIDTH Width,
+                     SPI_BYTE_ORDER ByteOrder);
+
+/**
+ * SPI_SM_QueueSubmit
+ *
+ * Queue a transfer, jobs are run back to back as soon as the bus is free
+ * The job is copied, its buffers must stay valid until its callback
+ *
+ * @param pDescr : Descriptor of the module
+ * @param pJob : Transfer to queue
+ * @return true if queued, false if queue is full or job is invalid
+ */
+bool SPI_SM_QueueSubmit(S_SPI_SM_DESCR* pDescr, const S_SPI_JOB* pJob);
+
+/**
+ * SPI_SM_QueueCount
+ *
+ * @param pDescr : Descriptor of the module
+ * @return Number of jobs waiting in queue
+ */
+uint8_t SPI_SM_QueueCount(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_GetState
+ *
+ * @param pDescr : Descriptor of the module
+ * @return Current state of SPI state machine
+ */
+SPI_STATES SPI_SM_GetState(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_UpdateState
+ *
+ * Update state of SPI SM
+ *
+ * @param pDescr : Descriptor of the module
+ * @param NewState
+ */
+void SPI_SM_UpdateState(S_SPI_SM_DESCR* pDescr, SPI_STATES NewState);
+
+/**
+ * SPI_SM_ReadByte
+ *
+ * Get the first byte in the SPI buffer
+ *
+ * @param pDescr : Descriptor of the module
+ * @return Byte in reception buffer
+ */
+uint8_t SPI_SM_ReadByte(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_BytesAvailable
+ * 
+ * @param pDescr : Descriptor of the module
+ * @return Number of bytes waiting in reception buffer
+ */
+uint8_t SPI_SM_BytesAvailable(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_ReadBlock
+ * 
+ * Get up to n bytes of the SPI buffer in one call
+ * State goes back to SPI_STATE_IDLE once the buffer is empty
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pDst : Pointer to store datas
+ * @param n : Maximum number of bytes to get
+ * @return Number of bytes copied
+ */
+size_t SPI_SM_ReadBlock(S_SPI_SM_DESCR* pDescr, uint8_t* pDst, size_t n);
+
+/**
+ * SPI_SM_SetCallback
+ *
+ * Register a function called when a transfer ends
+ *
+ * @param pDescr : Descriptor of the module
+ * @param Callback : Function to call, NULL to disable
+ */
+void SPI_SM_SetCallback(S_SPI_SM_DESCR* pDescr, SPI_CALLBACK Callback);
+
+/**
+ * SPI_SM_StatsReset
+ * 
+ * Clear measures, for example before a series of same size transfers
+ * 
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_StatsReset(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_StatsReport
+ * 
+ * Write measures as one CSV line, columns of SPI_SM_STATS_CSV_HEADER
+ * Measures are only written when SPI_SM_STATS is defined in SPI_SM.c,
+ * otherwise pBuf is left empty
+ * SPI/test holds a host benchmark on a fake PLIB_SPI (make run)
+ * 
+ * @param pDescr : Descriptor of the module
+ * @param pBuf : Text buffer
+ * @param Size : Size of text buffer
+ * @return Number of characters written, without the final 0
+ */
+size_t SPI_SM_StatsReport(S_SPI_SM_DESCR* pDescr, char* pBuf, size_t Size);
+
+/**
+ * SPI_SM_InterruptHandler
+ *
+ * Refill and drain the SPI FIFO from the interrupt
+ * Only used when SPI_USE_INTERRUPT is defined in SPI_SM.c
+ * Must be called from the vector of the SPI module, ex :
+ *
+ * void __ISR(_SPI_2_VECTOR, ipl3AUTO) IntHandlerSpiInstance1(void)
+ * {
+ *     SPI_SM_InterruptHandler(&DescrSpi2);
+ * }
+ *
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_InterruptHandler(S_SPI_SM_DESCR* pDescr);
+
+/**
+ * SPI_SM_DmaInterruptHandler
+ *
+ * End a DMA transfer as soon as the last byte is received
+ * Only used when SPI_USE_DMA and SPI_USE_INTERRUPT are defined
+ * Must be called from the vector of the reception DMA channel
+ * Write only transfers are ended by SPI_SM_DoTasks once the SPI is idle
+ *
+ * @param pDescr : Descriptor of the module
+ */
+void SPI_SM_DmaInterruptHandler(S_SPI_SM_DESCR* pDescr);
+
+/*****************************************************************************/
+
+/**
+ * SPI_Init
+ *
  * One time call when starting programm
  * Refer to #defines to select parameters
  */
@@ -48,28 +456,28 @@ void SPI_Init(void);
 
 /**
  * SPI_DoTasks
- * 
+ *
  * State machine handling
- * Should be call cyclically 
+ * Should be call cyclically
  */
 void SPI_DoTasks(void);
 
 /**
  * SPI_StartRead
- * 
+ *
  * Write one or multiple dummy bytes
  * to receive datas back to be read
- * 
+ *
  * @param nBytes : Number of bytes to write
  */
 void SPI_StartRead(uint8_t nBytes);
 
 /**
  * SPI_StartWrite
- * 
+ *
  * Write one or multiple bytes by SPI
  * datas received back are not considered
- * 
+ *
  * @param nBytes : Number of bytes to write
  * @param pBytesToWrite : Pointer to datas to write
  */
@@ -77,14 +485,67 @@ void SPI_StartWrite(uint8_t nBytes, uint8_t* pBytesToWrite);
 
 /**
  * SPI_StartReadWrite
- * 
+ *
  * Simultaneous write and read
- * 
+ *
  * @param nBytes : Number of bytes to write
  * @param pBytesToWrite : Pointer to datas to write
  */
 void SPI_StartReadWrite(uint8_t nBytes, uint8_t* pBytesToWrite);
 
+/**
+ * SPI_StartStream
+ *
+ * Transfer of any length, see SPI_SM_StartStream
+ *
+ * @param nBytes : Number of bytes to transfer
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_StartStream(uint32_t nBytes, const uint8_t* pBytesToWrite,
+                     uint8_t* pBytesRead);
+
+/**
+ * SPI_StartDma
+ *
+ * Bulk transfer by DMA, see SPI_SM_StartDma
+ *
+ * @param nBytes : Number of bytes to transfer, 1 to SPI_SM_DMA_MAX_BYTES
+ * @param pBytesToWrite : Pointer to datas to write, NULL for dummy bytes
+ * @param pBytesRead : Pointer to store datas received, NULL to ignore them
+ * @return true if the transfer is started
+ */
+bool SPI_StartDma(uint16_t nBytes, const uint8_t* pBytesToWrite,
+                  uint8_t* pBytesRead);
+
+/**
+ * SPI_SetWidth
+ * 
+ * Select word width and byte order, see SPI_SM_SetWidth
+ * 
+ * @param Width : 8, 16 or 32 bits words
+ * @param ByteOrder : Order of bytes of words in buffers
+ * @return true if changed, false if a transfer is running
+ */
+bool SPI_SetWidth(SPI_COMMUNICATION_WIDTH Width, SPI_BYTE_ORDER ByteOrder);
+
+/**
+ * SPI_QueueSubmit
+ *
+ * Queue a transfer, see SPI_SM_QueueSubmit
+ *
+ * @param pJob : Transfer to queue
+ * @return true if queued, false if queue is full or job is invalid
+ */
+bool SPI_QueueSubmit(const S_SPI_JOB* pJob);
+
+/**
+ * SPI_QueueCount
+ * @return Number of jobs waiting in queue
+ */
+uint8_t SPI_QueueCount(void);
+
 /**
  * SPI_GetState
  * @return Current state of SPI state machine
@@ -93,20 +554,76 @@ SPI_STATES SPI_GetState (void);
 
 /**
  * SPI_UpdateState
- * 
+ *
  * Update state of SPI SM
- * 
+ *
  * @param NewState
  */
 void SPI_UpdateState(SPI_STATES NewState);
 
 /**
  * SPI_ReadByte
- * 
- * Get the first byte in the SPI buffer 
- * 
+ *
+ * Get the first byte in the SPI buffer
+ *
  * @return Byte in reception buffer
  */
 uint8_t SPI_ReadByte(void);
 
+/**
+ * SPI_BytesAvailable
+ * @return Number of bytes waiting in reception buffer
+ */
+uint8_t SPI_BytesAvailable(void);
+
+/**
+ * SPI_ReadBlock
+ * 
+ * Get up to n bytes of the SPI buffer in one call
+ * 
+ * @param pDst : Pointer to store datas
+ * @param n : Maximum number of bytes to get
+ * @return Number of bytes copied
+ */
+size_t SPI_ReadBlock(uint8_t* pDst, size_t n);
+
+/**
+ * SPI_SetCallback
+ *
+ * Register a function called when a transfer ends
+ *
+ * @param Callback : Function to call, NULL to disable
+ */
+void SPI_SetCallback(SPI_CALLBACK Callback);
+
+/**
+ * SPI_InterruptHandler
+ *
+ * Refill and drain the SPI FIFO from the interrupt
+ * Only used when SPI_USE_INTERRUPT is defined in SPI_SM.c
+ * Must be called from the SPI interrupt vector, ex :
+ *
+ * void __ISR(_SPI_1_VECTOR, ipl3AUTO) IntHandlerSpiInstance0(void)
+ * {
+ *     SPI_InterruptHandler();
+ * }
+ */
+void SPI_InterruptHandler(void);
+
+/**
+ * SPI_DmaInterruptHandler
+ *
+ * End a DMA transfer as soon as the last byte is received
+ * Only used when SPI_USE_DMA and SPI_USE_INTERRUPT are defined
+ * Must be called from the reception DMA channel vector, ex :
+ *
+ * void __ISR(_DMA_1_VECTOR, ipl3AUTO) IntHandlerSpiDmaRx(void)
+ * {
+ *     SPI_DmaInterruptHandler();
+ * }
+ *
+ * Write only transfers are ended by SPI_DoTasks once the SPI is idle
+ */
+void SPI_DmaInterruptHandler(void);
+
 #endif /* SPI_SM_H */
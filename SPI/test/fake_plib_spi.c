@@ -0,0 +1,869 @@
+/*******************************************************************************
+ * @file fake_plib_spi.c
+ * @summary 
+ * 
+ * Host simulation of the PIC32MX SPI modules for spi_bench
+ * Enhanced buffer of 16 bytes (8 words of 16 bits, 4 of 32 bits)
+ * DMA channels move one cell per trigger, triggers are levels of the
+ * SPI buffers (TX not full, RX not empty) and cost no CPU time
+ * A trigger already set when a channel is enabled is not seen, as the
+ * flag edge on target, PLIB_DMA_StartTransferSet starts the channel
+ * Interrupt flags are the levels of their conditions, so clearing one
+ * has no effect while its FIFO still holds datas, as on target
+ * 
+ ******************************************************************************/
+
+#include <string.h>
+#include "fake_plib_spi.h"
+#include "peripheral/ports/plib_ports.h"
+#include "peripheral/int/plib_int.h"
+#include "peripheral/dma/plib_dma.h"
+#include "system/clk/sys_clk.h"
+
+/* Enhanced buffer depth [bytes] */
+#define FAKE_FIFO_BYTES     16
+
+/* Interrupt sources of plib_int.h */
+#define FAKE_INT_SOURCES    (INT_SOURCE_DMA_7 + 1)
+
+/* State of one simulated module */
+typedef struct
+{
+    bool Enabled;
+    bool FifoEnabled;
+    uint8_t WordSize;                       /* Bytes per word */
+    uint32_t BaudTicks;                     /* Byte time from baud rate */
+    uint32_t TxFifo[FAKE_FIFO_BYTES];
+    uint8_t TxCount;
+    uint32_t RxFifo[FAKE_FIFO_BYTES];
+    uint8_t RxCount;
+    bool Shifting;                          /* Word in shift register */
+    uint32_t ShiftWord;
+    uint32_t ShiftEnd;                      /* Time of its last bit */
+} S_FAKE_SPI;
+
+/* State of one simulated DMA channel */
+typedef struct
+{
+    bool Enabled;
+    bool TriggerEnabled;
+    DMA_TRIGGER_SOURCE Trigger;
+    uintptr_t Source;
+    uintptr_t Destination;
+    uint8_t SourceSize;                     /* 8 bits registers, 0 = 256 */
+    uint8_t DestinationSize;
+    uint8_t CellSize;
+    uint16_t SourceIndex;
+    uint16_t DestinationIndex;
+    uint16_t Moved;                         /* Bytes of the block done */
+    bool WaitStart;                         /* Trigger set when enabled */
+    bool BlockIntEnabled;                   /* Block end raises interrupt */
+    bool BlockDone;
+} S_FAKE_DMA;
+
+static S_FAKE_SPI fakeSpi[SPI_NUMBER_OF_MODULES];
+static S_FAKE_DMA fakeDma[DMA_NUMBER_OF_CHANNELS];
+static uint32_t fakeNow;
+static uint32_t fakeByteTicks;
+static uint32_t fakeAccessTicks = 2;
+static uint32_t fakeCsLow;
+static S_FAKE_SPI_COUNTERS fakeCounters;
+static FAKE_SPI_ISR fakeIsr[FAKE_INT_SOURCES];
+static uint32_t fakeIntEnabled;             /* One bit per source */
+static bool fakeIntOn = true;               /* Global enable */
+static bool fakeInIsr;
+
+/*****************************************************************************/
+
+/**
+ * fake_spi_depth
+ * 
+ * @param pSpi : Simulated module
+ * @return Words held by each FIFO
+ */
+static uint8_t fake_spi_depth(const S_FAKE_SPI* pSpi)
+{
+    return pSpi->FifoEnabled ? (FAKE_FIFO_BYTES / pSpi->WordSize) : 1;
+}
+
+/**
+ * fake_spi_word_ticks
+ * 
+ * @param SpiId : SPI module
+ * @return Time of one word on the wire
+ */
+static uint32_t fake_spi_word_ticks(SPI_MODULE_ID SpiId)
+{
+    return FakeSpi_ByteTicks(SpiId) * fakeSpi[SpiId].WordSize;
+}
+
+/**
+ * fake_spi_push
+ * 
+ * @param pSpi : Simulated module
+ * @param Word : Word to push in TX FIFO
+ */
+static void fake_spi_push(S_FAKE_SPI* pSpi, uint32_t Word)
+{
+    if(pSpi->TxCount < fake_spi_depth(pSpi))
+        pSpi->TxFifo[pSpi->TxCount++] = Word;
+    else
+        fakeCounters.TxOverflows++;
+}
+
+/**
+ * fake_spi_pop
+ * 
+ * @param pSpi : Simulated module
+ * @return Word popped from RX FIFO, 0 if empty
+ */
+static uint32_t fake_spi_pop(S_FAKE_SPI* pSpi)
+{
+    uint32_t Word = 0;
+
+    if(pSpi->RxCount > 0)
+    {
+        Word = pSpi->RxFifo[0];
+        pSpi->RxCount--;
+        memmove(&pSpi->RxFifo[0], &pSpi->RxFifo[1], pSpi->RxCount * sizeof(uint32_t));
+    }
+    else
+    {
+        fakeCounters.RxUnderflows++;
+    }
+
+    return Word;
+}
+
+/**
+ * fake_spi_at
+ * 
+ * @param Address : Address given to a DMA channel
+ * @return SPI module whose buffer is at this address,
+ *         SPI_NUMBER_OF_MODULES for memory
+ */
+static SPI_MODULE_ID fake_spi_at(uintptr_t Address)
+{
+    SPI_MODULE_ID SpiId;
+
+    for( SpiId = SPI_ID_1 ; SpiId < SPI_NUMBER_OF_MODULES ; SpiId++ )
+    {
+        if(Address == (uintptr_t)&fakeSpi[SpiId].TxFifo[0])
+            break;
+    }
+
+    return SpiId;
+}
+
+/**
+ * fake_dma_size
+ * 
+ * @param Register : Size register
+ * @return Size in bytes, 0 is 256
+ */
+static uint16_t fake_dma_size(uint8_t Register)
+{
+    return (Register == 0) ? 256 : Register;
+}
+
+/**
+ * fake_dma_cell
+ * 
+ * Move one cell, words of SPI buffers are in memory order (LSB first)
+ * Channel is disabled at the end of the block, as without auto enable
+ * 
+ * @param pDma : Simulated channel
+ */
+static void fake_dma_cell(S_FAKE_DMA* pDma)
+{
+    SPI_MODULE_ID SourceSpi = fake_spi_at(pDma->Source);
+    SPI_MODULE_ID DestinationSpi = fake_spi_at(pDma->Destination);
+    uint16_t BlockSize = fake_dma_size(pDma->SourceSize);
+    uint32_t Word = 0;
+    uint8_t iByte;
+
+    if(fake_dma_size(pDma->DestinationSize) > BlockSize)
+        BlockSize = fake_dma_size(pDma->DestinationSize);
+
+    if(SourceSpi < SPI_NUMBER_OF_MODULES)
+    {
+        Word = fake_spi_pop(&fakeSpi[SourceSpi]);
+    }
+    else
+    {
+        for( iByte = 0 ; iByte < pDma->CellSize ; iByte++ )
+            Word |= (uint32_t)((const uint8_t*)pDma->Source)[pDma->SourceIndex + iByte] << (8 * iByte);
+    }
+
+    if(DestinationSpi < SPI_NUMBER_OF_MODULES)
+    {
+        fake_spi_push(&fakeSpi[DestinationSpi], Word);
+    }
+    else
+    {
+        for( iByte = 0 ; iByte < pDma->CellSize ; iByte++ )
+            ((uint8_t*)pDma->Destination)[pDma->DestinationIndex + iByte] = (uint8_t)(Word >> (8 * iByte));
+    }
+
+    pDma->SourceIndex = (pDma->SourceIndex + pDma->CellSize) % fake_dma_size(pDma->SourceSize);
+    pDma->DestinationIndex = (pDma->DestinationIndex + pDma->CellSize) % fake_dma_size(pDma->DestinationSize);
+    pDma->Moved += pDma->CellSize;
+    if(pDma->Moved >= BlockSize)
+    {
+        pDma->Enabled = false;
+        pDma->BlockDone = true;
+    }
+}
+
+/**
+ * fake_dma_triggered
+ * 
+ * @param pDma : Simulated channel
+ * @return true while the SPI interrupt starting its cells is set
+ */
+static bool fake_dma_triggered(const S_FAKE_DMA* pDma)
+{
+    const S_FAKE_SPI* pSpi = &fakeSpi[pDma->Trigger / 2];
+    bool Triggered;
+
+    if(!pDma->TriggerEnabled)
+        Triggered = false;
+    else if((pDma->Trigger % 2) == 0)
+        Triggered = (pSpi->TxCount < fake_spi_depth(pSpi));
+    else
+        Triggered = (pSpi->RxCount > 0);
+
+    return Triggered;
+}
+
+/**
+ * fake_dma_service
+ * 
+ * Run the channels triggered by a SPI module while their trigger is set
+ * 
+ * @param SpiId : SPI module
+ */
+static void fake_dma_service(SPI_MODULE_ID SpiId)
+{
+    S_FAKE_DMA* pDma;
+    DMA_CHANNEL Channel;
+
+    for( Channel = DMA_CHANNEL_0 ; Channel < DMA_NUMBER_OF_CHANNELS ; Channel++ )
+    {
+        pDma = &fakeDma[Channel];
+        if(((SPI_MODULE_ID)(pDma->Trigger / 2) != SpiId) || pDma->WaitStart)
+            continue;
+
+        while(pDma->Enabled && fake_dma_triggered(pDma))
+            fake_dma_cell(pDma);
+    }
+}
+
+/**
+ * fake_spi_update
+ * 
+ * Move the shift register up to the current time
+ * A word is loaded as soon as the previous one is out
+ * 
+ * @param SpiId : SPI module
+ */
+static void fake_spi_update(SPI_MODULE_ID SpiId)
+{
+    S_FAKE_SPI* pSpi = &fakeSpi[SpiId];
+    uint32_t Start = fakeNow;
+
+    for(;;)
+    {
+        if(pSpi->Shifting)
+        {
+            if((int32_t)(fakeNow - pSpi->ShiftEnd) < 0)
+                break;
+
+            /* Word received back, lost if the RX FIFO is full */
+            if(pSpi->RxCount < fake_spi_depth(pSpi))
+                pSpi->RxFifo[pSpi->RxCount++] = pSpi->ShiftWord;
+            else
+                fakeCounters.RxOverflows++;
+
+            pSpi->Shifting = false;
+            Start = pSpi->ShiftEnd;
+        }
+
+        fake_dma_service(SpiId);
+
+        if(!pSpi->Enabled || (pSpi->TxCount == 0))
+            break;
+
+        pSpi->ShiftWord = pSpi->TxFifo[0];
+        pSpi->TxCount--;
+        memmove(&pSpi->TxFifo[0], &pSpi->TxFifo[1], pSpi->TxCount * sizeof(uint32_t));
+        pSpi->Shifting = true;
+        pSpi->ShiftEnd = Start + fake_spi_word_ticks(SpiId);
+    }
+}
+
+/**
+ * fake_int_flag
+ * 
+ * @param Source : Interrupt source
+ * @return true while its condition is set
+ */
+static bool fake_int_flag(INT_SOURCE Source)
+{
+    const S_FAKE_DMA* pDma;
+    bool Flag;
+
+    if(Source <= INT_SOURCE_SPI_4_RECEIVE)
+    {
+        Flag = (fakeSpi[Source - INT_SOURCE_SPI_1_RECEIVE].RxCount > 0);
+    }
+    else
+    {
+        pDma = &fakeDma[Source - INT_SOURCE_DMA_0];
+        Flag = pDma->BlockDone && pDma->BlockIntEnabled;
+    }
+
+    return Flag;
+}
+
+/**
+ * fake_int_raise
+ * 
+ * Call the handlers of enabled and set sources
+ * Not nested, PLIB calls of a handler do not raise again
+ */
+static void fake_int_raise(void)
+{
+    INT_SOURCE Source;
+
+    if(fakeInIsr || !fakeIntOn)
+        return;
+
+    fakeInIsr = true;
+    for( Source = 0 ; Source < FAKE_INT_SOURCES ; Source++ )
+    {
+        if(((fakeIntEnabled & (1u << Source)) != 0) &&
+           (fakeIsr[Source] != NULL) && fake_int_flag(Source))
+        {
+            fakeCounters.Interrupts++;
+            fakeIsr[Source]();
+        }
+    }
+    fakeInIsr = false;
+}
+
+/**
+ * fake_spi_access
+ * 
+ * CPU time of one PLIB call, then state at this time
+ * 
+ * @param SpiId : SPI module
+ * @return Simulated module
+ */
+static S_FAKE_SPI* fake_spi_access(SPI_MODULE_ID SpiId)
+{
+    fakeNow += fakeAccessTicks;
+    fakeCounters.Accesses++;
+    fake_spi_update(SpiId);
+    fake_int_raise();
+    return &fakeSpi[SpiId];
+}
+
+/**
+ * fake_spi_wait
+ * 
+ * Count status reads asking the caller to wait
+ * 
+ * @param Wait : Status read
+ * @return Wait
+ */
+static bool fake_spi_wait(bool Wait)
+{
+    if(Wait)
+        fakeCounters.WaitPolls++;
+    return Wait;
+}
+
+/**
+ * fake_spi_write
+ * 
+ * @param SpiId : SPI module
+ * @param Word : Word to push in TX FIFO
+ */
+static void fake_spi_write(SPI_MODULE_ID SpiId, uint32_t Word)
+{
+    fake_spi_push(fake_spi_access(SpiId), Word);
+    fake_spi_update(SpiId);
+}
+
+/**
+ * fake_spi_read
+ * 
+ * @param SpiId : SPI module
+ * @return Word popped from RX FIFO, 0 if empty
+ */
+static uint32_t fake_spi_read(SPI_MODULE_ID SpiId)
+{
+    return fake_spi_pop(fake_spi_access(SpiId));
+}
+
+/**
+ * fake_dma_access
+ * 
+ * CPU time of one PLIB_DMA call, SPI modules and channels run meanwhile
+ * 
+ * @param Channel : DMA channel
+ * @return Simulated channel
+ */
+static S_FAKE_DMA* fake_dma_access(DMA_CHANNEL Channel)
+{
+    FakeSpi_Advance(fakeAccessTicks);
+    fakeCounters.Accesses++;
+    return &fakeDma[Channel];
+}
+
+/*****************************************************************************/
+
+void FakeSpi_Reset(void)
+{
+    SPI_MODULE_ID SpiId;
+
+    memset(fakeSpi, 0, sizeof(fakeSpi));
+    memset(fakeDma, 0, sizeof(fakeDma));
+    for( SpiId = SPI_ID_1 ; SpiId < SPI_NUMBER_OF_MODULES ; SpiId++ )
+        fakeSpi[SpiId].WordSize = 1;
+
+    fakeNow = 0;
+    fakeCsLow = 0;
+    fakeIntEnabled = 0;
+    fakeIntOn = true;
+    FakeSpi_ClearCounters();
+}
+
+void FakeSpi_SetByteTicks(uint32_t Ticks)
+{
+    fakeByteTicks = Ticks;
+}
+
+void FakeSpi_SetAccessTicks(uint32_t Ticks)
+{
+    fakeAccessTicks = Ticks;
+}
+
+void FakeSpi_Advance(uint32_t Ticks)
+{
+    uint32_t Target = fakeNow + Ticks;
+    uint32_t Step;
+    SPI_MODULE_ID SpiId;
+
+    /* Stop at each word end so that handlers are called in time,
+     * their CPU time may go past the target */
+    do
+    {
+        Step = Target;
+        for( SpiId = SPI_ID_1 ; SpiId < SPI_NUMBER_OF_MODULES ; SpiId++ )
+        {
+            if(fakeSpi[SpiId].Shifting &&
+               ((int32_t)(fakeSpi[SpiId].ShiftEnd - fakeNow) > 0) &&
+               ((int32_t)(fakeSpi[SpiId].ShiftEnd - Step) < 0))
+            {
+                Step = fakeSpi[SpiId].ShiftEnd;
+            }
+        }
+        if((int32_t)(Step - fakeNow) > 0)
+            fakeNow = Step;
+
+        for( SpiId = SPI_ID_1 ; SpiId < SPI_NUMBER_OF_MODULES ; SpiId++ )
+            fake_spi_update(SpiId);
+        fake_int_raise();
+    } while((int32_t)(Target - fakeNow) > 0);
+}
+
+uint32_t FakeSpi_Now(void)
+{
+    return fakeNow;
+}
+
+uint32_t FakeSpi_ByteTicks(SPI_MODULE_ID SpiId)
+{
+    uint32_t Ticks = fakeByteTicks;
+
+    if(Ticks == 0)
+        Ticks = fakeSpi[SpiId].BaudTicks;
+    if(Ticks == 0)
+        Ticks = 1;
+
+    return Ticks;
+}
+
+bool FakeSpi_CsIsLow(void)
+{
+    return fakeCsLow != 0;
+}
+
+S_FAKE_SPI_COUNTERS FakeSpi_Counters(void)
+{
+    return fakeCounters;
+}
+
+void FakeSpi_ClearCounters(void)
+{
+    memset(&fakeCounters, 0, sizeof(fakeCounters));
+}
+
+void FakeSpi_SetVector(INT_SOURCE Source, FAKE_SPI_ISR Isr)
+{
+    fakeIsr[Source] = Isr;
+}
+
+unsigned int FakeSpi_IsrState(void)
+{
+    return fakeIntOn ? 1 : 0;
+}
+
+unsigned int FakeSpi_IsrDisable(void)
+{
+    unsigned int State = FakeSpi_IsrState();
+
+    fakeIntOn = false;
+    return State;
+}
+
+void FakeSpi_IsrRestore(unsigned int State)
+{
+    fakeIntOn = (State != 0);
+    fake_int_raise();
+}
+
+/*****************************************************************************/
+
+void PLIB_SPI_Enable(SPI_MODULE_ID index)
+{
+    fake_spi_access(index)->Enabled = true;
+    fake_spi_update(index);
+}
+
+void PLIB_SPI_Disable(SPI_MODULE_ID index)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+
+    /* Clearing ON empties the buffers and aborts the running word */
+    pSpi->Enabled = false;
+    pSpi->Shifting = false;
+    pSpi->TxCount = 0;
+    pSpi->RxCount = 0;
+}
+
+void PLIB_SPI_BufferClear(SPI_MODULE_ID index)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+
+    pSpi->RxCount = 0;
+}
+
+void PLIB_SPI_FIFOEnable(SPI_MODULE_ID index)
+{
+    fake_spi_access(index)->FifoEnabled = true;
+}
+
+void PLIB_SPI_CommunicationWidthSelect(SPI_MODULE_ID index, SPI_COMMUNICATION_WIDTH width)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+
+    if(width == SPI_COMMUNICATION_WIDTH_32BITS)
+        pSpi->WordSize = 4;
+    else if(width == SPI_COMMUNICATION_WIDTH_16BITS)
+        pSpi->WordSize = 2;
+    else
+        pSpi->WordSize = 1;
+}
+
+void PLIB_SPI_BaudRateSet(SPI_MODULE_ID index, uint32_t clockFrequency, uint32_t baudRate)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+    uint32_t Brg = (clockFrequency / (2 * baudRate)) - 1;
+    uint32_t RealBaud = clockFrequency / (2 * (Brg + 1));
+
+    pSpi->BaudTicks = (uint32_t)(((uint64_t)8 * FAKE_CORE_TIMER_HZ) / RealBaud);
+}
+
+void PLIB_SPI_StopInIdleDisable(SPI_MODULE_ID index)
+{
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_PinEnable(SPI_MODULE_ID index, SPI_PIN pin)
+{
+    (void)pin;
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_InputSamplePhaseSelect(SPI_MODULE_ID index, SPI_INPUT_SAMPLING_PHASE phase)
+{
+    (void)phase;
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_MasterEnable(SPI_MODULE_ID index)
+{
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_FramedCommunicationDisable(SPI_MODULE_ID index)
+{
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_FIFOInterruptModeSelect(SPI_MODULE_ID index, SPI_FIFO_INTERRUPT mode)
+{
+    (void)mode;
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_ClockPolaritySelect(SPI_MODULE_ID index, SPI_CLOCK_POLARITY polarity)
+{
+    (void)polarity;
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_OutputDataPhaseSelect(SPI_MODULE_ID index, SPI_OUTPUT_DATA_PHASE phase)
+{
+    (void)phase;
+    fake_spi_access(index);
+}
+
+void PLIB_SPI_ReceiverOverflowClear(SPI_MODULE_ID index)
+{
+    fake_spi_access(index);
+}
+
+bool PLIB_SPI_IsBusy(SPI_MODULE_ID index)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+
+    return fake_spi_wait(pSpi->Shifting || (pSpi->TxCount > 0));
+}
+
+bool PLIB_SPI_TransmitBufferIsFull(SPI_MODULE_ID index)
+{
+    S_FAKE_SPI* pSpi = fake_spi_access(index);
+
+    return fake_spi_wait(pSpi->TxCount >= fake_spi_depth(pSpi));
+}
+
+bool PLIB_SPI_TransmitBufferIsEmpty(SPI_MODULE_ID index)
+{
+    return fake_spi_access(index)->TxCount == 0;
+}
+
+bool PLIB_SPI_ReceiverFIFOIsEmpty(SPI_MODULE_ID index)
+{
+    return fake_spi_wait(fake_spi_access(index)->RxCount == 0);
+}
+
+void PLIB_SPI_BufferWrite(SPI_MODULE_ID index, uint8_t data)
+{
+    fake_spi_write(index, data);
+}
+
+void PLIB_SPI_BufferWrite16bit(SPI_MODULE_ID index, uint16_t data)
+{
+    fake_spi_write(index, data);
+}
+
+void PLIB_SPI_BufferWrite32bit(SPI_MODULE_ID index, uint32_t data)
+{
+    fake_spi_write(index, data);
+}
+
+uint8_t PLIB_SPI_BufferRead(SPI_MODULE_ID index)
+{
+    return (uint8_t)fake_spi_read(index);
+}
+
+uint16_t PLIB_SPI_BufferRead16bit(SPI_MODULE_ID index)
+{
+    return (uint16_t)fake_spi_read(index);
+}
+
+uint32_t PLIB_SPI_BufferRead32bit(SPI_MODULE_ID index)
+{
+    return fake_spi_read(index);
+}
+
+void* PLIB_SPI_BufferAddressGet(SPI_MODULE_ID index)
+{
+    return &fakeSpi[index].TxFifo[0];
+}
+
+/*****************************************************************************/
+
+void PLIB_DMA_Enable(DMA_MODULE_ID index)
+{
+    (void)index;
+    fake_dma_access(DMA_CHANNEL_0);
+}
+
+void PLIB_DMA_ChannelXEnable(DMA_MODULE_ID index, DMA_CHANNEL channel)
+{
+    S_FAKE_DMA* pDma = fake_dma_access(channel);
+
+    (void)index;
+    pDma->Enabled = true;
+    pDma->SourceIndex = 0;
+    pDma->DestinationIndex = 0;
+    pDma->Moved = 0;
+    pDma->WaitStart = fake_dma_triggered(pDma);
+}
+
+void PLIB_DMA_ChannelXDisable(DMA_MODULE_ID index, DMA_CHANNEL channel)
+{
+    (void)index;
+    fake_dma_access(channel)->Enabled = false;
+}
+
+void PLIB_DMA_ChannelXPrioritySelect(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_CHANNEL_PRIORITY channelPriority)
+{
+    (void)index;
+    (void)channelPriority;
+    fake_dma_access(channel);
+}
+
+void PLIB_DMA_ChannelXSourceStartAddressSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uintptr_t sourceStartAddress)
+{
+    (void)index;
+    fake_dma_access(channel)->Source = sourceStartAddress;
+}
+
+void PLIB_DMA_ChannelXSourceSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t sourceSize)
+{
+    (void)index;
+    fake_dma_access(channel)->SourceSize = (uint8_t)sourceSize;
+}
+
+void PLIB_DMA_ChannelXDestinationStartAddressSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uintptr_t destinationStartAddress)
+{
+    (void)index;
+    fake_dma_access(channel)->Destination = destinationStartAddress;
+}
+
+void PLIB_DMA_ChannelXDestinationSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t destinationSize)
+{
+    (void)index;
+    fake_dma_access(channel)->DestinationSize = (uint8_t)destinationSize;
+}
+
+void PLIB_DMA_ChannelXCellSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t cellSize)
+{
+    (void)index;
+    fake_dma_access(channel)->CellSize = (uint8_t)cellSize;
+}
+
+void PLIB_DMA_ChannelXStartIRQSet(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_TRIGGER_SOURCE IRQnum)
+{
+    (void)index;
+    fake_dma_access(channel)->Trigger = IRQnum;
+}
+
+void PLIB_DMA_ChannelXTriggerEnable(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_CHANNEL_TRIGGER_TYPE trigger)
+{
+    (void)index;
+    if(trigger == DMA_CHANNEL_TRIGGER_TRANSFER_START)
+        fake_dma_access(channel)->TriggerEnabled = true;
+}
+
+void PLIB_DMA_ChannelXINTSourceEnable(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource)
+{
+    (void)index;
+    if(dmaINTSource == DMA_INT_BLOCK_TRANSFER_COMPLETE)
+        fake_dma_access(channel)->BlockIntEnabled = true;
+}
+
+bool PLIB_DMA_ChannelXINTSourceFlagGet(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource)
+{
+    S_FAKE_DMA* pDma = fake_dma_access(channel);
+
+    (void)index;
+    return (dmaINTSource == DMA_INT_BLOCK_TRANSFER_COMPLETE) &&
+           !fake_spi_wait(!pDma->BlockDone);
+}
+
+void PLIB_DMA_ChannelXINTSourceFlagClear(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource)
+{
+    S_FAKE_DMA* pDma = fake_dma_access(channel);
+
+    (void)index;
+    if(dmaINTSource == DMA_INT_BLOCK_TRANSFER_COMPLETE)
+        pDma->BlockDone = false;
+}
+
+void PLIB_DMA_StartTransferSet(DMA_MODULE_ID index, DMA_CHANNEL channel)
+{
+    S_FAKE_DMA* pDma = fake_dma_access(channel);
+
+    /* Forced cell, the next ones wait for the trigger */
+    (void)index;
+    pDma->WaitStart = false;
+    if(pDma->Enabled)
+        fake_dma_cell(pDma);
+    FakeSpi_Advance(0);
+}
+
+/*****************************************************************************/
+
+void PLIB_PORTS_PinSet(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fakeCsLow &= ~(1u << ((channel * 16 + bitPos) % 32));
+    fakeNow += fakeAccessTicks;
+}
+
+void PLIB_PORTS_PinClear(PORTS_MODULE_ID index, PORTS_CHANNEL channel, PORTS_BIT_POS bitPos)
+{
+    (void)index;
+    fakeCsLow |= 1u << ((channel * 16 + bitPos) % 32);
+    fakeNow += fakeAccessTicks;
+}
+
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    fakeNow += fakeAccessTicks;
+    fakeIntEnabled |= 1u << source;
+    fake_int_raise();
+}
+
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source)
+{
+    (void)index;
+    fakeNow += fakeAccessTicks;
+    fakeIntEnabled &= ~(1u << source);
+}
+
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source)
+{
+    /* Flags follow their conditions */
+    (void)index;
+    (void)source;
+    fakeNow += fakeAccessTicks;
+}
+
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority)
+{
+    (void)index;
+    (void)vector;
+    (void)priority;
+}
+
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_SUBPRIORITY_LEVEL subPriority)
+{
+    (void)index;
+    (void)vector;
+    (void)subPriority;
+}
+
+uint32_t SYS_CLK_PeripheralFrequencyGet(CLK_BUSES_PERIPHERAL PeripheralBus)
+{
+    (void)PeripheralBus;
+    return FAKE_PBCLK_HZ;
+}
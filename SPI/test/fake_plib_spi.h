@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * @file fake_plib_spi.h
+ * @summary 
+ * 
+ * Host simulation of the PIC32MX SPI modules for spi_bench
+ * 
+ * Time is counted in core timer ticks (SYSCLK / 2), the value returned
+ * by _CP0_GET_COUNT(). Each PLIB call costs AccessTicks of CPU, the
+ * shift register moves one word every ByteTicks per byte and MISO is
+ * looped back on MOSI, so received bytes are the sent ones.
+ * DMA channels triggered by the SPI modules are simulated as well.
+ * 
+ * Enabled interrupt sources call the handler given to FakeSpi_SetVector
+ * as soon as their flag is set : SPI reception while the RX FIFO holds
+ * words, DMA channel at the end of its block. Handlers are not nested.
+ * 
+ * Status reads answering "wait" (busy, TX full, RX empty) are counted
+ * as busy-wait iterations.
+ * 
+ ******************************************************************************/
+
+#ifndef FAKE_PLIB_SPI_H
+#define FAKE_PLIB_SPI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "peripheral/spi/plib_spi.h"
+#include "peripheral/int/plib_int.h"
+
+/* Core timer frequency [Hz], SYSCLK 80 MHz / 2 */
+#define FAKE_CORE_TIMER_HZ  40000000u
+
+/* Peripheral bus frequency [Hz] given to PLIB_SPI_BaudRateSet */
+#define FAKE_PBCLK_HZ       80000000u
+
+/* Simulation counters */
+typedef struct
+{
+    uint32_t WaitPolls;                     /* Status reads answering wait */
+    uint32_t Accesses;                      /* PLIB_SPI and PLIB_DMA calls */
+    uint32_t TxOverflows;                   /* Writes in a full TX FIFO */
+    uint32_t RxOverflows;                   /* Words lost, RX FIFO full */
+    uint32_t RxUnderflows;                  /* Reads of an empty RX FIFO */
+    uint32_t Interrupts;                    /* Handlers called */
+} S_FAKE_SPI_COUNTERS;
+
+/* Interrupt handler, as the __ISR function of the vector on target */
+typedef void (*FAKE_SPI_ISR)(void);
+
+/**
+ * FakeSpi_Reset
+ * 
+ * Back to power up state, time and counters at 0
+ * Handlers given to FakeSpi_SetVector are kept
+ */
+void FakeSpi_Reset(void);
+
+/**
+ * FakeSpi_SetByteTicks
+ * 
+ * @param Ticks : Time of one byte on the wire, 0 to use PLIB_SPI_BaudRateSet
+ */
+void FakeSpi_SetByteTicks(uint32_t Ticks);
+
+/**
+ * FakeSpi_SetAccessTicks
+ * 
+ * @param Ticks : CPU time of one PLIB_SPI call
+ */
+void FakeSpi_SetAccessTicks(uint32_t Ticks);
+
+/**
+ * FakeSpi_Advance
+ * 
+ * Let time run, as the application does between two calls
+ * 
+ * @param Ticks : Elapsed core timer ticks
+ */
+void FakeSpi_Advance(uint32_t Ticks);
+
+/**
+ * FakeSpi_Now
+ * @return Simulated core timer
+ */
+uint32_t FakeSpi_Now(void);
+
+/**
+ * FakeSpi_ByteTicks
+ * 
+ * @param SpiId : SPI module
+ * @return Time of one byte on the wire in use
+ */
+uint32_t FakeSpi_ByteTicks(SPI_MODULE_ID SpiId);
+
+/**
+ * FakeSpi_CsIsLow
+ * @return true while a chip select pin is cleared
+ */
+bool FakeSpi_CsIsLow(void);
+
+/**
+ * FakeSpi_Counters
+ * @return Counters since the last FakeSpi_ClearCounters
+ */
+S_FAKE_SPI_COUNTERS FakeSpi_Counters(void);
+
+/**
+ * FakeSpi_ClearCounters
+ */
+void FakeSpi_ClearCounters(void);
+
+/**
+ * FakeSpi_SetVector
+ * 
+ * @param Source : Interrupt source
+ * @param Isr : Handler called while the source is enabled and set,
+ *              NULL for none
+ */
+void FakeSpi_SetVector(INT_SOURCE Source, FAKE_SPI_ISR Isr);
+
+#endif /* FAKE_PLIB_SPI_H */
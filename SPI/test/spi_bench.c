@@ -0,0 +1,379 @@
+/*******************************************************************************
+ * @file spi_bench.c
+ * @summary 
+ * 
+ * Host benchmark of SPI_SM.c and Mc32SpiUtil.c on the fake PLIB_SPI
+ * 
+ * For 1, 16, 64, 256 and 4096 bytes transfers, writes one CSV line per driver :
+ * 
+ *  - spi_sm        : SPI_StartStream then SPI_DoTasks every LoopTicks
+ *  - spi_util      : spi_read1 for each byte (blocking)
+ *  - spi_util_write: spi_write1 for each byte then spi_flush1 (write only,
+ *                    received bytes are not checked)
+ *  - spi_util_async: spi_read1_async with 8 bytes in flight, spi_wait1
+ *  - spi_dma       : SPI_StartDma then SPI_DoTasks every LoopTicks, only
+ *                    built with SPI_USE_DMA (make run, spi_bench_dma.csv),
+ *                    over SPI_SM_DMA_MAX_BYTES the start must be refused
+ * 
+ * Built with SPI_USE_INTERRUPT (make run, spi_bench_int.csv), spi_sm and
+ * spi_dma never call SPI_DoTasks while busy : the fake calls the handlers
+ * and the transfer must end by interrupts alone, calls is then 0
+ * 
+ * Columns :
+ *  calls           : SPI_DoTasks calls while busy, spi_read1, spi_write1
+ *                    or spi_wait1 calls
+ *  bytes_per_call  : bytes / calls
+ *  busy_polls      : status reads answering "wait" (busy, TX full, RX empty)
+ *  latency_ticks   : start to last byte received, core timer ticks
+ *  latency_us      : same in microseconds
+ * 
+ * Usage : spi_bench [ByteTicks [LoopTicks [AccessTicks]]]
+ *  ByteTicks   : time of one byte on the wire, 0 = SPI_FREQ of SPI_SM.c
+ *  LoopTicks   : application time between two SPI_DoTasks calls
+ *  AccessTicks : CPU time of one PLIB call
+ * 
+ * Exit code is 1 if received bytes differ from sent ones (MISO looped
+ * back on MOSI) or if CS stays low
+ * 
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fake_plib_spi.h"
+#include "SPI_SM.h"
+#include "Mc32SpiUtil.h"
+
+/* Sizes of benchmarked transfers */
+static const uint32_t benchSizes[] = { 1, 16, 64, 256, 4096 };
+
+/* Bytes in flight of spi_util_async */
+#define BENCH_ASYNC_WINDOW  8
+
+/* Largest transfer */
+#define BENCH_MAX_BYTES     4096
+
+/* Default application time between two SPI_DoTasks calls */
+#define BENCH_LOOP_TICKS    40
+
+/* SPI_DoTasks calls before a transfer is declared stuck */
+#define BENCH_MAX_LOOPS     1000000
+
+static uint8_t benchTx[BENCH_MAX_BYTES];
+static uint8_t benchRx[BENCH_MAX_BYTES];
+static uint32_t benchLoopTicks = BENCH_LOOP_TICKS;
+static int benchErrors;
+
+/*****************************************************************************/
+
+/**
+ * bench_prepare
+ * 
+ * New pattern to send, reception buffer cleared, fake SPI at power up
+ * 
+ * @param Seed : Pattern variant
+ */
+static void bench_prepare(uint32_t Seed)
+{
+    uint32_t i;
+
+    for( i = 0 ; i < BENCH_MAX_BYTES ; i++ )
+        benchTx[i] = (uint8_t)((i * 7) + Seed);
+    memset(benchRx, 0, sizeof(benchRx));
+
+    FakeSpi_Reset();
+}
+
+/**
+ * bench_init
+ * 
+ * SPI_Init and handlers of the vectors, as the __ISR functions on target
+ */
+static void bench_init(void)
+{
+    SPI_Init();
+
+#ifdef SPI_USE_INTERRUPT
+    FakeSpi_SetVector(DescrSpi.IntSourceRx, SPI_InterruptHandler);
+    FakeSpi_SetVector(DescrSpi.DmaIntSourceRx, SPI_DmaInterruptHandler);
+#endif
+}
+
+/**
+ * bench_run
+ * 
+ * Let the started transfer end, SPI_DoTasks every LoopTicks without
+ * interrupts, only time running with them
+ * 
+ * @param pDriver : Driver name
+ * @param nBytes : Bytes transferred
+ */
+static void bench_run(const char* pDriver, uint32_t nBytes)
+{
+    uint32_t Loops = 0;
+
+    while((SPI_GetState() != SPI_STATE_IDLE) && (Loops < BENCH_MAX_LOOPS))
+    {
+        FakeSpi_Advance(benchLoopTicks);
+#ifndef SPI_USE_INTERRUPT
+        SPI_DoTasks();
+#endif
+        Loops++;
+    }
+
+    if(Loops >= BENCH_MAX_LOOPS)
+    {
+        fprintf(stderr, "%s %lu bytes : never ends\n", pDriver, (unsigned long)nBytes);
+        benchErrors++;
+    }
+
+#ifdef SPI_USE_INTERRUPT
+    if((DescrSpi.Stats.DoTasksBusy != 0) || (FakeSpi_Counters().Interrupts == 0))
+    {
+        fprintf(stderr, "%s %lu bytes : not ended by interrupts\n",
+                pDriver, (unsigned long)nBytes);
+        benchErrors++;
+    }
+#endif
+}
+
+/**
+ * bench_check
+ * 
+ * @param pDriver : Driver name
+ * @param nBytes : Bytes transferred
+ */
+static void bench_check(const char* pDriver, uint32_t nBytes, bool CheckRx)
+{
+    S_FAKE_SPI_COUNTERS Counters = FakeSpi_Counters();
+
+    if(CheckRx && (memcmp(benchTx, benchRx, nBytes) != 0))
+    {
+        fprintf(stderr, "%s %lu bytes : received bytes differ\n",
+                pDriver, (unsigned long)nBytes);
+        benchErrors++;
+    }
+    if(FakeSpi_CsIsLow())
+    {
+        fprintf(stderr, "%s %lu bytes : CS still low\n",
+                pDriver, (unsigned long)nBytes);
+        benchErrors++;
+    }
+    if((Counters.TxOverflows + Counters.RxOverflows + Counters.RxUnderflows) != 0)
+    {
+        fprintf(stderr, "%s %lu bytes : FIFO overflow or underflow\n",
+                pDriver, (unsigned long)nBytes);
+        benchErrors++;
+    }
+}
+
+/**
+ * bench_print
+ * 
+ * One CSV line
+ */
+static void bench_print(const char* pDriver, uint32_t nBytes, uint32_t Calls,
+                        uint32_t LatencyTicks)
+{
+    S_FAKE_SPI_COUNTERS Counters = FakeSpi_Counters();
+
+    printf("%s,%lu,%lu,%lu,%lu,%.3f,%lu,%lu,%.2f\n",
+           pDriver,
+           (unsigned long)nBytes,
+           (unsigned long)FakeSpi_ByteTicks(SPI_ID_1),
+           (unsigned long)benchLoopTicks,
+           (unsigned long)Calls,
+           (Calls > 0) ? (double)nBytes / Calls : 0.0,
+           (unsigned long)Counters.WaitPolls,
+           (unsigned long)LatencyTicks,
+           (double)LatencyTicks * 1e6 / FAKE_CORE_TIMER_HZ);
+}
+
+/*****************************************************************************/
+
+/**
+ * bench_spi_sm
+ * 
+ * Stream transfer advanced by SPI_DoTasks or interrupt, measures of SPI_SM_STATS
+ * 
+ * @param nBytes : Bytes to transfer
+ */
+static void bench_spi_sm(uint32_t nBytes)
+{
+    char Line[128];
+
+    bench_prepare(nBytes);
+    bench_init();
+    SPI_SM_StatsReset(&DescrSpi);
+    FakeSpi_ClearCounters();
+
+    if(!SPI_StartStream(nBytes, benchTx, benchRx))
+    {
+        fprintf(stderr, "spi_sm %lu bytes : not started\n", (unsigned long)nBytes);
+        benchErrors++;
+        return;
+    }
+
+    bench_run("spi_sm", nBytes);
+    bench_check("spi_sm", nBytes, true);
+    bench_print("spi_sm", nBytes, DescrSpi.Stats.DoTasksBusy, DescrSpi.Stats.TicksLast);
+
+    /* Same measures as seen on target */
+    SPI_SM_StatsReport(&DescrSpi, Line, sizeof(Line));
+    fprintf(stderr, "spi_sm %lu bytes : %s", (unsigned long)nBytes, Line);
+}
+
+/**
+ * bench_spi_util
+ * 
+ * Blocking spi_read1 for each byte, CS handled as the callers do
+ * 
+ * @param nBytes : Bytes to transfer
+ */
+static void bench_spi_util(uint32_t nBytes)
+{
+    uint32_t Start;
+    uint32_t i;
+
+    bench_prepare(nBytes);
+    bench_init();
+    FakeSpi_ClearCounters();
+
+    Start = FakeSpi_Now();
+    PLIB_PORTS_PinClear(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+    for( i = 0 ; i < nBytes ; i++ )
+        benchRx[i] = spi_read1(benchTx[i]);
+    PLIB_PORTS_PinSet(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+
+    bench_check("spi_util", nBytes, true);
+    bench_print("spi_util", nBytes, nBytes, FakeSpi_Now() - Start);
+}
+
+/**
+ * bench_spi_util_write
+ * 
+ * Write only sequence, spi_write1 only waits when the FIFO is full
+ * 
+ * @param nBytes : Bytes to transfer
+ */
+static void bench_spi_util_write(uint32_t nBytes)
+{
+    uint32_t Start;
+    uint32_t i;
+
+    bench_prepare(nBytes);
+    bench_init();
+    FakeSpi_ClearCounters();
+
+    Start = FakeSpi_Now();
+    PLIB_PORTS_PinClear(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+    for( i = 0 ; i < nBytes ; i++ )
+        spi_write1(benchTx[i]);
+    spi_flush1();
+    PLIB_PORTS_PinSet(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+
+    bench_check("spi_util_write", nBytes, false);
+    bench_print("spi_util_write", nBytes, nBytes, FakeSpi_Now() - Start);
+}
+
+/**
+ * bench_spi_util_async
+ * 
+ * spi_read1_async with BENCH_ASYNC_WINDOW bytes in flight
+ * 
+ * @param nBytes : Bytes to transfer
+ */
+static void bench_spi_util_async(uint32_t nBytes)
+{
+    static SPI_TOKEN Tokens[BENCH_MAX_BYTES];
+    uint32_t Start;
+    uint32_t iTx;
+    uint32_t iRx = 0;
+
+    bench_prepare(nBytes);
+    bench_init();
+    FakeSpi_ClearCounters();
+
+    Start = FakeSpi_Now();
+    PLIB_PORTS_PinClear(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+    for( iTx = 0 ; iTx < nBytes ; iTx++ )
+    {
+        Tokens[iTx] = spi_read1_async(benchTx[iTx]);
+        if((iTx - iRx) >= BENCH_ASYNC_WINDOW)
+        {
+            benchRx[iRx] = spi_wait1(Tokens[iRx]);
+            iRx++;
+        }
+    }
+    for( ; iRx < nBytes ; iRx++ )
+        benchRx[iRx] = spi_wait1(Tokens[iRx]);
+    spi_flush1();
+    PLIB_PORTS_PinSet(PORTS_ID_0, PORTS_CHANNEL_D, PORTS_BIT_POS_3);
+
+    bench_check("spi_util_async", nBytes, true);
+    bench_print("spi_util_async", nBytes, nBytes, FakeSpi_Now() - Start);
+}
+
+#ifdef SPI_USE_DMA
+/**
+ * bench_spi_dma
+ * 
+ * DMA transfer ended by SPI_DoTasks or interrupt, measures of SPI_SM_STATS
+ * 
+ * @param nBytes : Bytes to transfer
+ */
+static void bench_spi_dma(uint32_t nBytes)
+{
+    bool Started;
+
+    bench_prepare(nBytes);
+    bench_init();
+    SPI_SM_StatsReset(&DescrSpi);
+    FakeSpi_ClearCounters();
+
+    Started = SPI_StartDma((uint16_t)nBytes, benchTx, benchRx);
+    if(Started != (nBytes <= SPI_SM_DMA_MAX_BYTES))
+    {
+        fprintf(stderr, "spi_dma %lu bytes : %s\n", (unsigned long)nBytes,
+                Started ? "started over SPI_SM_DMA_MAX_BYTES" : "not started");
+        benchErrors++;
+        return;
+    }
+    if(!Started)
+        return;
+
+    bench_run("spi_dma", nBytes);
+    bench_check("spi_dma", nBytes, true);
+    bench_print("spi_dma", nBytes, DescrSpi.Stats.DoTasksBusy, DescrSpi.Stats.TicksLast);
+}
+#endif
+
+/*****************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    size_t iSize;
+
+    if(argc > 1)
+        FakeSpi_SetByteTicks((uint32_t)strtoul(argv[1], NULL, 0));
+    if(argc > 2)
+        benchLoopTicks = (uint32_t)strtoul(argv[2], NULL, 0);
+    if(argc > 3)
+        FakeSpi_SetAccessTicks((uint32_t)strtoul(argv[3], NULL, 0));
+
+    printf("driver,bytes,byte_ticks,loop_ticks,calls,bytes_per_call,"
+           "busy_polls,latency_ticks,latency_us\n");
+
+    for( iSize = 0 ; iSize < sizeof(benchSizes) / sizeof(benchSizes[0]) ; iSize++ )
+    {
+        bench_spi_sm(benchSizes[iSize]);
+        bench_spi_util(benchSizes[iSize]);
+        bench_spi_util_write(benchSizes[iSize]);
+        bench_spi_util_async(benchSizes[iSize]);
+#ifdef SPI_USE_DMA
+        bench_spi_dma(benchSizes[iSize]);
+#endif
+    }
+
+    return (benchErrors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,8 @@
+/* Host stub of app.h, only what Mc32SpiUtil.c needs */
+#ifndef APP_H
+#define APP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* APP_H */
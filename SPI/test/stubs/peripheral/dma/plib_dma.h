@@ -0,0 +1,71 @@
+/* Host stub of the Harmony DMA peripheral library
+ * Implemented by fake_plib_spi.c, addresses are host pointers (see
+ * sys/kmem.h), size registers keep 8 bits as on PIC32MX */
+#ifndef PLIB_DMA_H
+#define PLIB_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum
+{
+    DMA_ID_0,
+} DMA_MODULE_ID;
+
+typedef enum
+{
+    DMA_CHANNEL_0, DMA_CHANNEL_1, DMA_CHANNEL_2, DMA_CHANNEL_3,
+    DMA_CHANNEL_4, DMA_CHANNEL_5, DMA_CHANNEL_6, DMA_CHANNEL_7,
+    DMA_NUMBER_OF_CHANNELS
+} DMA_CHANNEL;
+
+typedef enum
+{
+    DMA_TRIGGER_SPI_1_TRANSMIT, DMA_TRIGGER_SPI_1_RECEIVE,
+    DMA_TRIGGER_SPI_2_TRANSMIT, DMA_TRIGGER_SPI_2_RECEIVE,
+    DMA_TRIGGER_SPI_3_TRANSMIT, DMA_TRIGGER_SPI_3_RECEIVE,
+    DMA_TRIGGER_SPI_4_TRANSMIT, DMA_TRIGGER_SPI_4_RECEIVE,
+} DMA_TRIGGER_SOURCE;
+
+typedef enum
+{
+    DMA_CHANNEL_PRIORITY_0, DMA_CHANNEL_PRIORITY_1,
+    DMA_CHANNEL_PRIORITY_2, DMA_CHANNEL_PRIORITY_3,
+} DMA_CHANNEL_PRIORITY;
+
+typedef enum
+{
+    DMA_CHANNEL_TRIGGER_TRANSFER_START,
+    DMA_CHANNEL_TRIGGER_TRANSFER_ABORT,
+    DMA_CHANNEL_TRIGGER_PATTERN_MATCH_ABORT,
+} DMA_CHANNEL_TRIGGER_TYPE;
+
+typedef enum
+{
+    DMA_INT_ADDRESS_ERROR,
+    DMA_INT_TRANSFER_ABORT,
+    DMA_INT_CELL_TRANSFER_COMPLETE,
+    DMA_INT_BLOCK_TRANSFER_COMPLETE,
+    DMA_INT_DESTINATION_HALF_FULL,
+    DMA_INT_DESTINATION_DONE,
+    DMA_INT_SOURCE_HALF_EMPTY,
+    DMA_INT_SOURCE_DONE,
+} DMA_INT_SOURCE;
+
+void PLIB_DMA_Enable(DMA_MODULE_ID index);
+void PLIB_DMA_ChannelXEnable(DMA_MODULE_ID index, DMA_CHANNEL channel);
+void PLIB_DMA_ChannelXDisable(DMA_MODULE_ID index, DMA_CHANNEL channel);
+void PLIB_DMA_ChannelXPrioritySelect(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_CHANNEL_PRIORITY channelPriority);
+void PLIB_DMA_ChannelXSourceStartAddressSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uintptr_t sourceStartAddress);
+void PLIB_DMA_ChannelXSourceSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t sourceSize);
+void PLIB_DMA_ChannelXDestinationStartAddressSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uintptr_t destinationStartAddress);
+void PLIB_DMA_ChannelXDestinationSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t destinationSize);
+void PLIB_DMA_ChannelXCellSizeSet(DMA_MODULE_ID index, DMA_CHANNEL channel, uint16_t cellSize);
+void PLIB_DMA_ChannelXStartIRQSet(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_TRIGGER_SOURCE IRQnum);
+void PLIB_DMA_ChannelXTriggerEnable(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_CHANNEL_TRIGGER_TYPE trigger);
+void PLIB_DMA_ChannelXINTSourceEnable(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource);
+bool PLIB_DMA_ChannelXINTSourceFlagGet(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource);
+void PLIB_DMA_ChannelXINTSourceFlagClear(DMA_MODULE_ID index, DMA_CHANNEL channel, DMA_INT_SOURCE dmaINTSource);
+void PLIB_DMA_StartTransferSet(DMA_MODULE_ID index, DMA_CHANNEL channel);
+
+#endif /* PLIB_DMA_H */
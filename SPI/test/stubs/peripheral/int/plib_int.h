@@ -0,0 +1,47 @@
+/* Host stub of the Harmony interrupt peripheral library
+ * Implemented by fake_plib_spi.c, enabled sources call the handlers
+ * given to FakeSpi_SetVector */
+#ifndef PLIB_INT_H
+#define PLIB_INT_H
+
+#include <stdbool.h>
+
+typedef enum
+{
+    INT_ID_0,
+} INT_MODULE_ID;
+
+typedef enum
+{
+    INT_SOURCE_SPI_1_RECEIVE, INT_SOURCE_SPI_2_RECEIVE,
+    INT_SOURCE_SPI_3_RECEIVE, INT_SOURCE_SPI_4_RECEIVE,
+    INT_SOURCE_DMA_0, INT_SOURCE_DMA_1, INT_SOURCE_DMA_2, INT_SOURCE_DMA_3,
+    INT_SOURCE_DMA_4, INT_SOURCE_DMA_5, INT_SOURCE_DMA_6, INT_SOURCE_DMA_7,
+} INT_SOURCE;
+
+typedef enum
+{
+    INT_VECTOR_SPI1, INT_VECTOR_SPI2, INT_VECTOR_SPI3, INT_VECTOR_SPI4,
+    INT_VECTOR_DMA0, INT_VECTOR_DMA1, INT_VECTOR_DMA2, INT_VECTOR_DMA3,
+    INT_VECTOR_DMA4, INT_VECTOR_DMA5, INT_VECTOR_DMA6, INT_VECTOR_DMA7,
+} INT_VECTOR;
+
+typedef enum
+{
+    INT_PRIORITY_LEVEL0, INT_PRIORITY_LEVEL1, INT_PRIORITY_LEVEL2, INT_PRIORITY_LEVEL3,
+    INT_PRIORITY_LEVEL4, INT_PRIORITY_LEVEL5, INT_PRIORITY_LEVEL6, INT_PRIORITY_LEVEL7,
+} INT_PRIORITY_LEVEL;
+
+typedef enum
+{
+    INT_SUBPRIORITY_LEVEL0, INT_SUBPRIORITY_LEVEL1,
+    INT_SUBPRIORITY_LEVEL2, INT_SUBPRIORITY_LEVEL3,
+} INT_SUBPRIORITY_LEVEL;
+
+void PLIB_INT_SourceEnable(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceDisable(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_SourceFlagClear(INT_MODULE_ID index, INT_SOURCE source);
+void PLIB_INT_VectorPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_PRIORITY_LEVEL priority);
+void PLIB_INT_VectorSubPrioritySet(INT_MODULE_ID index, INT_VECTOR vector, INT_SUBPRIORITY_LEVEL subPriority);
+
+#endif /* PLIB_INT_H */
@@ -0,0 +1,85 @@
+/* Host stub of the Harmony SPI peripheral library
+ * Implemented by fake_plib_spi.c */
+#ifndef PLIB_SPI_H
+#define PLIB_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+    SPI_ID_1,
+    SPI_ID_2,
+    SPI_ID_3,
+    SPI_ID_4,
+    SPI_NUMBER_OF_MODULES
+} SPI_MODULE_ID;
+
+typedef enum
+{
+    SPI_COMMUNICATION_WIDTH_8BITS,
+    SPI_COMMUNICATION_WIDTH_16BITS,
+    SPI_COMMUNICATION_WIDTH_32BITS,
+} SPI_COMMUNICATION_WIDTH;
+
+typedef enum
+{
+    SPI_PIN_DATA_OUT,
+} SPI_PIN;
+
+typedef enum
+{
+    SPI_INPUT_SAMPLING_PHASE_IN_MIDDLE,
+    SPI_INPUT_SAMPLING_PHASE_AT_END,
+} SPI_INPUT_SAMPLING_PHASE;
+
+typedef enum
+{
+    SPI_CLOCK_POLARITY_IDLE_LOW,
+    SPI_CLOCK_POLARITY_IDLE_HIGH,
+} SPI_CLOCK_POLARITY;
+
+typedef enum
+{
+    SPI_OUTPUT_DATA_PHASE_ON_IDLE_TO_ACTIVE_CLOCK,
+    SPI_OUTPUT_DATA_PHASE_ON_ACTIVE_TO_IDLE_CLOCK,
+} SPI_OUTPUT_DATA_PHASE;
+
+typedef enum
+{
+    SPI_FIFO_INTERRUPT_WHEN_TRANSMIT_BUFFER_IS_NOT_FULL,
+    SPI_FIFO_INTERRUPT_WHEN_TRANSMIT_BUFFER_IS_COMPLETELY_EMPTY,
+    SPI_FIFO_INTERRUPT_WHEN_RECEIVE_BUFFER_IS_NOT_EMPTY,
+    SPI_FIFO_INTERRUPT_WHEN_TRANSMISSION_IS_COMPLETE,
+} SPI_FIFO_INTERRUPT;
+
+void PLIB_SPI_Enable(SPI_MODULE_ID index);
+void PLIB_SPI_Disable(SPI_MODULE_ID index);
+void PLIB_SPI_BufferClear(SPI_MODULE_ID index);
+void PLIB_SPI_StopInIdleDisable(SPI_MODULE_ID index);
+void PLIB_SPI_PinEnable(SPI_MODULE_ID index, SPI_PIN pin);
+void PLIB_SPI_InputSamplePhaseSelect(SPI_MODULE_ID index, SPI_INPUT_SAMPLING_PHASE phase);
+void PLIB_SPI_MasterEnable(SPI_MODULE_ID index);
+void PLIB_SPI_FramedCommunicationDisable(SPI_MODULE_ID index);
+void PLIB_SPI_FIFOEnable(SPI_MODULE_ID index);
+void PLIB_SPI_FIFOInterruptModeSelect(SPI_MODULE_ID index, SPI_FIFO_INTERRUPT mode);
+void PLIB_SPI_CommunicationWidthSelect(SPI_MODULE_ID index, SPI_COMMUNICATION_WIDTH width);
+void PLIB_SPI_BaudRateSet(SPI_MODULE_ID index, uint32_t clockFrequency, uint32_t baudRate);
+void PLIB_SPI_ClockPolaritySelect(SPI_MODULE_ID index, SPI_CLOCK_POLARITY polarity);
+void PLIB_SPI_OutputDataPhaseSelect(SPI_MODULE_ID index, SPI_OUTPUT_DATA_PHASE phase);
+
+bool PLIB_SPI_IsBusy(SPI_MODULE_ID index);
+bool PLIB_SPI_TransmitBufferIsFull(SPI_MODULE_ID index);
+bool PLIB_SPI_TransmitBufferIsEmpty(SPI_MODULE_ID index);
+bool PLIB_SPI_ReceiverFIFOIsEmpty(SPI_MODULE_ID index);
+void PLIB_SPI_ReceiverOverflowClear(SPI_MODULE_ID index);
+
+void PLIB_SPI_BufferWrite(SPI_MODULE_ID index, uint8_t data);
+void PLIB_SPI_BufferWrite16bit(SPI_MODULE_ID index, uint16_t data);
+void PLIB_SPI_BufferWrite32bit(SPI_MODULE_ID index, uint32_t data);
+uint8_t PLIB_SPI_BufferRead(SPI_MODULE_ID index);
+uint16_t PLIB_SPI_BufferRead16bit(SPI_MODULE_ID index);
+uint32_t PLIB_SPI_BufferRead32bit(SPI_MODULE_ID index);
+void* PLIB_SPI_BufferAddressGet(SPI_MODULE_ID index);
+
+#endif /* PLIB_SPI_H */
@@ -0,0 +1,11 @@
+/* Host stub of <sys/kmem.h>
+ * The fake DMA works on host pointers, the "physical" address is the
+ * pointer itself so that 64 bits addresses are not truncated */
+#ifndef KMEM_H
+#define KMEM_H
+
+#include <stdint.h>
+
+#define KVA_TO_PA(v)    ((uintptr_t)(v))
+
+#endif /* KMEM_H */
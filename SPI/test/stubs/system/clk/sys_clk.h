@@ -0,0 +1,14 @@
+/* Host stub of the Harmony clock system service */
+#ifndef SYS_CLK_H
+#define SYS_CLK_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    CLK_BUS_PERIPHERAL_1,
+} CLK_BUSES_PERIPHERAL;
+
+uint32_t SYS_CLK_PeripheralFrequencyGet(CLK_BUSES_PERIPHERAL PeripheralBus);
+
+#endif /* SYS_CLK_H */
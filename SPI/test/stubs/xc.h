@@ -0,0 +1,19 @@
+/* Host stub of <xc.h>, core timer is the simulated time of the fake SPI
+ * Interrupt enable of XC32 builtins is the one of the fake handlers */
+#ifndef XC_H
+#define XC_H
+
+#include <stdint.h>
+
+uint32_t FakeSpi_Now(void);
+unsigned int FakeSpi_IsrState(void);
+unsigned int FakeSpi_IsrDisable(void);
+void FakeSpi_IsrRestore(unsigned int State);
+
+#define _CP0_GET_COUNT()    FakeSpi_Now()
+
+#define __builtin_get_isr_state()       FakeSpi_IsrState()
+#define __builtin_disable_interrupts()  FakeSpi_IsrDisable()
+#define __builtin_set_isr_state(s)      FakeSpi_IsrRestore(s)
+
+#endif /* XC_H */